@@ -41,556 +41,896 @@
 #include "Eve2_81x.h"            // Header for this file with prototypes, defines, and typedefs
 #include "MatrixEve2Conf.h"      // Header for display selection 
 #include "hw_api.h"				 // for spi abstraction 
+#include "eve_nomalloc.h"        // Nothing below this point is allowed to use the heap with EVE_NO_MALLOC
 
-#define WorkBuffSz 512
 #define Log printf
 
-// Global Variables 
-uint16_t FifoWriteLocation = 0;
-char LogBuf[WorkBuffSz];         // The singular universal data array used for all things including logging
+// Every HAL call goes through the context's EveHal
+#define Delay(ctx, ms)     ((ctx)->Hal.Delay((ctx)->Hal.User, (ms)))
 
-static uint32_t Width;
-static uint32_t Height;
-static uint32_t HOffset;
-static uint32_t VOffset;
-static uint8_t Touch;
+static uint32_t Micros(EveContext *ctx)
+{
+  return ctx->Hal.Micros ? ctx->Hal.Micros(ctx->Hal.User) : 0;
+}
 
-uint32_t Display_Width()
+#if defined(EVE_INSTRUMENT)
+// Bus statistics are collected against whichever public entry point is outermost when the SPI traffic happens.
+// Register access from outside of any entry point is counted under EVE_STAT_REGISTER.  Each context keeps
+// its own counters.
+
+static void StatEnter(EveContext *ctx, uint8_t Id)
 {
-	return Width;
+  if (ctx->StatDepth++ == 0)
+  {
+    ctx->StatScope = Id;
+    ctx->StatStart = Micros(ctx);
+    ctx->Stats[Id].Calls++;
+  }
 }
 
-uint32_t Display_Height()
+static void StatLeave(EveContext *ctx)
 {
-	return Height;
+  if (--ctx->StatDepth == 0)
+  {
+    ctx->Stats[ctx->StatScope].Micros += Micros(ctx) - ctx->StatStart;
+    ctx->StatScope = EVE_STAT_REGISTER;
+  }
 }
 
-uint8_t Display_Touch()
+static void SPI_Enable(EveContext *ctx)
 {
-	return Touch;
+  ctx->Stats[ctx->StatScope].CsCycles++;
+  ctx->Hal.SPI_Enable(ctx->Hal.User);
 }
 
-uint32_t Display_HOffset()
+static uint8_t SPI_Write(EveContext *ctx, uint8_t data)
 {
-	return HOffset;
+  ctx->Stats[ctx->StatScope].BytesWritten++;
+  return ctx->Hal.SPI_Write(ctx->Hal.User, data);
 }
-uint32_t Display_VOffset()
+
+static void SPI_WriteBuffer(EveContext *ctx, uint8_t *Buffer, uint32_t Length)
 {
-	return VOffset;
+  ctx->Stats[ctx->StatScope].BytesWritten += Length;
+  ctx->Hal.SPI_WriteBuffer(ctx->Hal.User, Buffer, Length);
 }
 
+static void SPI_ReadBuffer(EveContext *ctx, uint8_t *Buffer, uint32_t Length)
+{
+  ctx->Stats[ctx->StatScope].BytesRead += Length;
+  ctx->Hal.SPI_ReadBuffer(ctx->Hal.User, Buffer, Length);
+}
 
+#  define SPI_Disable(ctx)         ((ctx)->Hal.SPI_Disable((ctx)->Hal.User))
+#  define STAT_ENTER(ctx, id)      StatEnter(ctx, id)
+#  define STAT_LEAVE(ctx)          StatLeave(ctx)
+#else
+// Instrumentation compiled out - straight to the HAL
+#  define SPI_Enable(ctx)          ((ctx)->Hal.SPI_Enable((ctx)->Hal.User))
+#  define SPI_Disable(ctx)         ((ctx)->Hal.SPI_Disable((ctx)->Hal.User))
+#  define SPI_Write(ctx, d)        ((ctx)->Hal.SPI_Write((ctx)->Hal.User, (d)))
+#  define SPI_WriteBuffer(ctx, b, n) ((ctx)->Hal.SPI_WriteBuffer((ctx)->Hal.User, (b), (n)))
+#  define SPI_ReadBuffer(ctx, b, n)  ((ctx)->Hal.SPI_ReadBuffer((ctx)->Hal.User, (b), (n)))
+#  define STAT_ENTER(ctx, id)
+#  define STAT_LEAVE(ctx)
+#endif
+
+#if (EVE_CMD_STAGE_SIZE % FT_CMD_SIZE) || (EVE_CMD_STAGE_SIZE > (FT_CMD_FIFO_SIZE - FT_CMD_SIZE))
+#  error "EVE_CMD_STAGE_SIZE must be a multiple of 4 and smaller than the command FIFO"
+#endif
+
+#if !defined(EVE_NO_FRAME_SKIP)
+// Frame skipping.  Every word of a frame from CMD_DLSTART to CMD_SWAP is hashed (64 bit FNV-1a) as it is staged.
+// If the frame at CMD_SWAP is the same as the last one that went to Eve, and none of it has left the staging
+// buffer yet, it is simply forgotten - the screen is already showing it.  A frame can only be dropped if it
+// fits in EVE_CMD_STAGE_SIZE, and any write that could change what an identical frame draws (RAM_G uploads,
+// inline data, animation and video, a frame left unfinished) means the next one is sent regardless.
+#define FRAME_HASH_BASIS 0xCBF29CE484222325ULL
+#define FRAME_HASH_PRIME 0x00000100000001B3ULL
+
+// Commands whose result is not decided by their words alone, or that hand something back through the FIFO
+static const uint32_t VolatileCmds[] =
+{
+  CMD_SPINNER, CMD_SCREENSAVER, CMD_SKETCH, CMD_CALIBRATE, CMD_LOGO, CMD_SNAPSHOT, CMD_ANIMDRAW, CMD_ANIMFRAME,
+  CMD_ANIMSTART, CMD_VIDEOFRAME, CMD_PLAYVIDEO, CMD_LOADIMAGE, CMD_INFLATE, CMD_MEDIAFIFO, CMD_GETPTR,
+  CMD_GETPROPS, CMD_GETMATRIX, CMD_REGREAD, CMD_MEMCRC, CMD_CRC, CMD_FLASHREAD
+};
 
+static bool IsVolatileCmd(uint32_t data)
+{
+  uint8_t i;
+
+  if ((data & 0xFFFFFF00) != 0xFFFFFF00)
+    return false;
+  for (i = 0; i < sizeof(VolatileCmds) / sizeof(VolatileCmds[0]); i++)
+    if (VolatileCmds[i] == data)
+      return true;
+  return false;
+}
+#endif
 
-// Call this function once at powerup to reset and initialize the Eve chip
-int FT81x_Init(int display, int board, int touch)
+// ***************************************************************************************************************
+// *** Contexts **************************************************************************************************
+// ***************************************************************************************************************
+
+// The default context talks to the HAL functions in hw_api.h.  It is what the classic API (no context
+// parameter) uses, so existing ports keep working without changes.
+static void Default_SPI_Enable(void *User)                                        { (void)User; HAL_SPI_Enable(); }
+static void Default_SPI_Disable(void *User)                                       { (void)User; HAL_SPI_Disable(); }
+static uint8_t Default_SPI_Write(void *User, uint8_t data)                        { (void)User; return HAL_SPI_Write(data); }
+static void Default_SPI_WriteBuffer(void *User, uint8_t *Buffer, uint32_t Length) { (void)User; HAL_SPI_WriteBuffer(Buffer, Length); }
+static void Default_SPI_ReadBuffer(void *User, uint8_t *Buffer, uint32_t Length)  { (void)User; HAL_SPI_ReadBuffer(Buffer, Length); }
+static void Default_Delay(void *User, uint32_t milliSeconds)                      { (void)User; HAL_Delay(milliSeconds); }
+static void Default_Eve_Reset_HW(void *User)                                      { (void)User; HAL_Eve_Reset_HW(); }
+#if defined(EVE_INSTRUMENT) || defined(EVE_HAL_MICROS)
+static uint32_t Default_Micros(void *User)                                        { (void)User; return HAL_Micros(); }
+#else
+#  define Default_Micros NULL                                                        // HAL_Micros() is not required
+#endif
+#if defined(EVE_HAL_IRQ)
+static bool Default_Wait_IRQ(void *User, uint32_t TimeoutMs)                      { (void)User; return HAL_Wait_IRQ(TimeoutMs); }
+#else
+#  define Default_Wait_IRQ NULL                                                      // Touch events poll
+#endif
+
+static EveContext DefaultContext =
+{
+  .Hal =
+  {
+    .User            = NULL,
+    .SPI_Enable      = Default_SPI_Enable,
+    .SPI_Disable     = Default_SPI_Disable,
+    .SPI_Write       = Default_SPI_Write,
+    .SPI_WriteBuffer = Default_SPI_WriteBuffer,
+    .SPI_ReadBuffer  = Default_SPI_ReadBuffer,
+    .Delay           = Default_Delay,
+    .Eve_Reset_HW    = Default_Eve_Reset_HW,
+    .Micros          = Default_Micros,
+    .Wait_IRQ        = Default_Wait_IRQ,
+  }
+};
+
+EveContext *Eve_Default(void)
+{
+  return &DefaultContext;
+}
+
+// Set up a context for a display reached through Hal.  Call Eve_FT81x_Init() on it next.
+void Eve_InitContext(EveContext *ctx, const EveHal *Hal)
+{
+  memset(ctx, 0, sizeof(EveContext));
+  ctx->Hal = *Hal;
+}
+
+uint32_t Eve_Display_Width(EveContext *ctx)
+{
+	return ctx->Width;
+}
+
+uint32_t Eve_Display_Height(EveContext *ctx)
+{
+	return ctx->Height;
+}
+
+uint8_t Eve_Display_Touch(EveContext *ctx)
+{
+	return ctx->Touch;
+}
+
+uint32_t Eve_Display_HOffset(EveContext *ctx)
+{
+	return ctx->HOffset;
+}
+uint32_t Eve_Display_VOffset(EveContext *ctx)
+{
+	return ctx->VOffset;
+}
+
+
+
+
+// *** Panel timings *********************************************************************************************
+// Timing[] is REG_HCYCLE .. REG_VSYNC1 and Output[] is REG_DITHER .. REG_PCLK_POL, each in register order so that
+// they go out as one burst apiece.  Panels left out of EVE_PANELS (MatrixEve2Conf.h) are not built in.
+typedef struct
+{
+	uint8_t Display;
+	uint16_t Width;                // The visible area, and where it starts
+	uint16_t Height;
+	uint16_t PixHOffset;
+	uint16_t PixVOffset;
+	uint16_t Timing[10];           // HCYCLE, HOFFSET, HSIZE, HSYNC0, HSYNC1, VCYCLE, VOFFSET, VSIZE, VSYNC0, VSYNC1
+	uint8_t Output[4];             // DITHER, SWIZZLE, CSPREAD, PCLK_POL
+	uint8_t Pclk;
+	uint32_t Frequency;
+	uint16_t CTouchConfig;         // REG_TOUCH_CONFIG with TOUCH_TPC
+} EvePanel;
+
+static const EvePanel Panels[] =
+{
+#if EVE_PANELS & EVE_PANEL(DISPLAY_70)
+	{ DISPLAY_70,  800,  480,  0, 0,  { 928,  88,  800,  0,  48, 525, 32,  480, 0,   3 },  { 1, 0, 0, 1 }, 2, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_50)
+	{ DISPLAY_50,  800,  480,  0, 0,  { 928,  88,  800,  0,  48, 525, 32,  480, 0,   3 },  { 1, 0, 0, 1 }, 2, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_43)
+	{ DISPLAY_43,  480,  272,  0, 0,  { 548,  43,  480,  0,  41, 292, 12,  272, 0,   10 }, { 1, 0, 1, 1 }, 5, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_39)
+	{ DISPLAY_39,  480,  128,  0, 0,  { 524,  16,  480,  0,  44, 288, 12,  272, 7,   8 },  { 1, 0, 1, 1 }, 5, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_38)
+	{ DISPLAY_38,  480,  116,  0, 10, { 524,  43,  480,  0,  41, 292, 12,  272, 152, 10 }, { 1, 0, 1, 1 }, 5, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_35)
+	{ DISPLAY_35,  320,  240,  0, 0,  { 408,  68,  320,  0,  10, 262, 18,  240, 0,   2 },  { 1, 0, 1, 0 }, 8, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_29)
+	{ DISPLAY_29,  320,  102,  0, 0,  { 408,  70,  320,  0,  10, 262, 156, 102, 0,   2 },  { 1, 0, 1, 0 }, 8, 60000000, 0x5D0 },
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_40)
+	{ DISPLAY_40,  720,  720,  0, 0,  { 812,  91,  720,  46, 48, 756, 35,  720, 16,  18 }, { 0, 0, 0, 1 }, 2, 60000000, 0x480 },   // FT6336U
+#endif
+#if EVE_PANELS & EVE_PANEL(DISPLAY_101)
+	{ DISPLAY_101, 1280, 800,  0, 0,  { 1440, 158, 1280, 78, 80, 823, 22,  800, 11,  12 }, { 1, 0, 0, 0 }, 1, 80000000, 0x5D0 },
+#endif
+	{ 0 }
+};
+
+// *** Boot profile **********************************************************************************************
+// Eve_FT81x_Init() goes through the EVE_BOOT_* phases in order and each is charged the time until the next one
+// starts.  While booting, Boot.Total holds the Micros the boot started at.
+
+static void BootStart(EveContext *ctx)
+{
+	memset(&ctx->Boot, 0, sizeof(ctx->Boot));
+	ctx->Booting = true;
+	ctx->BootPhase = EVE_BOOT_RESET;
+	ctx->BootMark = ctx->Boot.Total = Micros(ctx);
+}
+
+static void BootPhase(EveContext *ctx, uint8_t Phase)
+{
+	uint32_t Now;
+
+	if (!ctx->Booting)
+		return;
+	Now = Micros(ctx);
+	ctx->Boot.Micros[ctx->BootPhase] += Now - ctx->BootMark;
+	ctx->BootPhase = Phase;
+	ctx->BootMark = Now;
+}
+
+static void BootEnd(EveContext *ctx)
+{
+	BootPhase(ctx, ctx->BootPhase);
+	ctx->Boot.Total = ctx->BootMark - ctx->Boot.Total;
+	ctx->Booting = false;
+}
+
+static void BootDelay(EveContext *ctx, uint32_t ms)
+{
+	if (ctx->Booting)
+		ctx->Boot.DelayMs[ctx->BootPhase] += ms;
+	Delay(ctx, ms);
+}
+
+static int InitFailed(EveContext *ctx, uint8_t Error)
+{
+	ctx->InitError = Error;
+	BootEnd(ctx);
+	STAT_LEAVE(ctx);
+	return 0;
+}
+
+// Call this function once at powerup to reset and initialize the Eve chip.  Returns 1 when the display is running,
+// or 0 with the reason in Eve_InitError().
+int Eve_FT81x_Init(EveContext *ctx, int display, int board, int touch)
 {
-	uint32_t Ready = false;
-	int DWIDTH;
-	int DHEIGHT;
-	int PIXVOFFSET;
-	int PIXHOFFSET;
-	int HCYCLE;
-	int HOFFSET;
-	int HSYNC0;
-	int HSYNC1;
-	int VCYCLE;
-	int VOFFSET;
-	int VSYNC0;
-	int VSYNC1;
-	int PCLK;
-	int SWIZZLE;
-	int PCLK_POL;
-	int HSIZE;
-	int VSIZE;
-	int CSPREAD;
-	int DITHER;
-
-	switch (display)
+	const EvePanel *Panel;
+	uint8_t Regs[4 * 10];
+	uint32_t Waited, ChipId, i;
+
+	STAT_ENTER(ctx, EVE_STAT_INIT);
+	BootStart(ctx);
+	for (Panel = Panels; Panel->Display && Panel->Display != display; Panel++);
+	if (!Panel->Display)
 	{
-	case  DISPLAY_70:
-		DWIDTH = 800;
-		DHEIGHT = 480;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 928;
-		HOFFSET = 88;
-		HSYNC0 = 0;
-		HSYNC1 = 48;
-		VCYCLE = 525;
-		VOFFSET = 32;
-		VSYNC0 = 0;
-		VSYNC1 = 3;
-		PCLK = 2;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 800;
-		VSIZE = 480;
-		CSPREAD = 0;
-		DITHER = 1;		
-		break;
-	case DISPLAY_50:
-		DWIDTH = 800;
-		DHEIGHT = 480;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 928;
-		HOFFSET = 88;
-		HSYNC0 = 0;
-		HSYNC1 = 48;
-		VCYCLE = 525;
-		VOFFSET = 32;
-		VSYNC0 = 0;
-		VSYNC1 = 3;
-		PCLK = 2;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 800;
-		VSIZE = 480;
-		CSPREAD = 0;
-		DITHER = 1;
-		break;
-	case DISPLAY_43:
-		DWIDTH = 480;
-		DHEIGHT = 272;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 548;
-		HOFFSET = 43;
-		HSYNC0 = 0;
-		HSYNC1 = 41;
-		VCYCLE = 292;
-		VOFFSET = 12;
-		VSYNC0 = 0;
-		VSYNC1 = 10;
-		PCLK = 5;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 480;
-		VSIZE = 272;
-		CSPREAD = 1;
-		DITHER = 1;
-		break;
-	case DISPLAY_39:
-		DWIDTH = 480;
-		DHEIGHT = 128;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 524;
-		HOFFSET = 16;
-		HSYNC1 = 44;
-		HSYNC0 = 0;
-		VCYCLE = 288;
-		VOFFSET = 12;
-		VSYNC1 = 8;
-		VSYNC0 = 7;
-		PCLK = 5;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 480;
-		VSIZE = 272;
-		CSPREAD = 1;
-		DITHER = 1;
-		break;
-	case DISPLAY_38:
-		DWIDTH = 480;
-		DHEIGHT = 116;
-		PIXVOFFSET = 10;
-		PIXHOFFSET = 0;
-		HCYCLE = 524;
-		HOFFSET = 43;
-		HSYNC0 = 0;
-		HSYNC1 = 41;
-		VCYCLE = 292;
-		VOFFSET = 12;
-		VSYNC0 = 152;
-		VSYNC1 = 10;
-		PCLK = 5;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 480;
-		VSIZE = 272;
-		CSPREAD = 1;
-		DITHER = 1;
-		break;
-	case DISPLAY_35:
-		DWIDTH = 320;
-		DHEIGHT = 240;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 408;
-		HOFFSET = 68;
-		HSYNC0 = 0;
-		HSYNC1 = 10;
-		VCYCLE = 262;
-		VOFFSET = 18;
-		VSYNC0 = 0;
-		VSYNC1 = 2;
-		PCLK = 8;
-		SWIZZLE = 0;
-		PCLK_POL = 0;
-		HSIZE = 320;
-		VSIZE = 240;
-		CSPREAD = 1;
-		DITHER = 1;
-		break;
-	case DISPLAY_29:
-		DWIDTH = 320;
-		DHEIGHT = 102;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 408;
-		HOFFSET = 70;
-		HSYNC0 = 0;
-		HSYNC1 = 10;
-		VCYCLE = 262;
-		VOFFSET = 156;
-		VSYNC0 = 0;
-		VSYNC1 = 2;
-		PCLK = 8;
-		SWIZZLE = 0;
-		PCLK_POL = 0;
-		HSIZE = 320;
-		VSIZE = 102;
-		CSPREAD = 1;
-		DITHER = 1;
-		break;
-	case DISPLAY_40:
-		DWIDTH = 720;
-		DHEIGHT = 720;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 812;
-		HOFFSET = 91; 
-		HSYNC0 = 46;
-		HSYNC1 = 48;
-		VCYCLE = 756;
-		VOFFSET = 35; 
-		VSYNC0 = 16;
-		VSYNC1 = 18;
-		PCLK = 2;
-		SWIZZLE = 0;
-		PCLK_POL = 1;
-		HSIZE = 720;
-		VSIZE = 720;
-		CSPREAD = 0;
-		DITHER = 0;
-		break;
-	case DISPLAY_101:
-		DWIDTH = 1280;
-		DHEIGHT = 800;
-		PIXVOFFSET = 0;
-		PIXHOFFSET = 0;
-		HCYCLE = 1440;
-		HOFFSET = 158;
-		HSYNC0 = 78;
-		HSYNC1 = 80;
-		VCYCLE = 823;
-		VOFFSET = 22;
-		VSYNC0 = 11;
-		VSYNC1 = 12;
-		PCLK = 1;
-		SWIZZLE = 0;
-		PCLK_POL = 0;
-		HSIZE = 1280;
-		VSIZE = 800;
-		CSPREAD = 0;
-		DITHER = 1;
-		break;
-	default:
 		printf("Unknown display type\n");
-		return 0;
-		break;
+		return InitFailed(ctx, EVE_INIT_NO_PANEL);
 	}
-	Width = DWIDTH;
-	Height = DHEIGHT;
-	HOffset = PIXHOFFSET;
-	VOffset = PIXVOFFSET;
-	Touch = touch;
-	Eve_Reset(); // Hard reset of the Eve chip
+	ctx->Width = Panel->Width;
+	ctx->Height = Panel->Height;
+	ctx->HOffset = Panel->PixHOffset;
+	ctx->VOffset = Panel->PixVOffset;
+	ctx->Touch = touch;
+	ctx->InitError = EVE_INIT_OK;
+	ctx->UseCmdB = (board >= BOARD_EVE3);
+	ctx->FifoWriteLocation = 0;
+	ctx->CmdStageCount = 0;
+	ctx->FifoUnpublished = 0;
+	ctx->CoProRead = 0;
+	ctx->FifoCredits = FT_CMD_FIFO_SIZE - FT_CMD_SIZE;   // The reset below leaves the FIFO empty
+	ctx->InFlightCount = 0;
+	ctx->MediaFifoSize = 0;                              // Gone with the reset too
+	ctx->FlashAssetCount = 0;                            // Read again by Eve_FlashIndexLoad()
+	ctx->TouchDown = false;
+	ctx->SnapshotValid = false;
+	Eve_FrameInvalidate(ctx);
+	Eve_HardReset(ctx); // Hard reset of the Eve chip
 
 	// Wakeup Eve	
+	BootPhase(ctx, EVE_BOOT_WAKE);
 	if (board >= BOARD_EVE3)
 	{
-		HostCommand(HCMD_CLKEXT);
+		Eve_HostCommand(ctx, HCMD_CLKEXT);
 	}	
-	HostCommand(HCMD_ACTIVE);
-	HAL_Delay(300);
-
-	do
-	{
-		Ready = Cmd_READ_REG_ID();
-	} while (!Ready);
-
-	//  Log("Eve now ACTIVE\n");         //
+	Eve_HostCommand(ctx, HCMD_ACTIVE);
 
-	Ready = rd32(REG_CHIP_ID);
-	uint16_t ValH = Ready >> 16;
-	uint16_t ValL = Ready & 0xFFFF;
-	Log("Chip ID = 0x%04x%04x\n", ValH, ValL);
-
-	
-	if (display == DISPLAY_101)  
+	// Eve answers REG_ID with 0x7C once her clock is up, then lets the CoPro, touch and audio engines out of reset.
+	// Ask every millisecond rather than sitting out the worst case.
+	BootPhase(ctx, EVE_BOOT_REG_ID);
+	for (Waited = 0; ; Waited++)
 	{
-		wr32(REG_FREQUENCY + RAM_REG, 80000000); // Configure the system clock to 80MHz
+		ctx->Boot.Polls[EVE_BOOT_REG_ID]++;
+		if (Eve_Cmd_READ_REG_ID(ctx))
+			break;
+		if (Waited >= EVE_BOOT_TIMEOUT_MS)
+			return InitFailed(ctx, EVE_INIT_NO_ID);
+		BootDelay(ctx, 1);
 	}
-	else
+	BootPhase(ctx, EVE_BOOT_CPU_RESET);
+	for (; ; Waited++)
 	{
-		wr32(REG_FREQUENCY + RAM_REG, 60000000); // Configure the system clock to 60MHz
+		ctx->Boot.Polls[EVE_BOOT_CPU_RESET]++;
+		if (!(Eve_rd8(ctx, REG_CPU_RESET + RAM_REG) & 0x07))
+			break;
+		if (Waited >= EVE_BOOT_TIMEOUT_MS)
+			return InitFailed(ctx, EVE_INIT_CPU_RESET);
+		BootDelay(ctx, 1);
 	}
+	BootPhase(ctx, EVE_BOOT_SETUP);
+
+	ChipId = Eve_rd32(ctx, REG_CHIP_ID);
+	Log("Chip ID = 0x%04x%04x\n", (uint16_t)(ChipId >> 16), (uint16_t)ChipId);
+
+	Eve_wr32(ctx, REG_FREQUENCY + RAM_REG, Panel->Frequency); // Configure the system clock
 	// Before we go any further with Eve, it is a good idea to check to see if she is wigging out about something 
 	// that happened before the last reset.  If Eve has just done a power cycle, this would be unnecessary.
-	if (rd16(REG_CMD_READ + RAM_REG) == 0xFFF)
+	if (Eve_rd16(ctx, REG_CMD_READ + RAM_REG) == 0xFFF)
 	{
 		// Eve is unhappy - needs a paddling.
-		uint32_t Patch_Add = rd32(REG_COPRO_PATCH_PTR + RAM_REG);
-		wr8(REG_CPU_RESET + RAM_REG, 1);
-		wr16(REG_CMD_READ + RAM_REG, 0);
-		wr16(REG_CMD_WRITE + RAM_REG, 0);
-		wr16(REG_CMD_DL + RAM_REG, 0);
-		wr8(REG_CPU_RESET + RAM_REG, 0);
-		wr32(REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
+		uint32_t Patch_Add = Eve_rd32(ctx, REG_COPRO_PATCH_PTR + RAM_REG);
+		Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 1);
+		Eve_wr16(ctx, REG_CMD_READ + RAM_REG, 0);
+		Eve_wr16(ctx, REG_CMD_WRITE + RAM_REG, 0);
+		Eve_wr16(ctx, REG_CMD_DL + RAM_REG, 0);
+		Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 0);
+		Eve_wr32(ctx, REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
 	}
 
 	// turn off screen output during startup
-	wr8(REG_GPIOX + RAM_REG, 0);             // Set REG_GPIOX to 0 to turn off the LCD DISP signal
-	wr8(REG_PCLK + RAM_REG, 0);              // Pixel Clock Output disable
-
-	// load parameters of the physical screen to the Eve
-	// All of these registers are 32 bits, but most bits are reserved, so only write what is actually used
-	wr16(REG_HCYCLE + RAM_REG, HCYCLE);         // Set H_Cycle to 548
-	wr16(REG_HOFFSET + RAM_REG, HOFFSET);       // Set H_Offset to 43
-	wr16(REG_HSYNC0 + RAM_REG, HSYNC0);         // Set H_SYNC_0 to 0
-	wr16(REG_HSYNC1 + RAM_REG, HSYNC1);         // Set H_SYNC_1 to 41
-	wr16(REG_VCYCLE + RAM_REG, VCYCLE);         // Set V_Cycle to 292
-	wr16(REG_VOFFSET + RAM_REG, VOFFSET);       // Set V_OFFSET to 12
-	wr16(REG_VSYNC0 + RAM_REG, VSYNC0);         // Set V_SYNC_0 to 0
-	wr16(REG_VSYNC1 + RAM_REG, VSYNC1);         // Set V_SYNC_1 to 10
-	wr8(REG_SWIZZLE + RAM_REG, SWIZZLE);        // Set SWIZZLE to 0
-	wr8(REG_PCLK_POL + RAM_REG, PCLK_POL);      // Set PCLK_POL to 1
-	wr16(REG_HSIZE + RAM_REG, HSIZE);           // Set H_SIZE to 480
-	wr16(REG_VSIZE + RAM_REG, VSIZE);           // Set V_SIZE to 272
-	wr8(REG_CSPREAD + RAM_REG, CSPREAD);        // Set CSPREAD to 1    (32 bit register - write only 8 bits)
-	wr8(REG_DITHER + RAM_REG, DITHER);          // Set DITHER to 1     (32 bit register - write only 8 bits)
+	Eve_wr8(ctx, REG_GPIOX + RAM_REG, 0);             // Set REG_GPIOX to 0 to turn off the LCD DISP signal
+	Eve_wr8(ctx, REG_PCLK + RAM_REG, 0);              // Pixel Clock Output disable
+
+	// load parameters of the physical screen to the Eve - the timing registers are contiguous, and so are the
+	// four output registers after REG_DLSWAP, REG_ROTATE and REG_OUTBITS
+	for (i = 0; i < 10; i++)
+	{
+		Regs[4 * i] = (uint8_t)Panel->Timing[i];
+		Regs[4 * i + 1] = (uint8_t)(Panel->Timing[i] >> 8);
+		Regs[4 * i + 2] = Regs[4 * i + 3] = 0;
+	}
+	Eve_WriteBlockRAM(ctx, REG_HCYCLE + RAM_REG, Regs, 4 * 10);
+	for (i = 0; i < 4; i++)
+	{
+		Regs[4 * i] = Panel->Output[i];
+		Regs[4 * i + 1] = Regs[4 * i + 2] = Regs[4 * i + 3] = 0;
+	}
+	Eve_WriteBlockRAM(ctx, REG_DITHER + RAM_REG, Regs, 4 * 4);
 
 	// configure touch & audio
+	BootPhase(ctx, EVE_BOOT_TOUCH);
 	if (touch == TOUCH_TPR)
 	{
-		wr16(REG_TOUCH_CONFIG + RAM_REG, 0x8381);
+		Eve_wr16(ctx, REG_TOUCH_CONFIG + RAM_REG, 0x8381);
 	}
 	else if (touch == TOUCH_TPC)
 	{
-		if (display == DISPLAY_40)
-			wr16(REG_TOUCH_CONFIG + RAM_REG, 0x480); // FT6336U
-		else 
-			wr16(REG_TOUCH_CONFIG + RAM_REG, 0x5d0);  
+		Eve_wr16(ctx, REG_TOUCH_CONFIG + RAM_REG, Panel->CTouchConfig);
 		if (board == BOARD_EVE2)
 		{
-			Cap_Touch_Upload();
+			Eve_Cap_Touch_Upload(ctx);
 		}
 	}
 
-  wr16(REG_TOUCH_RZTHRESH + RAM_REG, 1200);          // set touch resistance threshold
-  wr8(REG_TOUCH_MODE + RAM_REG, 0x02);               // set touch on: continous - this is default
-  wr8(REG_TOUCH_ADC_MODE + RAM_REG, 0x01);           // set ADC mode: differential - this is default
-  wr8(REG_TOUCH_OVERSAMPLE + RAM_REG, 15);           // set touch oversampling to max
+  Eve_wr16(ctx, REG_TOUCH_RZTHRESH + RAM_REG, 1200);          // set touch resistance threshold
+  Eve_wr8(ctx, REG_TOUCH_MODE + RAM_REG, 0x02);               // set touch on: continous - this is default
+  Eve_wr8(ctx, REG_TOUCH_ADC_MODE + RAM_REG, 0x01);           // set ADC mode: differential - this is default
+  Eve_wr8(ctx, REG_TOUCH_OVERSAMPLE + RAM_REG, 15);           // set touch oversampling to max
 
-  wr16(REG_GPIOX_DIR + RAM_REG, 0x8000 | (1<<3));             // Set Disp GPIO Direction 
-  wr16(REG_GPIOX + RAM_REG, 0x8000 | (1<<3));                 // Enable Disp (if used)
+  Eve_wr16(ctx, REG_GPIOX_DIR + RAM_REG, 0x8000 | (1<<3));             // Set Disp GPIO Direction 
+  Eve_wr16(ctx, REG_GPIOX + RAM_REG, 0x8000 | (1<<3));                 // Enable Disp (if used)
 
-  wr16(REG_PWM_HZ + RAM_REG, 0x00FA);                // Backlight PWM frequency
-  wr8(REG_PWM_DUTY + RAM_REG, 128);                  // Backlight PWM duty (on)   
+  Eve_wr16(ctx, REG_PWM_HZ + RAM_REG, 0x00FA);                // Backlight PWM frequency
+  Eve_wr8(ctx, REG_PWM_DUTY + RAM_REG, 128);                  // Backlight PWM duty (on)   
 
   // write first display list (which is a clear and blank screen)
-  wr32(RAM_DL+0, CLEAR_COLOR_RGB(0,0,0));
-  wr32(RAM_DL+4, CLEAR(1,1,1));
-  wr32(RAM_DL+8, DISPLAY());
-  wr8(REG_DLSWAP + RAM_REG, DLSWAP_FRAME);          // swap display lists
-  wr8(REG_PCLK + RAM_REG, PCLK);                       // after this display is visible on the LCD
+  BootPhase(ctx, EVE_BOOT_FIRST_SWAP);
+  Eve_wr32(ctx, RAM_DL+0, CLEAR_COLOR_RGB(0,0,0));
+  Eve_wr32(ctx, RAM_DL+4, CLEAR(1,1,1));
+  Eve_wr32(ctx, RAM_DL+8, DISPLAY());
+  Eve_wr8(ctx, REG_DLSWAP + RAM_REG, DLSWAP_FRAME);          // swap display lists
+  Eve_wr8(ctx, REG_PCLK + RAM_REG, Panel->Pclk);                       // after this display is visible on the LCD
+
+  // The swap happens at the end of the frame being scanned out.  Until REG_DLSWAP reads 0 the panel shows nothing
+  // of ours - the application's first CMD_SWAP would wait for it anyway.
+  for (Waited = 0; Waited < EVE_BOOT_TIMEOUT_MS; Waited++)
+  {
+    ctx->Boot.Polls[EVE_BOOT_FIRST_SWAP]++;
+    if (!Eve_rd8(ctx, REG_DLSWAP + RAM_REG))
+      break;
+    BootDelay(ctx, 1);
+  }
+  BootEnd(ctx);
+  STAT_LEAVE(ctx);
   return 1;
 }
 
+// EVE_INIT_OK, or why the last Eve_FT81x_Init() failed
+uint8_t Eve_InitError(EveContext *ctx)
+{
+	return ctx->InitError;
+}
+
 // Reset Eve chip via the hardware PDN line
-void Eve_Reset(void)
+void Eve_HardReset(EveContext *ctx)
 {
-  HAL_Eve_Reset_HW();
+  ctx->Hal.Eve_Reset_HW(ctx->Hal.User);
 }
 
 // Upload Goodix Calibration file
-void Cap_Touch_Upload(void)
+void Eve_Cap_Touch_Upload(EveContext *ctx)
 {
 #include "touch_cap_811.h"	
 	//---Goodix911 Configuration from AN336
 	//Load the TOUCH_DATA_U8 or TOUCH_DATA_U32 array from file “touch_cap_811.h” via the FT81x command buffer RAM_CMD
 	uint8_t CTOUCH_CONFIG_DATA_G911[] = { TOUCH_DATA_U8 };
-	CoProWrCmdBuf(CTOUCH_CONFIG_DATA_G911, TOUCH_DATA_LEN);
+	STAT_ENTER(ctx, EVE_STAT_INIT);
+	BootPhase(ctx, EVE_BOOT_TOUCH_UPLOAD);
+	Eve_CoProWrCmdBuf(ctx, CTOUCH_CONFIG_DATA_G911, TOUCH_DATA_LEN);
 	//Execute the commands till completion
-	UpdateFIFO();
-	Wait4CoProFIFOEmpty();	
+	Eve_UpdateFIFO(ctx);
+	Eve_Wait4CoProFIFOEmpty(ctx);	
 	//Hold the touch engine in reset(write REG_CPURESET = 2)
-	wr8(REG_CPU_RESET + RAM_REG, 2);
+	BootPhase(ctx, EVE_BOOT_TOUCH_RESET);
+	Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 2);
 	//Set GPIO3 output LOW		
-	wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) | 0x08)); // Set Disp GPIO Direction 
-	wr8(REG_GPIOX + RAM_REG, (rd8(RAM_REG + REG_GPIOX) | 0xF7));         // Clear GPIO
+	Eve_wr8(ctx, REG_GPIOX_DIR + RAM_REG, (Eve_rd8(ctx, RAM_REG + REG_GPIOX_DIR) | 0x08)); // Set Disp GPIO Direction 
+	Eve_wr8(ctx, REG_GPIOX + RAM_REG, (Eve_rd8(ctx, RAM_REG + REG_GPIOX) | 0xF7));         // Clear GPIO
 	//Wait more than 100us
-	HAL_Delay(1);
+	BootDelay(ctx, 1);
 	//Write REG_CPURESET=0
-	wr8(REG_CPU_RESET + RAM_REG, 0);
+	Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 0);
 	//Wait more than 55ms
-	HAL_Delay(100);
+	BootDelay(ctx, 100);
 	//Set GPIO3 to input (floating)			
-	wr8(REG_GPIOX_DIR + RAM_REG, (rd8(RAM_REG + REG_GPIOX_DIR) & 0xF7));             // Set Disp GPIO Direction 
+	Eve_wr8(ctx, REG_GPIOX_DIR + RAM_REG, (Eve_rd8(ctx, RAM_REG + REG_GPIOX_DIR) & 0xF7));             // Set Disp GPIO Direction 
+	BootPhase(ctx, EVE_BOOT_TOUCH);
+	STAT_LEAVE(ctx);
 																		 //---Goodix911 Configuration from AN336	
 }
 
 // *** Host Command - FT81X Embedded Video Engine Datasheet - 4.1.5 **********************************************
 // Host Command is a function for changing hardware related parameters of the Eve chip.  The name is confusing.
 // These are related to power modes and the like.  All defined parameters have HCMD_ prefix
-void HostCommand(uint8_t HCMD) 
+void Eve_HostCommand(EveContext *ctx, uint8_t HCMD) 
 {
 //  Log("Inside HostCommand\n");
 
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
 /*  HAL_SPI_Write(HCMD | 0x40); // In case the manual is making you believe that you just found the bug you were looking for - no. */       
-  HAL_SPI_Write(HCMD);        
-  HAL_SPI_Write(0x00);          // This second byte is set to 0 but if there is need for fancy, never used setups, then rewrite.  
-  HAL_SPI_Write(0x00);   
+  SPI_Write(ctx, HCMD);        
+  SPI_Write(ctx, 0x00);          // This second byte is set to 0 but if there is need for fancy, never used setups, then rewrite.  
+  SPI_Write(ctx, 0x00);   
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
 }
 
 // *** Eve API Reference Definitions *****************************************************************************
 // FT81X Embedded Video Engine Datasheet 1.3 - Section 4.1.4, page 16
 // These are all functions related to writing / reading data of various lengths with a memory address of 32 bits
 // ***************************************************************************************************************
-void wr32(uint32_t address, uint32_t parameter)
+void Eve_wr32(EveContext *ctx, uint32_t address, uint32_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((uint8_t)((address >> 16) | 0x80));   // RAM_REG = 0x302000 and high bit is set - result always 0xB0
-  HAL_SPI_Write((uint8_t)(address >> 8));             // Next byte of the register address   
-  HAL_SPI_Write((uint8_t)address);                    // Low byte of register address - usually just the 1 byte offset
+  SPI_Write(ctx, (uint8_t)((address >> 16) | 0x80));   // RAM_REG = 0x302000 and high bit is set - result always 0xB0
+  SPI_Write(ctx, (uint8_t)(address >> 8));             // Next byte of the register address   
+  SPI_Write(ctx, (uint8_t)address);                    // Low byte of register address - usually just the 1 byte offset
   
-  HAL_SPI_Write((uint8_t)(parameter & 0xff));         // Little endian (yes, it is most significant bit first and least significant byte first)
-  HAL_SPI_Write((uint8_t)((parameter >> 8) & 0xff));
-  HAL_SPI_Write((uint8_t)((parameter >> 16) & 0xff));
-  HAL_SPI_Write((uint8_t)((parameter >> 24) & 0xff));
+  SPI_Write(ctx, (uint8_t)(parameter & 0xff));         // Little endian (yes, it is most significant bit first and least significant byte first)
+  SPI_Write(ctx, (uint8_t)((parameter >> 8) & 0xff));
+  SPI_Write(ctx, (uint8_t)((parameter >> 16) & 0xff));
+  SPI_Write(ctx, (uint8_t)((parameter >> 24) & 0xff));
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
 }
 
-void wr16(uint32_t address, uint16_t parameter)
+void Eve_wr16(EveContext *ctx, uint32_t address, uint16_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
-  HAL_SPI_Write((uint8_t)(address >> 8));           // Next byte of the register address   
-  HAL_SPI_Write((uint8_t)address);                  // Low byte of register address - usually just the 1 byte offset
+  SPI_Write(ctx, (uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
+  SPI_Write(ctx, (uint8_t)(address >> 8));           // Next byte of the register address   
+  SPI_Write(ctx, (uint8_t)address);                  // Low byte of register address - usually just the 1 byte offset
   
-  HAL_SPI_Write((uint8_t)(parameter & 0xff));       // Little endian (yes, it is most significant bit first and least significant byte first)
-  HAL_SPI_Write((uint8_t)(parameter >> 8));
+  SPI_Write(ctx, (uint8_t)(parameter & 0xff));       // Little endian (yes, it is most significant bit first and least significant byte first)
+  SPI_Write(ctx, (uint8_t)(parameter >> 8));
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
 }
 
-void wr8(uint32_t address, uint8_t parameter)
+void Eve_wr8(EveContext *ctx, uint32_t address, uint8_t parameter)
 {
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
-  HAL_SPI_Write((uint8_t)(address >> 8));           // Next byte of the register address   
-  HAL_SPI_Write((uint8_t)(address));                // Low byte of register address - usually just the 1 byte offset
+  SPI_Write(ctx, (uint8_t)((address >> 16) | 0x80)); // RAM_REG = 0x302000 and high bit is set - result always 0xB0
+  SPI_Write(ctx, (uint8_t)(address >> 8));           // Next byte of the register address   
+  SPI_Write(ctx, (uint8_t)(address));                // Low byte of register address - usually just the 1 byte offset
   
-  HAL_SPI_Write(parameter);             
+  SPI_Write(ctx, parameter);             
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
 }
 
-uint32_t rd32(uint32_t address)
+uint32_t Eve_rd32(EveContext *ctx, uint32_t address)
 {
   uint8_t buf[4];
   uint32_t Data32;
   
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((address >> 16) & 0x3F);    
-  HAL_SPI_Write((address >> 8) & 0xff);    
-  HAL_SPI_Write(address & 0xff);
+  SPI_Write(ctx, (address >> 16) & 0x3F);    
+  SPI_Write(ctx, (address >> 8) & 0xff);    
+  SPI_Write(ctx, address & 0xff);
   
-  HAL_SPI_ReadBuffer(buf, 4);
+  SPI_ReadBuffer(ctx, buf, 4);
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
   
   Data32 = buf[0] + ((uint32_t)buf[1] << 8) + ((uint32_t)buf[2] << 16) + ((uint32_t)buf[3] << 24);
   return (Data32);  
 }
 
-uint16_t rd16(uint32_t address)
+uint16_t Eve_rd16(EveContext *ctx, uint32_t address)
 {
 	uint8_t buf[2] = { 0,0 };
     
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((address >> 16) & 0x3F);    
-  HAL_SPI_Write((address >> 8) & 0xff);    
-  HAL_SPI_Write(address & 0xff);
+  SPI_Write(ctx, (address >> 16) & 0x3F);    
+  SPI_Write(ctx, (address >> 8) & 0xff);    
+  SPI_Write(ctx, address & 0xff);
   
-  HAL_SPI_ReadBuffer(buf, 2);
+  SPI_ReadBuffer(ctx, buf, 2);
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
   
   uint16_t Data16 = buf[0] + ((uint16_t)buf[1] << 8);
   return (Data16);  
 }
 
-uint8_t rd8(uint32_t address)
+uint8_t Eve_rd8(EveContext *ctx, uint32_t address)
 {
   uint8_t buf[1];
   
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   
-  HAL_SPI_Write((address >> 16) & 0x3F);    
-  HAL_SPI_Write((address >> 8) & 0xff);    
-  HAL_SPI_Write(address & 0xff);
+  SPI_Write(ctx, (address >> 16) & 0x3F);    
+  SPI_Write(ctx, (address >> 8) & 0xff);    
+  SPI_Write(ctx, address & 0xff);
   
-  HAL_SPI_ReadBuffer(buf, 1);
+  SPI_ReadBuffer(ctx, buf, 1);
   
-  HAL_SPI_Disable();
+  SPI_Disable(ctx);
   
   return (buf[0]);  
 }
 
+// Write a run of bytes into RAM_CMD starting at the given FIFO offset in a single SPI transaction
+static void WriteFIFOBurst(EveContext *ctx, uint16_t offset, const uint8_t *buff, uint32_t count)
+{
+  Eve_StartCoProTransfer(ctx, offset + RAM_CMD, false);
+  SPI_WriteBuffer(ctx, (uint8_t*)buff, count);
+  SPI_Disable(ctx);
+}
+
+static bool WaitCredits(EveContext *ctx, uint16_t need);
+
+// Bytes worth an SPI transaction of their own.  Bursts are not cut down to less than this because the
+// credits happen to be low - the credits are refreshed instead - and REG_CMD_WRITE is moved when this much
+// is waiting.
+#define STREAM_BURST (FT_CMD_FIFO_SIZE / 4)
+
+// BT81x only - stream command bytes into REG_CMDB_WRITE.  The CoPro keeps its own write pointer so there is
+// no wrapping to take care of, and it starts work as soon as the data lands.  All we need to know is that 
+// there is room, which the credit count tells us.  count must be a multiple of 4.
+static void WriteCmdB(EveContext *ctx, const uint8_t *buff, uint32_t count)
+{
+  uint32_t Space;
+
+  while (count)
+  {
+    if (!WaitCredits(ctx, count < STREAM_BURST ? count : STREAM_BURST))
+      return;                                                       // The CoPro was reset - the rest is no use to it
+    Space = ctx->FifoCredits;
+    if (Space > EVE_SPI_MAX_CHUNK)
+      Space = EVE_SPI_MAX_CHUNK;
+    if (Space > count)
+      Space = count;
+    ctx->FifoCredits -= Space;
+
+    Eve_StartCoProTransfer(ctx, REG_CMDB_WRITE + RAM_REG, false);
+    SPI_WriteBuffer(ctx, (uint8_t*)buff, Space);
+    SPI_Disable(ctx);
+
+    buff += Space;
+    count -= Space;
+    ctx->FifoWriteLocation = (ctx->FifoWriteLocation + Space) % FT_CMD_FIFO_SIZE; // Mirrors REG_CMD_WRITE, which the CoPro advances itself
+    ctx->FifoTotal += Space;
+  }
+}
+
+static void CoProRecover(EveContext *ctx);
+
+// Read REG_CMD_READ, remembering it unless the CoPro has faulted (0xFFF).  Every good read is also a free
+// refresh of the credit count.
+static uint16_t ReadCoProPointer(EveContext *ctx)
+{
+  uint16_t Rd = Eve_rd16(ctx, REG_CMD_READ + RAM_REG);
+
+  if (Rd != 0xFFF)
+  {
+    ctx->CoProRead = Rd;
+    ctx->FifoCredits = (FT_CMD_FIFO_SIZE - FT_CMD_SIZE) - ((ctx->FifoWriteLocation - Rd) & (FT_CMD_FIFO_SIZE - 1));
+  }
+  return Rd;
+}
+
+// How far through FifoTotal the CoPro has got, given REG_CMD_READ.  Everything written but not yet read (or
+// published) is still pending, the rest has been executed.
+static uint32_t FifoConsumed(EveContext *ctx, uint16_t Rd)
+{
+  return ctx->FifoTotal - ctx->FifoUnpublished - ((ctx->FifoWriteLocation - ctx->FifoUnpublished - Rd) & (FT_CMD_FIFO_SIZE - 1));
+}
+
+// Tell the CoPro about everything written to RAM_CMD so far
+static void PublishFIFO(EveContext *ctx)
+{
+  Eve_wr16(ctx, REG_CMD_WRITE + RAM_REG, ctx->FifoWriteLocation);
+  ctx->FifoUnpublished = 0;
+}
+
+// Flow control.  FifoCredits is the number of bytes that can go into the FIFO without overwriting anything
+// the CoPro has not read yet.  Writers take credits as they write, and the count is only refreshed from Eve
+// when it runs short - it can only ever be too low, as the CoPro frees space but never takes it back.  So
+// the FIFO is never overrun, and a long frame costs one register read per FIFO's worth of commands.
+// Anything not yet published is published first or the CoPro would never free anything.
+// Returns false if the CoPro faulted and had to be reset on the way, in which case whatever the caller was
+// part way through sending is best dropped.
+static bool WaitCredits(EveContext *ctx, uint16_t need)
+{
+  bool Ok = true;
+
+  while (ctx->FifoCredits < need)
+  {
+    if (ctx->UseCmdB)
+    {
+      ctx->FifoCredits = Eve_rd16(ctx, REG_CMDB_SPACE + RAM_REG) & 0xFFC;
+      if (ctx->FifoCredits < need && ReadCoProPointer(ctx) == 0xFFF)    // A faulted CoPro never frees any more
+      {
+        CoProRecover(ctx);
+        Ok = false;
+      }
+      continue;
+    }
+    if (ctx->FifoUnpublished)
+      PublishFIFO(ctx);
+    if (ReadCoProPointer(ctx) == 0xFFF)
+    {
+      CoProRecover(ctx);
+      Ok = false;
+    }
+  }
+  return Ok;
+}
+
+// Push the staged commands into RAM_CMD.  This is one burst unless the data straddles the end of the 
+// 4K FIFO space, in which case it takes two - one up to the end and one from the start.
+// The write pointer register is not touched - that is still the job of UpdateFIFO().
+// On BT81x the staged commands go to REG_CMDB_WRITE instead and are executed right away.
+void Eve_FlushFIFO(EveContext *ctx)
+{
+  uint16_t First;
+
+  if (!ctx->CmdStageCount)
+    return;
+
+#if !defined(EVE_NO_FRAME_SKIP)
+  if (ctx->FrameOpen)
+    ctx->FrameSent = true;
+#endif
+
+  STAT_ENTER(ctx, EVE_STAT_UPDATE_FIFO);
+  if (ctx->UseCmdB)
+  {
+    WriteCmdB(ctx, ctx->CmdStage, ctx->CmdStageCount);
+    ctx->CmdStageCount = 0;
+    STAT_LEAVE(ctx);
+    return;
+  }
+
+  WaitCredits(ctx, ctx->CmdStageCount);
+  if (!ctx->CmdStageCount)                                              // Dropped by a CoPro reset while waiting
+  {
+    STAT_LEAVE(ctx);
+    return;
+  }
+  ctx->FifoCredits -= ctx->CmdStageCount;
+  First = FT_CMD_FIFO_SIZE - ctx->FifoWriteLocation;                    // Room before the wrap
+  if (First > ctx->CmdStageCount)
+    First = ctx->CmdStageCount;
+
+  WriteFIFOBurst(ctx, ctx->FifoWriteLocation, ctx->CmdStage, First);
+  if (ctx->CmdStageCount > First)
+    WriteFIFOBurst(ctx, 0, ctx->CmdStage + First, ctx->CmdStageCount - First);    // Remainder goes to the start of the FIFO
+
+  ctx->FifoWriteLocation = (ctx->FifoWriteLocation + ctx->CmdStageCount) % FT_CMD_FIFO_SIZE;
+  ctx->FifoTotal += ctx->CmdStageCount;
+  ctx->FifoUnpublished += ctx->CmdStageCount;
+  ctx->CmdStageCount = 0;
+  STAT_LEAVE(ctx);
+}
+
 // *** Send_Cmd() - this is like cmd() in (some) Eve docs - sends 32 bits but does not update the write pointer ***
 // FT81x Series Programmers Guide Section 5.1.1 - Circular Buffer (AKA "the FIFO" and "Command buffer" and "CoProcessor")
 // Don't miss section 5.3 - Interaction with RAM_DL
-void Send_CMD(uint32_t data)
+// The command is only staged in host RAM here - see FlushFIFO()
+static void StageWord(EveContext *ctx, uint32_t data)
+{
+  uint8_t i;
+
+  if (ctx->CmdStageCount + FT_CMD_SIZE > EVE_CMD_STAGE_SIZE)            // No room left in the staging buffer so send what we have
+  {
+    STAT_ENTER(ctx, EVE_STAT_SEND_CMD);
+    Eve_FlushFIFO(ctx);
+    STAT_LEAVE(ctx);
+  }
+
+  for (i = 0; i < FT_CMD_SIZE; i++)                                // Little endian, the same as wr32()
+  {
+#if !defined(EVE_NO_FRAME_SKIP)
+    ctx->FrameHash = (ctx->FrameHash ^ (uint8_t)data) * FRAME_HASH_PRIME;
+#endif
+    ctx->CmdStage[ctx->CmdStageCount++] = (uint8_t)data;
+    data >>= 8;
+  }
+}
+
+// Keep a command of the given encoded size in one piece - if it would not fit behind what is already staged,
+// send that first.  The command then reaches the FIFO in a single burst and the CoPro never sits waiting on
+// the rest of it.  Commands bigger than the staging buffer (very long strings) are split regardless.
+static void Reserve(EveContext *ctx, uint32_t bytes)
+{
+  if (ctx->CmdStageCount + bytes > EVE_CMD_STAGE_SIZE && bytes <= EVE_CMD_STAGE_SIZE)
+    Eve_FlushFIFO(ctx);
+}
+
+// Bytes a string takes as a command parameter - NUL terminated and padded to a whole word
+static uint32_t StringBytes(const char* str)
+{
+  return (strlen(str) + FT_CMD_SIZE) & ~(FT_CMD_SIZE - 1);
+}
+
+void Eve_Send_CMD(EveContext *ctx, uint32_t data)
+{
+#if defined(EVE_NO_FRAME_SKIP)
+  StageWord(ctx, data);
+#else
+  if (data == CMD_DLSTART)
+  {
+    if (ctx->FrameOpen)                                                 // The last one was never swapped - a segment perhaps
+      ctx->LastValid = false;
+    if (ctx->CmdStageCount + FT_CMD_SIZE > EVE_CMD_STAGE_SIZE)
+      Eve_FlushFIFO(ctx);                                                 // Start the frame with an empty buffer
+    ctx->FrameOpen = true;
+    ctx->FrameSent = false;
+    ctx->FrameVolatile = false;
+    ctx->FrameStart = ctx->CmdStageCount;
+    ctx->FrameHash = FRAME_HASH_BASIS;
+  }
+  else if (!ctx->FrameOpen)
+    ctx->LastValid = false;                                             // Commands outside a frame may change what frames draw
+  else if (IsVolatileCmd(data))
+    ctx->FrameVolatile = true;
+
+  StageWord(ctx, data);
+
+  if (data == CMD_SWAP && ctx->FrameOpen)
+  {
+    ctx->FrameOpen = false;
+    if (!ctx->FrameSent && !ctx->FrameVolatile && ctx->LastValid && ctx->FrameHash == ctx->LastHash)
+    {
+      ctx->CmdStageCount = ctx->FrameStart;                                  // Nothing has left the building - just forget it
+      ctx->FrameStats.Skipped++;
+      return;
+    }
+    if (ctx->FrameSent || ctx->FrameVolatile)
+      ctx->FrameStats.Unchecked++;
+    ctx->LastHash = ctx->FrameHash;
+    ctx->LastValid = !ctx->FrameVolatile;
+    ctx->FrameStats.Submitted++;
+  }
+#endif
+}
+
+// The parameters of a CoPro command are staged and hashed like any other word, but never looked at as commands -
+// Cmd_Number() of -255 would otherwise pass for CMD_DLSTART.  Every Cmd_ helper sends its parameters this way.
+static void SendParam(EveContext *ctx, uint32_t data)
+{
+  StageWord(ctx, data);
+}
+
+// Send_String() - send a string as the trailing parameter of a CoPro command (Cmd_Text, Cmd_Button, Cmd_Keys...)
+// The characters are packed four to a word, little endian, straight into the command stream.  The string is 
+// always terminated by a NUL and padded with more NULs out to a whole word - FT81x Series Programmers Guide 5.7
+void Eve_Send_String(EveContext *ctx, const char* str)
 {
-  wr32(FifoWriteLocation + RAM_CMD, data);                         // write the command at the globally tracked "write pointer" for the FIFO
+  uint32_t Word = 0;
+  uint8_t Shift = 0;
+
+  do
+  {
+    Word |= (uint32_t)(uint8_t)*str << Shift;                      // The terminating NUL goes in here too
+    Shift += 8;
+    if (Shift == 32)
+    {
+      StageWord(ctx, Word);
+      Word = 0;
+      Shift = 0;
+    }
+  } while (*str++);
 
-  FifoWriteLocation += FT_CMD_SIZE;                                // Increment the Write Address by the size of a command - which we just sent
-  FifoWriteLocation %= FT_CMD_FIFO_SIZE;                           // Wrap the address to the FIFO space
+  if (Shift)                                                       // Partial word left over - the rest is already zero padding
+    StageWord(ctx, Word);
 }
 
 // UpdateFIFO - Cause the CoProcessor to realize that it has work to do in the form of a 
 // differential between the read pointer and write pointer.  The CoProcessor (FIFO or "Command buffer") does
 // nothing until you tell it that the write position in the FIFO RAM has changed
-void UpdateFIFO(void)
+void Eve_UpdateFIFO(EveContext *ctx)
 {
-  wr16(REG_CMD_WRITE + RAM_REG, FifoWriteLocation);               // We manually update the write position pointer
+  STAT_ENTER(ctx, EVE_STAT_UPDATE_FIFO);
+  Eve_FlushFIFO(ctx);                                                     // Anything still staged has to be in RAM_CMD first
+  if (ctx->FifoUnpublished)                                             // REG_CMDB_WRITE has already moved the pointer for us
+    PublishFIFO(ctx);                                                 // We manually update the write position pointer
+  STAT_LEAVE(ctx);
 }
 
 // Read the specific ID register and return TRUE if it is the expected 0x7C otherwise.
-uint8_t Cmd_READ_REG_ID(void)
+uint8_t Eve_Cmd_READ_REG_ID(EveContext *ctx)
 {
   uint8_t readData[2];
   
-  HAL_SPI_Enable();
-  HAL_SPI_Write(0x30);                   // Base address RAM_REG = 0x302000
-  HAL_SPI_Write(0x20);    
-  HAL_SPI_Write(REG_ID);                 // REG_ID offset = 0x00
-  HAL_SPI_ReadBuffer(readData, 1);       // There was a dummy read of the first byte in there
-  HAL_SPI_Disable();
+  SPI_Enable(ctx);
+  SPI_Write(ctx, 0x30);                   // Base address RAM_REG = 0x302000
+  SPI_Write(ctx, 0x20);    
+  SPI_Write(ctx, REG_ID);                 // REG_ID offset = 0x00
+  SPI_ReadBuffer(ctx, readData, 1);       // There was a dummy read of the first byte in there
+  SPI_Disable(ctx);
   
   if (readData[0] == 0x7C)           // FT81x Datasheet section 5.1, Table 5-2. Return value always 0x7C
   {
@@ -615,228 +955,428 @@ uint8_t Cmd_READ_REG_ID(void)
 // ******************** Screen Object Creation CoProcessor Command Functions ******************************
 
 // *** Draw Slider - FT81x Series Programmers Guide Section 5.38 *************************************************
-void Cmd_Slider(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t options, uint16_t val, uint16_t range)
+void Eve_Cmd_Slider(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t options, uint16_t val, uint16_t range)
 {
-  Send_CMD(CMD_SLIDER);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)h << 16) | w );
-  Send_CMD( ((uint32_t)val << 16) | options );
-  Send_CMD( (uint32_t)range );
+  Reserve(ctx, 5 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_SLIDER);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)h << 16) | w );
+  SendParam(ctx,  ((uint32_t)val << 16) | options );
+  SendParam(ctx,  (uint32_t)range );
 }
 
 // *** Draw Spinner - FT81x Series Programmers Guide Section 5.54 *************************************************
-void Cmd_Spinner(uint16_t x, uint16_t y, uint16_t style, uint16_t scale)
+void Eve_Cmd_Spinner(EveContext *ctx, uint16_t x, uint16_t y, uint16_t style, uint16_t scale)
 {    
-  Send_CMD(CMD_SPINNER);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)scale << 16) | style );
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_SPINNER);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)scale << 16) | style );
 }
 
 // *** Draw Gauge - FT81x Series Programmers Guide Section 5.33 **************************************************
-void Cmd_Gauge(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor, uint16_t val, uint16_t range)
+void Eve_Cmd_Gauge(EveContext *ctx, uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor, uint16_t val, uint16_t range)
 {
-  Send_CMD(CMD_GAUGE);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)options << 16) | r );
-  Send_CMD( ((uint32_t)minor << 16) | major );
-  Send_CMD( ((uint32_t)range << 16) | val );
+  Reserve(ctx, 5 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_GAUGE);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)options << 16) | r );
+  SendParam(ctx,  ((uint32_t)minor << 16) | major );
+  SendParam(ctx,  ((uint32_t)range << 16) | val );
 }
 
 // *** Draw Dial - FT81x Series Programmers Guide Section 5.39 **************************************************
 // This is much like a Gauge except for the helpful range parameter.  For some reason, all dials are 65535 around.
-void Cmd_Dial(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t val)
+void Eve_Cmd_Dial(EveContext *ctx, uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t val)
 {
-  Send_CMD(CMD_DIAL);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)options << 16) | r );
-  Send_CMD( (uint32_t)val );
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_DIAL);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)options << 16) | r );
+  SendParam(ctx,  (uint32_t)val );
 }
 
 // *** Make Track (for a slider) - FT81x Series Programmers Guide Section 5.62 ************************************
 // tag refers to the tag # previously assigned to the object that this track is tracking.
-void Cmd_Track(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t tag)
+void Eve_Cmd_Track(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t tag)
 {
-    Send_CMD(CMD_TRACK);
-    Send_CMD( ((uint32_t)y << 16) | x );
-    Send_CMD( ((uint32_t)h << 16) | w );
-    Send_CMD( (uint32_t)tag );
+    Reserve(ctx, 4 * FT_CMD_SIZE);
+    Eve_Send_CMD(ctx, CMD_TRACK);
+    SendParam(ctx,  ((uint32_t)y << 16) | x );
+    SendParam(ctx,  ((uint32_t)h << 16) | w );
+    SendParam(ctx,  (uint32_t)tag );
 }
 
 // *** Draw Number - FT81x Series Programmers Guide Section 5.43 *************************************************
-void Cmd_Number(uint16_t x, uint16_t y, uint16_t font, uint16_t options, uint32_t num)
+void Eve_Cmd_Number(EveContext *ctx, uint16_t x, uint16_t y, uint16_t font, uint16_t options, uint32_t num)
 {
-  Send_CMD(CMD_NUMBER);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)options << 16) | font );
-  Send_CMD(num);
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_NUMBER);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)options << 16) | font );
+  SendParam(ctx, num);
 }
 
 // *** Draw Smooth Color Gradient - FT81x Series Programmers Guide Section 5.34 **********************************
-void Cmd_Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1)
+void Eve_Cmd_Gradient(EveContext *ctx, uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1)
 {
-  Send_CMD(CMD_GRADIENT);
-  Send_CMD( ((uint32_t)y0<<16)|x0 );
-  Send_CMD(rgb0);
-  Send_CMD( ((uint32_t)y1<<16)|x1 );
-  Send_CMD(rgb1);
+  Reserve(ctx, 5 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_GRADIENT);
+  SendParam(ctx,  ((uint32_t)y0<<16)|x0 );
+  SendParam(ctx, rgb0);
+  SendParam(ctx,  ((uint32_t)y1<<16)|x1 );
+  SendParam(ctx, rgb1);
 }
 
 // *** Draw Button - FT81x Series Programmers Guide Section 5.28 **************************************************
-void Cmd_Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
+void Eve_Cmd_Button(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
 { 
-  uint16_t DataPtr, LoopCount, StrPtr;
-  
-  uint16_t length = (uint16_t)strlen(str);
-  if(!length) 
+  if(!*str) 
     return;
   
-  uint32_t* data = (uint32_t*) calloc((length/4)+1, sizeof(uint32_t));
-  
-  StrPtr = 0;
-  for(DataPtr=0; DataPtr<(length/4); DataPtr++, StrPtr += 4)
-    data[DataPtr] = (uint32_t)str[StrPtr+3]<<24 | (uint32_t)str[StrPtr+2]<<16 | (uint32_t)str[StrPtr+1]<<8 | (uint32_t)str[StrPtr];
-  
-  for(LoopCount=0; LoopCount<(length%4); LoopCount++, StrPtr++)
-    data[DataPtr] |= (uint32_t)str[StrPtr] << (LoopCount * 8);
-  
-  Send_CMD(CMD_BUTTON);
-  Send_CMD( ((uint32_t)y << 16) | x ); // Put two 16 bit values together into one 32 bit value - do it little endian
-  Send_CMD( ((uint32_t)h << 16) | w );
-  Send_CMD( ((uint32_t)options << 16) | font );
-  
-  for (LoopCount = 0; LoopCount <= length / 4; LoopCount++)
-  {
-	  Send_CMD(data[LoopCount]);
-  }
-
-  free(data);
+  STAT_ENTER(ctx, EVE_STAT_CMD_BUTTON);
+  Reserve(ctx, 4 * FT_CMD_SIZE + StringBytes(str));
+  Eve_Send_CMD(ctx, CMD_BUTTON);
+  SendParam(ctx,  ((uint32_t)y << 16) | x ); // Put two 16 bit values together into one 32 bit value - do it little endian
+  SendParam(ctx,  ((uint32_t)h << 16) | w );
+  SendParam(ctx,  ((uint32_t)options << 16) | font );
+  Eve_Send_String(ctx, str);
+  STAT_LEAVE(ctx);
 }
 
 // *** Draw Text - FT81x Series Programmers Guide Section 5.41 ***************************************************
-void Cmd_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str)
+void Eve_Cmd_Text(EveContext *ctx, uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str)
 {
-  uint16_t DataPtr, LoopCount, StrPtr;
-  
-  uint16_t length = (uint16_t) strlen(str);
-  if(!length) 
+  if(!*str) 
     return; 
-  
-  uint32_t* data = (uint32_t*) calloc((length / 4) + 1, sizeof(uint32_t)); // Allocate memory for the string expansion
-  
-  StrPtr = 0;
-  for(DataPtr=0; DataPtr<(length/4); ++DataPtr, StrPtr=StrPtr+4)
-    data[DataPtr] = (uint32_t)str[StrPtr+3]<<24 | (uint32_t)str[StrPtr+2]<<16 | (uint32_t)str[StrPtr+1]<<8 | (uint32_t)str[StrPtr];
-  
-  for(LoopCount=0; LoopCount<(length%4); ++LoopCount, ++StrPtr)
-    data[DataPtr] |= (uint32_t)str[StrPtr] << (LoopCount*8);
 
   // Set up the command
-  Send_CMD(CMD_TEXT);
-  Send_CMD( ((uint32_t)y << 16) | x );
-  Send_CMD( ((uint32_t)options << 16) | font );
+  STAT_ENTER(ctx, EVE_STAT_CMD_TEXT);
+  Reserve(ctx, 3 * FT_CMD_SIZE + StringBytes(str));
+  Eve_Send_CMD(ctx, CMD_TEXT);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)options << 16) | font );
 
   // Send out the text
-  for(LoopCount = 0; LoopCount <= length/4; LoopCount++)
-    Send_CMD(data[LoopCount]);  // These text bytes get sucked up 4 at a time and fired at the FIFO
+  Eve_Send_String(ctx, str);  // These text bytes get packed 4 at a time and fired at the FIFO
+  STAT_LEAVE(ctx);
+}
+
+// *** Draw Keys - FT81x Series Programmers Guide Section 5.39 ***************************************************
+// Each character of str is one key.  The key code of the pressed key is reported as its tag.
+void Eve_Cmd_Keys(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE + StringBytes(str));
+  Eve_Send_CMD(ctx, CMD_KEYS);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)h << 16) | w );
+  SendParam(ctx,  ((uint32_t)options << 16) | font );
+  Eve_Send_String(ctx, str);
+}
 
-  free(data);
+// *** Draw Toggle - FT81x Series Programmers Guide Section 5.44 *************************************************
+// str holds both labels separated by a 0xFF character, e.g. "off\xffon"
+void Eve_Cmd_Toggle(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t font, uint16_t options, uint16_t state, const char* str)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE + StringBytes(str));
+  Eve_Send_CMD(ctx, CMD_TOGGLE);
+  SendParam(ctx,  ((uint32_t)y << 16) | x );
+  SendParam(ctx,  ((uint32_t)font << 16) | w );
+  SendParam(ctx,  ((uint32_t)state << 16) | options );
+  Eve_Send_String(ctx, str);
 }
 
 // ******************** Miscellaneous Operation CoProcessor Command Functions ******************************
 
 // *** Cmd_SetBitmap - generate DL commands for bitmap parms - FT81x Series Programmers Guide Section 5.65 *******
-void Cmd_SetBitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height)
+void Eve_Cmd_SetBitmap(EveContext *ctx, uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx,  CMD_SETBITMAP );
+  SendParam(ctx,  addr );
+  SendParam(ctx,  ((uint32_t)width << 16) | fmt );
+  SendParam(ctx,  (uint32_t)height);
+}
+
+// *** Cmd_SetFont - register a custom font on a bitmap handle - FT81x Series Programmers Guide Section 5.64 ******
+// There is no string here - ptr is the RAM_G address of the font metric block
+void Eve_Cmd_SetFont(EveContext *ctx, uint32_t font, uint32_t ptr)
+{
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_SETFONT);
+  SendParam(ctx, font);
+  SendParam(ctx, ptr);
+}
+
+// *** Cmd_Memset - fill a block of RAM_G with a byte - FT81x Series Programmers Guide Section 5.26 **************
+void Eve_Cmd_Memset(EveContext *ctx, uint32_t ptr, uint32_t value, uint32_t num)
 {
-  Send_CMD( CMD_SETBITMAP );
-  Send_CMD( addr );
-  Send_CMD( ((uint32_t)width << 16) | fmt );
-  Send_CMD( (uint32_t)height);
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_MEMSET);
+  SendParam(ctx, ptr);
+  SendParam(ctx, value);
+  SendParam(ctx, num);
 }
 
 // *** Cmd_Memcpy - background copy a block of data - FT81x Series Programmers Guide Section 5.27 ****************
-void Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num)
+void Eve_Cmd_Memcpy(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_MEMCPY);
+  SendParam(ctx, dest);
+  SendParam(ctx, src);
+  SendParam(ctx, num);
+}
+
+// *** Cmd_Append - splice a display list held in RAM_G into this one - FT81x Series Programmers Guide Section 5.28
+void Eve_Cmd_Append(EveContext *ctx, uint32_t ptr, uint32_t num)
+{
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_APPEND);
+  SendParam(ctx, ptr);
+  SendParam(ctx, num);
+}
+
+// *** Cmd_Inflate - decompress into RAM_G - FT81x Series Programmers Guide Section 5.18 *************************
+// The zlib stream has to follow in the FIFO - CoProWrCmdBuf() or Eve_CoProStream() - and the CoPro is busy
+// until all of it has arrived.
+void Eve_Cmd_Inflate(EveContext *ctx, uint32_t ptr)
+{
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_INFLATE);
+  SendParam(ctx, ptr);
+}
+
+// *** Cmd_MemCrc - CRC-32 of a block of RAM_G - FT81x Series Programmers Guide Section 5.24 ********************
+// The CoPro writes the answer over the last parameter in the FIFO, so this waits for it and reads it back.
+uint32_t Eve_Cmd_MemCrc(EveContext *ctx, uint32_t ptr, uint32_t num)
+{
+  uint16_t Result = Eve_Cmd_MemCrcQueue(ctx, ptr, num);
+
+  Eve_UpdateFIFO(ctx);
+  Eve_Wait4CoProFIFOEmpty(ctx);
+  return Eve_CmdResult(ctx, Result);
+}
+
+// The same without the wait, so that a run of them can be sent in one go.  Returns the FIFO offset the CRC
+// will be written to - read it with Eve_CmdResult() once the CoPro has got that far, and before another
+// FIFO's worth of commands has gone in over it.
+uint16_t Eve_Cmd_MemCrcQueue(EveContext *ctx, uint32_t ptr, uint32_t num)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_MEMCRC);
+  SendParam(ctx, ptr);
+  SendParam(ctx, num);
+  SendParam(ctx, 0);
+  return (ctx->FifoWriteLocation + ctx->CmdStageCount - FT_CMD_SIZE) & (FT_CMD_FIFO_SIZE - 1);
+}
+
+// A word the CoPro wrote back into the FIFO, at an offset from Eve_Cmd_MemCrcQueue()
+uint32_t Eve_CmdResult(EveContext *ctx, uint16_t Where)
+{
+  return Eve_rd32(ctx, RAM_CMD + Where);
+}
+
+// The CRC-32 Cmd_MemCrc() would get for the same bytes, worked out on the host.  Start with Crc 0, or pass
+// the last result to carry on over more data.
+static const uint32_t Crc32Table[256] = {
+  0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+  0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+  0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+  0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+  0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+  0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+  0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+  0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+  0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+  0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+  0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+  0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+  0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+  0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+  0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+  0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+  0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+  0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+  0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+  0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+  0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+  0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+  0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+  0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+  0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+  0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+  0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+  0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+  0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+  0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+  0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+  0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+};
+
+uint32_t Eve_Crc32(uint32_t Crc, const uint8_t *Data, uint32_t Size)
 {
-  Send_CMD(CMD_MEMCPY);
-  Send_CMD(dest);
-  Send_CMD(src);
-  Send_CMD(num);
+  Crc = ~Crc;
+  while (Size--)
+    Crc = Crc32Table[(Crc ^ *Data++) & 0xFF] ^ (Crc >> 8);
+  return ~Crc;
+}
+
+// *** Cmd_LoadImage - decode a JPEG or PNG into RAM_G - FT81x Series Programmers Guide Section 5.19 ************
+// Without OPT_MEDIAFIFO the file has to follow in the FIFO, as for Cmd_Inflate().  With it the CoPro takes the
+// file from the media FIFO - see Eve_MediaFifo_LoadImage().
+void Eve_Cmd_LoadImage(EveContext *ctx, uint32_t ptr, uint32_t options)
+{
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_LOADIMAGE);
+  SendParam(ctx, ptr);
+  SendParam(ctx, options);
+}
+
+// *** Cmd_MediaFifo - set up a media FIFO in RAM_G - FT81x Series Programmers Guide Section 5.20 ****************
+// Eve_MediaFifo_Init() does this and keeps track of the FIFO afterwards.
+void Eve_Cmd_MediaFifo(EveContext *ctx, uint32_t ptr, uint32_t size)
+{
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_MEDIAFIFO);
+  SendParam(ctx, ptr);
+  SendParam(ctx, size);
+}
+
+// *** Cmd_PlayVideo - play an AVI file - FT81x Series Programmers Guide Section 5.21 ****************************
+// The file follows in the FIFO, or with OPT_MEDIAFIFO comes from the media FIFO.  The CoPro is busy until the
+// end of it.
+void Eve_Cmd_PlayVideo(EveContext *ctx, uint32_t options)
+{
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_PLAYVIDEO);
+  SendParam(ctx, options);
+}
+
+// *** Cmd_VideoStart - start an AVI from the media FIFO - FT81x Series Programmers Guide Section 5.22 ***********
+void Eve_Cmd_VideoStart(EveContext *ctx)
+{
+  Reserve(ctx, FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_VIDEOSTART);
+}
+
+// *** Cmd_VideoFrame - decode the next video frame - FT81x Series Programmers Guide Section 5.23 ****************
+// The frame goes to dst, and the word at ptr is set to 0 after the last frame of the video, 1 before that.
+void Eve_Cmd_VideoFrame(EveContext *ctx, uint32_t dst, uint32_t ptr)
+{
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_VIDEOFRAME);
+  SendParam(ctx, dst);
+  SendParam(ctx, ptr);
 }
 
 // *** Cmd_GetPtr - Get the last used address from CoPro operation - FT81x Series Programmers Guide Section 5.47 *
-void Cmd_GetPtr(void)
+void Eve_Cmd_GetPtr(EveContext *ctx)
 {
-  Send_CMD(CMD_GETPTR);
-  Send_CMD(0);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_GETPTR);
+  SendParam(ctx, 0);
 }
 
 // *** Set Highlight Gradient Color - FT81x Series Programmers Guide Section 5.32 ********************************
-void Cmd_GradientColor(uint32_t c)
+void Eve_Cmd_GradientColor(EveContext *ctx, uint32_t c)
 {
-  Send_CMD(CMD_GRADCOLOR);
-  Send_CMD(c);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_GRADCOLOR);
+  SendParam(ctx, c);
 }
 
 // *** Set FG color - FT81x Series Programmers Guide Section 5.30 ************************************************
-void Cmd_FGcolor(uint32_t c)
+void Eve_Cmd_FGcolor(EveContext *ctx, uint32_t c)
 {
-  Send_CMD(CMD_FGCOLOR);
-  Send_CMD(c);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_FGCOLOR);
+  SendParam(ctx, c);
 }
 
 // *** Set BG color - FT81x Series Programmers Guide Section 5.31 ************************************************
-void Cmd_BGcolor(uint32_t c)
+void Eve_Cmd_BGcolor(EveContext *ctx, uint32_t c)
 {
-  Send_CMD(CMD_BGCOLOR);
-  Send_CMD(c);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_BGCOLOR);
+  SendParam(ctx, c);
 }
 
 // *** Translate Matrix - FT81x Series Programmers Guide Section 5.51 ********************************************
-void Cmd_Translate(uint32_t tx, uint32_t ty)
+void Eve_Cmd_Translate(EveContext *ctx, uint32_t tx, uint32_t ty)
 {
-  Send_CMD(CMD_TRANSLATE);
-  Send_CMD(tx);
-  Send_CMD(ty);
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_TRANSLATE);
+  SendParam(ctx, tx);
+  SendParam(ctx, ty);
 }
 
 // *** Rotate Matrix - FT81x Series Programmers Guide Section 5.50 ***********************************************
-void Cmd_Rotate(uint32_t a)
+void Eve_Cmd_Rotate(EveContext *ctx, uint32_t a)
 {
-  Send_CMD(CMD_ROTATE);
-  Send_CMD(a);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_ROTATE);
+  SendParam(ctx, a);
 }
 
 // *** Rotate Screen - FT81x Series Programmers Guide Section 5.53 ***********************************************
-void Cmd_SetRotate(uint32_t rotation)
+void Eve_Cmd_SetRotate(EveContext *ctx, uint32_t rotation)
 {
-  Send_CMD(CMD_SETROTATE);
-  Send_CMD(rotation);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_SETROTATE);
+  SendParam(ctx, rotation);
 }
 
 // *** Scale Matrix - FT81x Series Programmers Guide Section 5.49 ************************************************
-void Cmd_Scale(uint32_t sx, uint32_t sy)
+void Eve_Cmd_Scale(EveContext *ctx, uint32_t sx, uint32_t sy)
 {
-  Send_CMD(CMD_SCALE);
-  Send_CMD(sx);
-  Send_CMD(sy);
+  Reserve(ctx, 3 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_SCALE);
+  SendParam(ctx, sx);
+  SendParam(ctx, sy);
 }
 
-void Cmd_Flash_Fast(void)
+void Eve_Cmd_Flash_Fast(EveContext *ctx)
 {
-  Send_CMD(CMD_FLASHFAST);
-  Send_CMD(0);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_FLASHFAST);
+  SendParam(ctx, 0);
+}
+
+// *** Cmd_FlashUpdate - write RAM_G to flash, erasing and programming only the sectors that differ (BT81x) *****
+// * dest and num multiples of 4096, src 4 byte aligned.  The flash has to be in full speed mode.
+void Eve_Cmd_FlashUpdate(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_FLASHUPDATE);
+  SendParam(ctx, dest);
+  SendParam(ctx, src);
+  SendParam(ctx, num);
+}
+
+// *** Cmd_FlashRead - copy from attached flash to RAM_G (BT81x) *************************************************
+// * dest 4 byte aligned, src 64 byte aligned, num a multiple of 4.  The flash has to be in full speed mode.
+void Eve_Cmd_FlashRead(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num)
+{
+  Reserve(ctx, 4 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_FLASHREAD);
+  SendParam(ctx, dest);
+  SendParam(ctx, src);
+  SendParam(ctx, num);
 }
 
 // *** Calibrate Touch Digitizer - FT81x Series Programmers Guide Section 5.52 ***********************************
 // * This business about "result" in the manual really seems to be simply leftover cruft of no purpose - send zero
-void Cmd_Calibrate(uint32_t result)
+void Eve_Cmd_Calibrate(EveContext *ctx, uint32_t result)
 {
-  Send_CMD(CMD_CALIBRATE);
-  Send_CMD(result);
+  Reserve(ctx, 2 * FT_CMD_SIZE);
+  Eve_Send_CMD(ctx, CMD_CALIBRATE);
+  SendParam(ctx, result);
 }
 
 // An interactive calibration screen is created and executed.  
 // New calibration values are written to the touch matrix registers of Eve.
-void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset)
+void Eve_Calibrate_Manual(EveContext *ctx, uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset)
 {
   uint32_t displayX[3], displayY[3];
   uint32_t touchX[3], touchY[3]; 
@@ -857,33 +1397,35 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
   displayX[2] = (uint32_t) (Width / 2) + H_Offset;
   displayY[2] = (uint32_t) (Height * 0.85) + V_Offset;
 
+  STAT_ENTER(ctx, EVE_STAT_CALIBRATE);
+
   while (count < 3) 
   {
-    Send_CMD(CMD_DLSTART);
-    Send_CMD(CLEAR_COLOR_RGB(0, 0, 0));	
-    Send_CMD(CLEAR(1,1,1));
+    Eve_Send_CMD(ctx, CMD_DLSTART);
+    Eve_Send_CMD(ctx, CLEAR_COLOR_RGB(0, 0, 0));	
+    Eve_Send_CMD(ctx, CLEAR(1,1,1));
 
     // Draw Calibration Point on screen
-    Send_CMD(COLOR_RGB(255, 0, 0));
-    Send_CMD(POINT_SIZE(20 * 16));
-    Send_CMD(BEGIN(POINTS));
-    Send_CMD(VERTEX2F((uint32_t)(displayX[count]) * 16, (uint32_t)((displayY[count])) * 16)); 
-    Send_CMD(END());
-    Send_CMD(COLOR_RGB(255, 255, 255));
-    Cmd_Text((Width / 2) + H_Offset, (Height / 3) + V_Offset, 27, OPT_CENTER, "Calibrating");
-    Cmd_Text((Width / 2) + H_Offset, (Height / 2) + V_Offset, 27, OPT_CENTER, "Please tap the dots");
+    Eve_Send_CMD(ctx, COLOR_RGB(255, 0, 0));
+    Eve_Send_CMD(ctx, POINT_SIZE(20 * 16));
+    Eve_Send_CMD(ctx, BEGIN(POINTS));
+    Eve_Send_CMD(ctx, VERTEX2F((uint32_t)(displayX[count]) * 16, (uint32_t)((displayY[count])) * 16)); 
+    Eve_Send_CMD(ctx, END());
+    Eve_Send_CMD(ctx, COLOR_RGB(255, 255, 255));
+    Eve_Cmd_Text(ctx, (Width / 2) + H_Offset, (Height / 3) + V_Offset, 27, OPT_CENTER, "Calibrating");
+    Eve_Cmd_Text(ctx, (Width / 2) + H_Offset, (Height / 2) + V_Offset, 27, OPT_CENTER, "Please tap the dots");
     num[0] = count + 0x31; num[1] = 0;                                            // null terminated string of one character
-    Cmd_Text(displayX[count], displayY[count], 27, OPT_CENTER, num);
+    Eve_Cmd_Text(ctx, displayX[count], displayY[count], 27, OPT_CENTER, num);
 
-    Send_CMD(DISPLAY());
-    Send_CMD(CMD_SWAP);
-    UpdateFIFO();                                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
-    Wait4CoProFIFOEmpty();                                                        // wait here until the coprocessor has read and executed every pending command.
-    HAL_Delay(300);
+    Eve_Send_CMD(ctx, DISPLAY());
+    Eve_Send_CMD(ctx, CMD_SWAP);
+    Eve_UpdateFIFO(ctx);                                                                 // Trigger the CoProcessor to start processing commands out of the FIFO
+    Eve_Wait4CoProFIFOEmpty(ctx);                                                        // wait here until the coprocessor has read and executed every pending command.
+    Delay(ctx, 300);
 
 	while (pressed == count)
 	{
-		touchValue = rd32(REG_TOUCH_DIRECT_XY + RAM_REG);                             // Read for any new touch tag inputs
+		touchValue = Eve_rd32(ctx, REG_TOUCH_DIRECT_XY + RAM_REG);                             // Read for any new touch tag inputs
 		if (!(touchValue & 0x80000000))
 		{
 			touchX[count] = (touchValue >> 16) & 0x03FF;                                  // Raw Touchscreen Y coordinate
@@ -922,7 +1464,7 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
   count = 0;
   do
   {
-    wr32(REG_TOUCH_TRANSFORM_A + RAM_REG + (count * 4), TransMatrix[count]);  // Write to Eve config registers
+    Eve_wr32(ctx, REG_TOUCH_TRANSFORM_A + RAM_REG + (count * 4), TransMatrix[count]);  // Write to Eve config registers
 
 //    uint16_t ValH = TransMatrix[count] >> 16;
 //    uint16_t ValL = TransMatrix[count] & 0xFFFF;
@@ -930,44 +1472,93 @@ void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16
     
     count++;
   }while(count < 6);
+  STAT_LEAVE(ctx);
+}
+// ***************************************************************************************************************
+// *** Retained display list segments ****************************************************************************
+// ***************************************************************************************************************
+// Static parts of a screen are turned into display list once and kept in RAM_G.  Every frame after that
+// replays them with a single CMD_APPEND (12 bytes) instead of sending the commands that built them again.
+//
+//   Eve_SegmentBegin();
+//   ... Cmd_Text(), Cmd_Button(), Send_CMD(...) for the static chrome ...
+//   Size = Eve_SegmentEnd(ChromeAddr);
+//
+//   Send_CMD(CMD_DLSTART);
+//   Send_CMD(CLEAR(1, 1, 1));
+//   Cmd_Append(ChromeAddr, Size);
+//   ... live values ...
+//
+// The segment carries its graphics state changes with it - wrap it in SAVE_CONTEXT() / RESTORE_CONTEXT() if
+// the commands after the CMD_APPEND should not inherit them.  A segment that draws widgets depends on the
+// fonts and bitmap handles in place when it was recorded.  Record segments between frames, the recording
+// is done in the display list that the next CMD_DLSTART starts over.
+
+// Start a new display list for the CoProcessor to record into.
+void Eve_SegmentBegin(EveContext *ctx)
+{
+  Eve_Send_CMD(ctx, CMD_DLSTART);
+}
+
+// Copy what the CoProcessor made of the commands since Eve_SegmentBegin() to dest in RAM_G (4 byte aligned).
+// Returns the size of the segment in bytes - the num for Cmd_Append() - which is at most FT_DL_SIZE.
+uint32_t Eve_SegmentEnd(EveContext *ctx, uint32_t dest)
+{
+  uint32_t Size;
+
+  Eve_UpdateFIFO(ctx);
+  Eve_Wait4CoProFIFOEmpty(ctx);                                  // REG_CMD_DL is only settled once everything ran
+  Size = Eve_rd16(ctx, REG_CMD_DL + RAM_REG);
+  if (Size)
+  {
+    Eve_Cmd_Memcpy(ctx, dest, RAM_DL, Size);                       // Runs in order, ahead of anything sent after it
+    Eve_UpdateFIFO(ctx);
+  }
+  return Size;
 }
+
 // ***************************************************************************************************************
 // *** Animation functions ***************************************************************************************
 // ***************************************************************************************************************
 
-void Cmd_AnimStart(int32_t ch, uint32_t aoptr, uint32_t loop)
+void Eve_Cmd_AnimStart(EveContext *ctx, int32_t ch, uint32_t aoptr, uint32_t loop)
 {
-	Send_CMD(CMD_ANIMSTART);
-	Send_CMD(ch);
-	Send_CMD(aoptr);
-	Send_CMD(loop);
+	Reserve(ctx, 4 * FT_CMD_SIZE);
+	Eve_Send_CMD(ctx, CMD_ANIMSTART);
+	SendParam(ctx, ch);
+	SendParam(ctx, aoptr);
+	SendParam(ctx, loop);
 }
 
-void Cmd_AnimStop(int32_t ch)
+void Eve_Cmd_AnimStop(EveContext *ctx, int32_t ch)
 {
-	Send_CMD(CMD_ANIMSTOP);
-	Send_CMD(ch);
+	Reserve(ctx, 2 * FT_CMD_SIZE);
+	Eve_Send_CMD(ctx, CMD_ANIMSTOP);
+	SendParam(ctx, ch);
 }
 
-void Cmd_AnimXY(int32_t ch, int16_t x, int16_t y)
+void Eve_Cmd_AnimXY(EveContext *ctx, int32_t ch, int16_t x, int16_t y)
 {
-	Send_CMD(CMD_ANIMXY);
-	Send_CMD(ch);
-	Send_CMD(((uint32_t)y << 16) | x);
+	Reserve(ctx, 3 * FT_CMD_SIZE);
+	Eve_Send_CMD(ctx, CMD_ANIMXY);
+	SendParam(ctx, ch);
+	SendParam(ctx, ((uint32_t)y << 16) | x);
 }
 
-void Cmd_AnimDraw(int32_t ch)
+void Eve_Cmd_AnimDraw(EveContext *ctx, int32_t ch)
 {
-	Send_CMD(CMD_ANIMDRAW);
-	Send_CMD(ch);
+	Reserve(ctx, 2 * FT_CMD_SIZE);
+	Eve_Send_CMD(ctx, CMD_ANIMDRAW);
+	SendParam(ctx, ch);
 }
 
-void Cmd_AnimDrawFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
+void Eve_Cmd_AnimDrawFrame(EveContext *ctx, int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
 {
-	Send_CMD(CMD_ANIMFRAME);
-	Send_CMD(((uint32_t)y << 16) | x);
-	Send_CMD(aoptr);
-	Send_CMD(frame);
+	Reserve(ctx, 4 * FT_CMD_SIZE);
+	Eve_Send_CMD(ctx, CMD_ANIMFRAME);
+	SendParam(ctx, ((uint32_t)y << 16) | x);
+	SendParam(ctx, aoptr);
+	SendParam(ctx, frame);
 }
 
 // ***************************************************************************************************************
@@ -975,140 +1566,607 @@ void Cmd_AnimDrawFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
 // ***************************************************************************************************************
 
 // Find the space available in the GPU AKA CoProcessor AKA command buffer AKA FIFO
-uint16_t CoProFIFO_FreeSpace(void)
+uint16_t Eve_CoProFIFO_FreeSpace(EveContext *ctx)
 {
   uint16_t cmdBufferDiff, cmdBufferRd, cmdBufferWr, retval;
-  
-  cmdBufferRd = rd16(REG_CMD_READ + RAM_REG);
-  cmdBufferWr = rd16(REG_CMD_WRITE + RAM_REG);
+
+  STAT_ENTER(ctx, EVE_STAT_FIFO_WAIT);
+  if (ctx->UseCmdB)
+  {
+    retval = Eve_rd16(ctx, REG_CMDB_SPACE + RAM_REG) & 0xFFC;               // BT81x keeps the answer in a register
+    ctx->FifoCredits = retval;
+  }
+  else
+  {
+    cmdBufferRd = ReadCoProPointer(ctx);
+    if (cmdBufferRd == 0xFFF)
+    {
+      CoProRecover(ctx);
+      cmdBufferRd = 0;
+    }
+    cmdBufferWr = ctx->FifoWriteLocation;                               // Counting what is written but not yet published
     
-  cmdBufferDiff = (cmdBufferWr-cmdBufferRd) % FT_CMD_FIFO_SIZE; // FT81x Programmers Guide 5.1.1
-  retval = (FT_CMD_FIFO_SIZE - 4) - cmdBufferDiff;
+    cmdBufferDiff = (cmdBufferWr-cmdBufferRd) % FT_CMD_FIFO_SIZE; // FT81x Programmers Guide 5.1.1
+    retval = (FT_CMD_FIFO_SIZE - 4) - cmdBufferDiff;
+  }
+  STAT_LEAVE(ctx);
   return (retval);
 }
 
 // Sit and wait until there are the specified number of bytes free in the <GPU/CoProcessor> incoming FIFO
-void Wait4CoProFIFO(uint32_t room)
+void Eve_Wait4CoProFIFO(EveContext *ctx, uint32_t room)
 {
    uint16_t getfreespace;
    
+   STAT_ENTER(ctx, EVE_STAT_FIFO_WAIT);
    do {
-     getfreespace = CoProFIFO_FreeSpace();
+     getfreespace = Eve_CoProFIFO_FreeSpace(ctx);
    }while(getfreespace < room);
+   STAT_LEAVE(ctx);
+}
+
+// Eve is unhappy - REG_CMD_READ reads 0xFFF.  Print what it says in RAM_ERR_REPORT and reset the CoProcessor.
+// This is a error which would require sophistication to fix and continue but we fake it somewhat unsuccessfully.
+// Every frame still in flight is reported as not completed.
+static void CoProRecover(EveContext *ctx)
+{
+  uint8_t ErrChar;
+  uint8_t buffy[2];
+  uint8_t Offset = 0;
+
+  Log("\n");
+  do
+  {
+    // Get the error character and display it
+    ErrChar = Eve_rd8(ctx, RAM_ERR_REPORT + Offset);
+    Offset++;
+    sprintf(buffy, "%c", ErrChar);
+    Log(buffy);
+  }while ( (ErrChar != 0) && (Offset < 128) ); // when the last stuffed character was null, we are done
+  Log("\n");
+
+  // Eve is unhappy - needs a paddling.
+  uint32_t Patch_Add = Eve_rd32(ctx, REG_COPRO_PATCH_PTR + RAM_REG);
+  Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 1);
+  Eve_wr16(ctx, REG_CMD_READ + RAM_REG, 0);
+  Eve_wr16(ctx, REG_CMD_WRITE + RAM_REG, 0);
+  Eve_wr16(ctx, REG_CMD_DL + RAM_REG, 0);
+  Eve_wr8(ctx, REG_CPU_RESET + RAM_REG, 0);
+  Eve_wr32(ctx, REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
+  ctx->FifoWriteLocation = 0;                                       // We just put the write pointer back to the start
+  ctx->FifoUnpublished = 0;
+  ctx->CoProRead = 0;
+  ctx->FifoCredits = FT_CMD_FIFO_SIZE - FT_CMD_SIZE;
+  ctx->CmdStageCount = 0;                                         // Staged behind the fault - meaningless to a fresh FIFO
+  Eve_FrameInvalidate(ctx);                                       // No telling what made it to the screen
+#if !defined(EVE_NO_FRAME_SKIP)
+  ctx->FrameStart = 0;
+#endif
+  while (ctx->InFlightCount)
+  {
+    if (ctx->FrameDone)
+      ctx->FrameDone(ctx->InFlight[ctx->InFlightFirst].Frame, false, ctx->FrameDoneUser);
+    ctx->InFlightFirst = (ctx->InFlightFirst + 1) % EVE_FRAME_QUEUE;
+    ctx->InFlightCount--;
+  }
+  Delay(ctx, 250);  // we already saw one error message and we don't need to see then 1000 times a second
 }
 
 // Sit and wait until the CoPro FIFO is empty
 // Detect operational errors and print the error and stop.
-void Wait4CoProFIFOEmpty(void)
+void Eve_Wait4CoProFIFOEmpty(EveContext *ctx)
 {
   uint16_t ReadReg;
-  uint8_t ErrChar;
-  uint8_t buffy[2];
+
+  STAT_ENTER(ctx, EVE_STAT_FIFO_EMPTY);
   do
   {
-    ReadReg = rd16(REG_CMD_READ + RAM_REG);
+    ReadReg = ReadCoProPointer(ctx);
     if(ReadReg == 0xFFF)
+      CoProRecover(ctx);
+  }while( ReadReg != ((ctx->FifoWriteLocation - ctx->FifoUnpublished) & (FT_CMD_FIFO_SIZE - 1)) );  // Where REG_CMD_WRITE is
+  STAT_LEAVE(ctx);
+}
+
+// A point in the command stream - everything sent so far.  Eve_WaitCoProMark() waits for the CoPro to get
+// there while it carries on with whatever has been sent since.
+uint32_t Eve_CoProMark(EveContext *ctx)
+{
+  Eve_UpdateFIFO(ctx);
+  return ctx->FifoTotal;
+}
+
+// Where the next command goes in RAM_CMD, as the FifoWriteLocation global used to say.  Commands still staged
+// on the host are not counted until they are sent.
+uint16_t Eve_FifoWriteLocation(EveContext *ctx)
+{
+  return ctx->FifoWriteLocation;
+}
+
+// For commands that keep the CoPro busy for a long time (flash programming) - polls every millisecond rather
+// than flat out.  Returns false if the CoPro faulted.
+bool Eve_WaitCoProMark(EveContext *ctx, uint32_t Mark)
+{
+  uint32_t Consumed, Last = 0;
+  uint16_t Rd;
+  bool First = true;
+
+  STAT_ENTER(ctx, EVE_STAT_FIFO_EMPTY);
+  for (;;)
+  {
+    Rd = ReadCoProPointer(ctx);
+    if (Rd == 0xFFF)
     {
-      // this is a error which would require sophistication to fix and continue but we fake it somewhat unsuccessfully
-      Log("\n");
-      uint8_t Offset = 0;
-      do
-      {
-        // Get the error character and display it
-        ErrChar = rd8(RAM_ERR_REPORT + Offset);
-        Offset++;
-        sprintf(buffy, "%c", ErrChar);
-        Log(buffy);
-      }while ( (ErrChar != 0) && (Offset < 128) ); // when the last stuffed character was null, we are done
-      Log("\n");
-
-      // Eve is unhappy - needs a paddling.
-      uint32_t Patch_Add = rd32(REG_COPRO_PATCH_PTR + RAM_REG);
-      wr8(REG_CPU_RESET + RAM_REG, 1);
-      wr8(REG_CMD_READ + RAM_REG, 0);
-      wr8(REG_CMD_WRITE + RAM_REG, 0);
-      wr8(REG_CMD_DL + RAM_REG, 0);
-      wr8(REG_CPU_RESET + RAM_REG, 0);
-      wr32(REG_COPRO_PATCH_PTR + RAM_REG, Patch_Add);
-      HAL_Delay(250);  // we already saw one error message and we don't need to see then 1000 times a second
+      CoProRecover(ctx);
+      STAT_LEAVE(ctx);
+      return false;
     }
-  }while( ReadReg != rd16(REG_CMD_WRITE + RAM_REG) );
+    Consumed = FifoConsumed(ctx, Rd);
+    if ((int32_t)(Consumed - Mark) >= 0)
+      break;
+    if (!First && Consumed == Last)
+      Delay(ctx, 1);                                             // Still on the same command
+    Last = Consumed;
+    First = false;
+  }
+  STAT_LEAVE(ctx);
+  return true;
 }
 
 // Every CoPro transaction starts with enabling the SPI and sending an address
-void StartCoProTransfer(uint32_t address, uint8_t reading)
+void Eve_StartCoProTransfer(EveContext *ctx, uint32_t address, uint8_t reading)
 {
-  HAL_SPI_Enable();
+  SPI_Enable(ctx);
   if (reading){
-    HAL_SPI_Write(address >> 16);
-    HAL_SPI_Write(address >> 8);
-    HAL_SPI_Write(address);
-    HAL_SPI_Write(0);
+    SPI_Write(ctx, address >> 16);
+    SPI_Write(ctx, address >> 8);
+    SPI_Write(ctx, address);
+    SPI_Write(ctx, 0);
   }else{
-    HAL_SPI_Write((address >> 16) | 0x80); 
-    HAL_SPI_Write(address >> 8);           
-    HAL_SPI_Write(address);                
+    SPI_Write(ctx, (address >> 16) | 0x80); 
+    SPI_Write(ctx, address >> 8);           
+    SPI_Write(ctx, address);                
+  }
+}
+
+// *** Streaming data through the FIFO ***************************************************************************
+// Commands like CMD_LOADIMAGE, CMD_INFLATE and CMD_PLAYVIDEO are followed by their data in the command FIFO, and
+// there is usually far more of it than the 4K FIFO holds.  So it goes in as fast as the CoPro makes room:
+// each burst is as big as the free space allows (split in two where it crosses the end of RAM_CMD), and
+// REG_CMD_WRITE is only moved once a worthwhile amount is waiting, when the credits run out, or at the end.
+// Even though the FIFO is busy, other registers can still be read and written in between.
+
+// Put count bytes (a multiple of 4) into the FIFO behind whatever is already there
+static void StreamWords(EveContext *ctx, const uint8_t *buff, uint32_t count)
+{
+  uint32_t Chunk;
+
+  if (ctx->UseCmdB)
+  {
+    WriteCmdB(ctx, buff, count);                                  // No wrap and no write pointer to worry about
+    return;
+  }
+
+  while (count)
+  {
+    if (!WaitCredits(ctx, count < STREAM_BURST ? count : STREAM_BURST))
+      return;                                                       // The CoPro was reset - the rest is no use to it
+    Chunk = ctx->FifoCredits;
+    if (Chunk > (uint32_t)(FT_CMD_FIFO_SIZE - ctx->FifoWriteLocation))  // Stop at the end of RAM_CMD, the rest goes to the start
+      Chunk = FT_CMD_FIFO_SIZE - ctx->FifoWriteLocation;
+    if (Chunk > EVE_SPI_MAX_CHUNK)
+      Chunk = EVE_SPI_MAX_CHUNK;
+    if (Chunk > count)
+      Chunk = count;
+
+    WriteFIFOBurst(ctx, ctx->FifoWriteLocation, buff, Chunk);
+    ctx->FifoWriteLocation = (ctx->FifoWriteLocation + Chunk) % FT_CMD_FIFO_SIZE;
+    ctx->FifoCredits -= Chunk;
+    ctx->FifoTotal += Chunk;
+    ctx->FifoUnpublished += Chunk;
+    buff += Chunk;
+    count -= Chunk;
+
+    if (ctx->FifoUnpublished >= STREAM_BURST && (ctx->FifoWriteLocation || !count))
+      PublishFIFO(ctx);                                         // Not between the two halves of a wrapped burst
   }
 }
 
 // *** CoProWrCmdBuf() - Transfer a buffer into the CoPro FIFO as part of an ongoing command operation ***********
-void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
+// A ragged end is padded out to a whole word with zeros.
+void Eve_CoProWrCmdBuf(EveContext *ctx, const uint8_t *buff, uint32_t count)
 {
-  uint32_t TransferSize = 0;
-  int32_t Remaining = count; // signed
-
-  do {                
-    // Here is the situation:  You have up to about a megabyte of data to transfer into the FIFO
-    // Your buffer is LogBuf - limited to 64 bytes (or some other value, but always limited).
-    // You need to go around in loops taking 64 bytes at a time until all the data is gone.
-    //
-    // Most interactions with the FIFO are started and finished in one operation in an obvious fashion, but 
-    // here it is important to understand the difference between Eve RAM registers and Eve FIFO.  Even though 
-    // you are in the middle of a FIFO operation and filling the FIFO is an ongoing task, you are still free 
-    // to write and read non-FIFO registers on the Eve chip.
-    //
-    // Since the FIFO is 4K in size, but the RAM_G space is 1M in size, you can not, obviously, send all
-    // the possible RAM_G data through the FIFO in one step.  Also, since the Eve is not capable of updating
-    // it's own FIFO pointer as data is written, you will need to intermittently tell Eve to go process some
-    // FIFO in order to make room in the FIFO for more RAM_G data.    
-    Wait4CoProFIFO(WorkBuffSz);                            // It is reasonable to wait for a small space instead of firing data piecemeal
-
-    if (Remaining > WorkBuffSz)                            // Remaining data exceeds the size of our buffer
-      TransferSize = WorkBuffSz;                           // So set the transfer size to that of our buffer
-    else
+  uint32_t Whole = count & ~3UL;
+  uint8_t Tail[4] = { 0, 0, 0, 0 };
+
+  STAT_ENTER(ctx, EVE_STAT_COPRO_WRCMDBUF);
+  Eve_FlushFIFO(ctx);                                               // Commands staged ahead of this data must land in the FIFO first
+  Eve_FrameInvalidate(ctx);
+
+  StreamWords(ctx, buff, Whole);
+  if (count & 3)
+  {
+    memcpy(Tail, buff + Whole, count & 3);
+    StreamWords(ctx, Tail, 4);
+  }
+  if (ctx->FifoUnpublished)
+    PublishFIFO(ctx);
+  STAT_LEAVE(ctx);
+}
+
+// The same, with the data pulled from Producer as it is needed rather than sitting in one buffer - a file
+// on disk perhaps.  Producer is called until it returns 0, and may hand over any number of bytes each time.
+// The staging buffer (empty at this point) does duty as the bounce buffer, so no more host RAM is needed.
+// Returns the number of bytes streamed, before padding.
+uint32_t Eve_CoProStream(EveContext *ctx, EveProducer Producer, void *User)
+{
+  uint32_t Have = 0, Got, Whole, Total = 0;
+
+  STAT_ENTER(ctx, EVE_STAT_COPRO_WRCMDBUF);
+  Eve_FlushFIFO(ctx);
+  Eve_FrameInvalidate(ctx);
+
+  do
+  {
+    do                                                             // Fill the buffer - small pieces make for small bursts
+    {
+      Got = Producer(User, ctx->CmdStage + Have, EVE_CMD_STAGE_SIZE - Have);
+      Have += Got;
+      Total += Got;
+    } while (Got && Have < EVE_CMD_STAGE_SIZE);
+    if (!Got && (Have & 3))                                        // The end - pad out the last word
     {
-      TransferSize = Remaining;                            // Set size to this last dribble of data
-      TransferSize = (TransferSize + 3) & 0xFFC;           // 4 byte alignment
+      memset(ctx->CmdStage + Have, 0, 4 - (Have & 3));
+      Have = (Have + 3) & ~3UL;
     }
-    
-    StartCoProTransfer(FifoWriteLocation + RAM_CMD, false);// Base address of the Command Buffer plus our offset into it - Start SPI transaction
-    
-    HAL_SPI_WriteBuffer((uint8_t*)buff, TransferSize);         // write the little bit for which we found space
-    buff += TransferSize;                                  // move the working data read pointer to the next fresh data
 
-    FifoWriteLocation  = (FifoWriteLocation + TransferSize) % FT_CMD_FIFO_SIZE;  
-    HAL_SPI_Disable();                                         // End SPI transaction with the FIFO
-    
-    wr16(REG_CMD_WRITE + RAM_REG, FifoWriteLocation);      // Manually update the write position pointer to initiate processing of the FIFO
-    Remaining -= TransferSize;                             // reduce what we want by what we sent
-    
-  }while (Remaining > 0);                                  // keep going as long as we still want more
+    Whole = Have & ~3UL;
+    StreamWords(ctx, ctx->CmdStage, Whole);
+    Have -= Whole;
+    memmove(ctx->CmdStage, ctx->CmdStage + Whole, Have);             // Up to 3 bytes carried over to the next word
+  } while (Got);
+
+  if (ctx->FifoUnpublished)
+    PublishFIFO(ctx);
+  STAT_LEAVE(ctx);
+  return Total;
+}
+
+// *** Media FIFO - FT81x Series Programmers Guide Section 5.20 ***************************************************
+// A ring buffer in RAM_G that CMD_LOADIMAGE (with OPT_MEDIAFIFO) and CMD_PLAYVIDEO can take their data from
+// instead of the command FIFO.  It can be far bigger than the 4K command FIFO, and the CoPro stays free to
+// read it at its own pace.  The host writes at REG_MEDIAFIFO_WRITE and the CoPro reads at REG_MEDIAFIFO_READ,
+// both offsets into the ring.  The flow control is the same as for the command FIFO: MediaFifoSpace is
+// taken as data goes in and only refreshed from REG_MEDIAFIFO_READ when it runs short, and the write pointer
+// is only moved once a worthwhile amount is waiting.  The ring is never filled right up, as a full ring
+// would look just like an empty one.
+
+#define MEDIA_BURST(ctx) ((ctx)->MediaFifoSize / 4)
+
+static void PublishMedia(EveContext *ctx)
+{
+  Eve_wr32(ctx, REG_MEDIAFIFO_WRITE + RAM_REG, ctx->MediaFifoWrite);
+  ctx->MediaFifoUnpublished = 0;
+}
+
+// Wait for room for need bytes.  Returns false if the CoPro has faulted and will never make any.
+static bool WaitMedia(EveContext *ctx, uint32_t need)
+{
+  uint32_t Rd, Last = ctx->MediaFifoSize;
+
+  while (ctx->MediaFifoSpace < need)
+  {
+    if (ctx->MediaFifoUnpublished)
+      PublishMedia(ctx);
+    Rd = Eve_rd32(ctx, REG_MEDIAFIFO_READ + RAM_REG) % ctx->MediaFifoSize;
+    ctx->MediaFifoSpace = (ctx->MediaFifoSize - 4) - ((ctx->MediaFifoWrite + ctx->MediaFifoSize - Rd) % ctx->MediaFifoSize);
+    if (Rd == Last && ReadCoProPointer(ctx) == 0xFFF)             // No progress - see if there ever will be
+    {
+      CoProRecover(ctx);
+      return false;
+    }
+    Last = Rd;
+  }
+  return true;
+}
+
+// Put a media FIFO of Size bytes at Base in RAM_G, both multiples of 4.  Returns false for one that does not fit.
+bool Eve_MediaFifo_Init(EveContext *ctx, uint32_t Base, uint32_t Size)
+{
+  if ((Base & 3) || (Size & 3) || Size < 2 * FT_CMD_SIZE || Base + Size > RAM_G_WORKING)
+    return false;
+
+  Eve_Cmd_MediaFifo(ctx, Base, Size);                             // Puts REG_MEDIAFIFO_READ back to 0
+  Eve_UpdateFIFO(ctx);
+  Eve_Wait4CoProFIFOEmpty(ctx);
+  ctx->MediaFifoBase = Base;
+  ctx->MediaFifoSize = Size;
+  ctx->MediaFifoWrite = 0;
+  ctx->MediaFifoUnpublished = 0;
+  ctx->MediaFifoSpace = Size - 4;
+  Eve_wr32(ctx, REG_MEDIAFIFO_WRITE + RAM_REG, 0);
+  return true;
+}
+
+// Put count bytes into the media FIFO, in bursts as big as the free space allows (split in two where the
+// ring wraps), waiting for the CoPro where it is full.  REG_MEDIAFIFO_WRITE is left to the caller.
+static uint32_t MediaWrite(EveContext *ctx, const uint8_t *buff, uint32_t count)
+{
+  uint32_t Chunk, Done = 0;
+
+  while (count)
+  {
+    if (!WaitMedia(ctx, count < MEDIA_BURST(ctx) ? count : MEDIA_BURST(ctx)))
+      break;
+    Chunk = ctx->MediaFifoSpace;
+    if (Chunk > ctx->MediaFifoSize - ctx->MediaFifoWrite)         // Stop at the end of the ring, the rest goes to the start
+      Chunk = ctx->MediaFifoSize - ctx->MediaFifoWrite;
+    if (Chunk > EVE_SPI_MAX_CHUNK)
+      Chunk = EVE_SPI_MAX_CHUNK;
+    if (Chunk > count)
+      Chunk = count;
+
+    Eve_StartCoProTransfer(ctx, ctx->MediaFifoBase + ctx->MediaFifoWrite, false);
+    SPI_WriteBuffer(ctx, (uint8_t*)buff, Chunk);
+    SPI_Disable(ctx);
+    ctx->MediaFifoWrite = (ctx->MediaFifoWrite + Chunk) % ctx->MediaFifoSize;
+    ctx->MediaFifoSpace -= Chunk;
+    ctx->MediaFifoUnpublished += Chunk;
+    buff += Chunk;
+    count -= Chunk;
+    Done += Chunk;
+
+    if (ctx->MediaFifoUnpublished >= MEDIA_BURST(ctx))
+      PublishMedia(ctx);
+  }
+  return Done;
+}
+
+// Write count bytes into the media FIFO.  Returns the number of bytes written, which is less than count only
+// if there is no media FIFO or the CoPro faulted.
+uint32_t Eve_MediaFifo_Write(EveContext *ctx, const uint8_t *buff, uint32_t count)
+{
+  uint32_t Done;
+
+  if (!ctx->MediaFifoSize)
+    return 0;
+
+  STAT_ENTER(ctx, EVE_STAT_MEDIA_FIFO);
+  Eve_FrameInvalidate(ctx);
+  Done = MediaWrite(ctx, buff, count);
+  if (ctx->MediaFifoUnpublished)
+    PublishMedia(ctx);
+  STAT_LEAVE(ctx);
+  return Done;
+}
+
+// The same, with the data pulled from Producer until it returns 0 - see Eve_CoProStream().  The staging buffer
+// is the bounce buffer again, so anything staged is flushed to the CoPro first.
+uint32_t Eve_MediaFifo_Stream(EveContext *ctx, EveProducer Producer, void *User)
+{
+  uint32_t Have, Got, Total = 0;
+
+  if (!ctx->MediaFifoSize)
+    return 0;
+
+  Eve_UpdateFIFO(ctx);
+  STAT_ENTER(ctx, EVE_STAT_MEDIA_FIFO);
+  Eve_FrameInvalidate(ctx);
+  do
+  {
+    Have = 0;
+    do
+    {
+      Got = Producer(User, ctx->CmdStage + Have, EVE_CMD_STAGE_SIZE - Have);
+      Have += Got;
+    } while (Got && Have < EVE_CMD_STAGE_SIZE);
+    if (MediaWrite(ctx, ctx->CmdStage, Have) != Have)
+      break;
+    Total += Have;
+  } while (Got);
+  if (ctx->MediaFifoUnpublished)
+    PublishMedia(ctx);
+  STAT_LEAVE(ctx);
+  return Total;
+}
+
+// Decode the JPEG or PNG that Producer supplies into RAM_G at Dest, through the media FIFO.  The file can be
+// any size, the media FIFO just has to be set up with Eve_MediaFifo_Init() first.  OPT_MEDIAFIFO is added to
+// Options.  Returns the number of bytes of file sent, 0 if there is no media FIFO.
+// The CoPro is done with the command once it has seen the end of the image, so it has to be a whole one.
+uint32_t Eve_MediaFifo_LoadImage(EveContext *ctx, uint32_t Dest, uint32_t Options, EveProducer Producer, void *User)
+{
+  uint32_t Total;
+
+  if (!ctx->MediaFifoSize)
+    return 0;
+  Eve_Cmd_LoadImage(ctx, Dest, Options | OPT_MEDIAFIFO);
+  Total = Eve_MediaFifo_Stream(ctx, Producer, User);
+  Eve_Wait4CoProFIFOEmpty(ctx);
+  return Total;
+}
+
+// *** Video playback - FT81x Series Programmers Guide Sections 5.22 and 5.23 *************************************
+// An AVI (motion JPEG) played a frame at a time from the media FIFO, alongside whatever else is on screen:
+//
+//   Eve_MediaFifo_Init(ctx, ...);
+//   Eve_VideoStart(ctx, &Video, Dest, DonePtr, Period, Producer, User);
+//   while (Eve_VideoPoll(ctx, &Video))
+//   {
+//     ... draw frames as usual, with a bitmap at Dest, handle touch ...
+//   }
+//
+// Eve_VideoPoll() never waits.  It tops up the media FIFO with whatever room there is, notices when the last
+// CMD_VIDEOFRAME has been decoded, and sends the next one once Period display frames (REG_FRAMES) have gone by
+// since the last was due.  Every Period missed - the last frame was still being decoded, or the poll came too
+// late - is counted in Dropped, and the video runs that much behind.  A media FIFO found empty while the
+// decoder waits is counted in Underruns.  Call it between frames - it flushes the staged commands - and at least once per Period.
+// To loop, start the video again when Eve_VideoPoll() returns 0 with the producer back at the start.
+
+// Top up the media FIFO.  REG_MEDIAFIFO_READ is read at most once, and only when the room last seen is used up.
+static void VideoFill(EveContext *ctx, EveVideo *Video)
+{
+  uint32_t Rd, Got;
+  bool Looked = false;
+
+  while (!Video->InputDone)
+  {
+    if (ctx->MediaFifoSpace < sizeof(Video->Buffer))
+    {
+      if (Looked)
+        break;
+      if (ctx->MediaFifoUnpublished)
+        PublishMedia(ctx);
+      Rd = Eve_rd32(ctx, REG_MEDIAFIFO_READ + RAM_REG) % ctx->MediaFifoSize;
+      if (Rd == ctx->MediaFifoWrite && Video->Decoding)
+        Video->Stats.Underruns++;                                   // The decoder has had everything and wants more
+      ctx->MediaFifoSpace = (ctx->MediaFifoSize - 4) - ((ctx->MediaFifoWrite + ctx->MediaFifoSize - Rd) % ctx->MediaFifoSize);
+      Looked = true;
+      continue;
+    }
+    Got = Video->Producer(Video->User, Video->Buffer, sizeof(Video->Buffer));
+    if (!Got)
+    {
+      Video->InputDone = true;
+      break;
+    }
+    MediaWrite(ctx, Video->Buffer, Got);                            // There is room, so this does not wait
+    Video->Stats.Bytes += Got;
+  }
+  if (ctx->MediaFifoUnpublished)
+    PublishMedia(ctx);
+}
+
+// Start playing the AVI that Producer supplies, decoding each frame into RAM_G at Dest (RGB565, the size of
+// the video) with DonePtr as CMD_VIDEOFRAME's completion word.  Period is the number of display frames to show
+// each video frame for.  The media FIFO must have been set up - whatever is left in it is thrown away.
+// Returns false if there is no media FIFO.
+bool Eve_VideoStart(EveContext *ctx, EveVideo *Video, uint32_t Dest, uint32_t DonePtr, uint32_t Period, EveProducer Producer, void *User)
+{
+  if (!ctx->MediaFifoSize || !Period)
+    return false;
+
+  memset(Video, 0, sizeof(EveVideo));
+  Video->Producer = Producer;
+  Video->User = User;
+  Video->Dest = Dest;
+  Video->DonePtr = DonePtr;
+  Video->Period = Period;
+  Video->Playing = true;
+
+  Eve_MediaFifo_Init(ctx, ctx->MediaFifoBase, ctx->MediaFifoSize);
+  STAT_ENTER(ctx, EVE_STAT_VIDEO);
+  Eve_Cmd_VideoStart(ctx);
+  Eve_UpdateFIFO(ctx);
+  VideoFill(ctx, Video);
+  Video->NextDue = Eve_rd32(ctx, REG_FRAMES + RAM_REG);              // The first frame is due right away
+  STAT_LEAVE(ctx);
+  return true;
+}
+
+// Keep the video going.  Returns 1 while it plays and 0 once the last frame has been decoded (or the CoPro
+// faulted).
+uint8_t Eve_VideoPoll(EveContext *ctx, EveVideo *Video)
+{
+  uint32_t Now, Late;
+  uint16_t Rd;
+
+  if (!Video->Playing)
+    return 0;
+
+  STAT_ENTER(ctx, EVE_STAT_VIDEO);
+  VideoFill(ctx, Video);
+
+  if (Video->Decoding)
+  {
+    Rd = ReadCoProPointer(ctx);
+    if (Rd == 0xFFF)
+    {
+      CoProRecover(ctx);
+      Video->Playing = false;
+    }
+    else if ((int32_t)(FifoConsumed(ctx, Rd) - Video->FrameEnd) >= 0)
+    {
+      Video->Decoding = false;
+      Video->Stats.Frames++;
+      Eve_FrameInvalidate(ctx);                                     // The same commands draw something new now
+      if (!Eve_rd32(ctx, Video->DonePtr))
+        Video->Playing = false;
+    }
+  }
+
+  if (Video->Playing && !Video->Decoding)
+  {
+    Now = Eve_rd32(ctx, REG_FRAMES + RAM_REG);
+    if ((int32_t)(Now - Video->NextDue) >= 0)
+    {
+      Late = (Now - Video->NextDue) / Video->Period;                 // Whole periods gone by with nothing new shown
+      Video->Stats.Dropped += Late;
+      Video->NextDue += (Late + 1) * Video->Period;
+      Eve_Cmd_VideoFrame(ctx, Video->Dest, Video->DonePtr);
+      Eve_UpdateFIFO(ctx);
+      Video->FrameEnd = ctx->FifoTotal;
+      Video->Decoding = true;
+    }
+  }
+  STAT_LEAVE(ctx);
+  return Video->Playing;
 }
 
-// Write a block of data into Eve RAM space a byte at a time.
+// Write a block of data into Eve RAM space in bursts of up to EVE_SPI_MAX_CHUNK bytes.
+// Eve auto increments the address during a transfer, so each burst only costs one address header.
 // Return the last written address + 1 (The next available RAM address)
-uint32_t WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count)
+uint32_t Eve_WriteBlockRAM(EveContext *ctx, uint32_t Add, const uint8_t *buff, uint32_t count)
 {
-  uint32_t index;
+  uint32_t Chunk;
   uint32_t WriteAddress = Add;  // I want to return the value instead of modifying the variable in place
   
-  for (index = 0; index < count; index++)
+  STAT_ENTER(ctx, EVE_STAT_BLOCK_WRITE);
+  Eve_FrameInvalidate(ctx);                                    // Whatever the last frame drew from here may be different now
+  while (count)
   {
-    wr8(WriteAddress++, buff[index]);
+    Chunk = (count > EVE_SPI_MAX_CHUNK) ? EVE_SPI_MAX_CHUNK : count;
+
+    Eve_StartCoProTransfer(ctx, WriteAddress, false);
+    SPI_WriteBuffer(ctx, (uint8_t*)buff, Chunk);
+    SPI_Disable(ctx);
+
+    buff += Chunk;
+    WriteAddress += Chunk;
+    count -= Chunk;
   }
+  STAT_LEAVE(ctx);
   return (WriteAddress);
 }
 
+// Read a block of Eve RAM space into the callers buffer in bursts of up to EVE_SPI_MAX_CHUNK bytes.
+// Like rd32(), the dummy byte that follows the address is left to HAL_SPI_ReadBuffer().
+// Return the last read address + 1 (The next unread RAM address)
+uint32_t Eve_ReadBlockRAM(EveContext *ctx, uint32_t Add, uint8_t *buff, uint32_t count)
+{
+  uint32_t Chunk;
+  uint32_t ReadAddress = Add;
+
+  STAT_ENTER(ctx, EVE_STAT_BLOCK_READ);
+  while (count)
+  {
+    Chunk = (count > EVE_SPI_MAX_CHUNK) ? EVE_SPI_MAX_CHUNK : count;
+
+    SPI_Enable(ctx);
+    SPI_Write(ctx, (ReadAddress >> 16) & 0x3F);
+    SPI_Write(ctx, (ReadAddress >> 8) & 0xff);
+    SPI_Write(ctx, ReadAddress & 0xff);
+    SPI_ReadBuffer(ctx, buff, Chunk);
+    SPI_Disable(ctx);
+
+    buff += Chunk;
+    ReadAddress += Chunk;
+    count -= Chunk;
+  }
+  STAT_LEAVE(ctx);
+  return (ReadAddress);
+}
+
 // CalcCoef - Support function for manual screen calibration function
 int32_t CalcCoef(int32_t Q, int32_t K)
 {
@@ -1139,13 +2197,15 @@ int32_t CalcCoef(int32_t Q, int32_t K)
   return (returnValue);
 }
 
-bool FlashAttach(void)
+bool Eve_FlashAttach(EveContext *ctx)
 {
-	Send_CMD(CMD_FLASHATTACH);
-	UpdateFIFO();                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
-	Wait4CoProFIFOEmpty();                                              // wait here until the coprocessor has read and executed every pending command.
+	STAT_ENTER(ctx, EVE_STAT_FLASH);
+	Eve_Send_CMD(ctx, CMD_FLASHATTACH);
+	Eve_UpdateFIFO(ctx);                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
+	Eve_Wait4CoProFIFOEmpty(ctx);                                              // wait here until the coprocessor has read and executed every pending command.
 
-	uint8_t FlashStatus = rd8(REG_FLASH_STATUS + RAM_REG);
+	uint8_t FlashStatus = Eve_rd8(ctx, REG_FLASH_STATUS + RAM_REG);
+	STAT_LEAVE(ctx);
 	if (FlashStatus != FLASH_STATUS_BASIC)
 	{
 		return false;
@@ -1153,13 +2213,16 @@ bool FlashAttach(void)
 	return true;
 }
 
-bool FlashDetach(void)
+bool Eve_FlashDetach(EveContext *ctx)
 {
-	Send_CMD(CMD_FLASHDETACH);
-	UpdateFIFO();                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
-	Wait4CoProFIFOEmpty();                                              // wait here until the coprocessor has read and executed every pending command.
-
-	uint8_t FlashStatus = rd8(REG_FLASH_STATUS + RAM_REG);
+	STAT_ENTER(ctx, EVE_STAT_FLASH);
+	Eve_Send_CMD(ctx, CMD_FLASHDETACH);
+	Eve_UpdateFIFO(ctx);                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
+	Eve_Wait4CoProFIFOEmpty(ctx);                                              // wait here until the coprocessor has read and executed every pending command.
+	ctx->FlashAssetCount = 0;                                                  // Whatever is attached next may hold another image
+
+	uint8_t FlashStatus = Eve_rd8(ctx, REG_FLASH_STATUS + RAM_REG);
+	STAT_LEAVE(ctx);
 	if (FlashStatus != FLASH_STATUS_DETACHED)
 	{
 		return false;
@@ -1167,13 +2230,15 @@ bool FlashDetach(void)
 	return true;
 }
 
-bool FlashFast(void)
+bool Eve_FlashFast(EveContext *ctx)
 {
-	Cmd_Flash_Fast();
-	UpdateFIFO();                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
-	Wait4CoProFIFOEmpty();                                              // wait here until the coprocessor has read and executed every pending command.
+	STAT_ENTER(ctx, EVE_STAT_FLASH);
+	Eve_Cmd_Flash_Fast(ctx);
+	Eve_UpdateFIFO(ctx);                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
+	Eve_Wait4CoProFIFOEmpty(ctx);                                              // wait here until the coprocessor has read and executed every pending command.
 
-	uint8_t FlashStatus = rd8(REG_FLASH_STATUS + RAM_REG);
+	uint8_t FlashStatus = Eve_rd8(ctx, REG_FLASH_STATUS + RAM_REG);
+	STAT_LEAVE(ctx);
 	if (FlashStatus != FLASH_STATUS_FULL)
 	{
 		return false;
@@ -1181,14 +2246,957 @@ bool FlashFast(void)
 	return true;
 }
 
-bool FlashErase(void)
+bool Eve_FlashErase(EveContext *ctx)
+{
+	STAT_ENTER(ctx, EVE_STAT_FLASH);
+	Eve_Send_CMD(ctx, CMD_FLASHERASE);
+	Eve_UpdateFIFO(ctx);                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
+	Eve_Wait4CoProFIFOEmpty(ctx);                                              // wait here until the coprocessor has read and executed every pending command.
+	ctx->FlashAssetCount = 0;                                                  // The index went with everything else
+	STAT_LEAVE(ctx);
+	return true;
+}
+
+static uint32_t Le32(const uint8_t *p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t Le16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+// Read the index of a flash image built by eve_flashimg (see FLASH_INDEX_ADDR) into the context, so that
+// Eve_FlashAsset() finds assets without going back to the flash.  Call it once the flash is in full speed mode
+// (Eve_FlashFast()), and again after writing a new image.  The index is copied into RAM_G_WORKING - the 4K
+// there is overwritten - and checked by the CoPro (CMD_MEMCRC), so only the header and the entries kept come
+// back over SPI.  Returns false, with no assets, if the flash does not hold a valid index.  IDs from
+// EVE_FLASH_ASSETS up are left out.
+bool Eve_FlashIndexLoad(EveContext *ctx)
 {
-	Send_CMD(CMD_FLASHERASE);
-	UpdateFIFO();                                                       // Trigger the CoProcessor to start processing commands out of the FIFO
-	Wait4CoProFIFOEmpty();                                              // wait here until the coprocessor has read and executed every pending command.
+	uint8_t Buffer[16 * FLASH_INDEX_ENTRY_SIZE], *e;
+	uint32_t Count, Crc, Done, n, i;
+	EveFlashAsset *Asset;
+
+	ctx->FlashAssetCount = 0;
+	STAT_ENTER(ctx, EVE_STAT_FLASH);
+	Eve_Cmd_FlashRead(ctx, RAM_G_WORKING, FLASH_INDEX_ADDR, 4096);
+	Eve_UpdateFIFO(ctx);
+	Eve_Wait4CoProFIFOEmpty(ctx);
+	Eve_ReadBlockRAM(ctx, RAM_G_WORKING, Buffer, FLASH_INDEX_HEADER_SIZE);
+	Count = Le16(Buffer + 6);
+	Crc = Le32(Buffer + 8);
+	if (Le32(Buffer) != FLASH_INDEX_MAGIC || Le16(Buffer + 4) != FLASH_INDEX_VERSION || Count > FLASH_INDEX_MAX ||
+	    Eve_Cmd_MemCrc(ctx, RAM_G_WORKING + FLASH_INDEX_HEADER_SIZE, Count * FLASH_INDEX_ENTRY_SIZE) != Crc)
+	{
+		STAT_LEAVE(ctx);
+		return false;
+	}
+
+	if (Count > EVE_FLASH_ASSETS)
+		Count = EVE_FLASH_ASSETS;
+	for (Done = 0; Done < Count; Done += n)
+	{
+		n = Count - Done < 16 ? Count - Done : 16;
+		Eve_ReadBlockRAM(ctx, RAM_G_WORKING + FLASH_INDEX_HEADER_SIZE + Done * FLASH_INDEX_ENTRY_SIZE, Buffer, n * FLASH_INDEX_ENTRY_SIZE);
+		for (i = 0; i < n; i++)
+		{
+			e = Buffer + i * FLASH_INDEX_ENTRY_SIZE;
+			Asset = &ctx->FlashAssets[Done + i];
+			Asset->Addr = Le32(e);
+			Asset->Size = (Asset->Addr & (FLASH_ASSET_ALIGN - 1)) ? 0 : Le32(e + 4);
+			Asset->Type = Le16(e + 8);
+			Asset->Format = Le16(e + 10);
+			Asset->Width = Le16(e + 12);
+			Asset->Height = Le16(e + 14);
+		}
+	}
+	ctx->FlashAssetCount = (uint16_t)Count;
+	STAT_LEAVE(ctx);
 	return true;
 }
 
+// The asset with ID Id in the flash image, or NULL if the index has none
+const EveFlashAsset *Eve_FlashAsset(EveContext *ctx, uint16_t Id)
+{
+	if (Id >= ctx->FlashAssetCount || !ctx->FlashAssets[Id].Size)
+		return NULL;
+	return &ctx->FlashAssets[Id];
+}
+
+// ***************************************************************************************************************
+// *** Touch events **********************************************************************************************
+// ***************************************************************************************************************
+// Reading REG_TOUCH_TAG in a loop keeps the bus busy whether or not anyone is touching the screen.  Instead:
+//
+//   Eve_TouchStart();
+//   while (1)
+//   {
+//     Eve_TouchService(100);          // from the main loop, or a thread of its own
+//     while (Eve_TouchGet(&Event))
+//       ... EVE_TOUCH_PRESS, EVE_TOUCH_DRAG, EVE_TOUCH_RELEASE ...
+//   }
+//
+// With a Wait_IRQ in the HAL, Eve raises INT on a touch or a tag change and nothing crosses SPI until it does.
+// While a touch is down the registers are also read every EVE_TOUCH_POLL_MS, as a drag or a release off a
+// tagged item raises no interrupt.  Without Wait_IRQ they are read every EVE_TOUCH_POLL_MS throughout.
+//
+// Eve_TouchService() and Eve_TouchGet() can run in different threads - or the first in an interrupt handler - as
+// long as there is only one of each.
+
+#if defined(__GNUC__)
+#  define TOUCH_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define TOUCH_BARRIER() _ReadWriteBarrier()
+#else
+#  define TOUCH_BARRIER()                                                  // Single core - volatile is enough
+#endif
+
+#define TOUCH_NONE  0x80008000UL                                         // REG_TOUCH_SCREEN_XY with nothing touching
+
+// Enable the touch interrupts and start with an empty queue
+void Eve_TouchStart(EveContext *ctx)
+{
+  STAT_ENTER(ctx, EVE_STAT_TOUCH);
+  ctx->TouchHead = ctx->TouchTail = 0;
+  ctx->TouchDown = false;
+  ctx->TouchLast = Micros(ctx) - EVE_TOUCH_POLL_MS * 1000;
+  Eve_wr8(ctx, REG_INT_MASK + RAM_REG, INT_TOUCH | INT_TAG);
+  Eve_wr8(ctx, REG_INT_EN + RAM_REG, 1);
+  Eve_rd8(ctx, REG_INT_FLAGS + RAM_REG);                                 // Clear anything stale
+  STAT_LEAVE(ctx);
+}
+
+void Eve_TouchStop(EveContext *ctx)
+{
+  STAT_ENTER(ctx, EVE_STAT_TOUCH);
+  Eve_wr8(ctx, REG_INT_EN + RAM_REG, 0);
+  Eve_wr8(ctx, REG_INT_MASK + RAM_REG, 0);
+  STAT_LEAVE(ctx);
+}
+
+static uint8_t TouchPush(EveContext *ctx, uint8_t Type)
+{
+  uint8_t Tail = ctx->TouchTail, Next = (Tail + 1) & (EVE_TOUCH_QUEUE - 1);
+
+  if (Next == ctx->TouchHead)
+  {
+    ctx->TouchDropped++;
+    return 0;
+  }
+  ctx->TouchQueue[Tail].Type = Type;
+  ctx->TouchQueue[Tail].Tag = ctx->TouchTag;
+  ctx->TouchQueue[Tail].X = ctx->TouchX;
+  ctx->TouchQueue[Tail].Y = ctx->TouchY;
+  TOUCH_BARRIER();                                                        // The event is there before the index says so
+  ctx->TouchTail = Next;
+  return 1;
+}
+
+// Read where the screen is touched and queue what changed since last time
+static uint8_t TouchSample(EveContext *ctx)
+{
+  uint8_t Regs[12];                                                        // REG_TOUCH_SCREEN_XY, REG_TOUCH_TAG_XY, REG_TOUCH_TAG
+  uint32_t XY;
+  int16_t X, Y;
+
+  Eve_ReadBlockRAM(ctx, REG_TOUCH_SCREEN_XY + RAM_REG, Regs, sizeof(Regs));
+  XY = Regs[0] | ((uint32_t)Regs[1] << 8) | ((uint32_t)Regs[2] << 16) | ((uint32_t)Regs[3] << 24);
+  X = (int16_t)(XY >> 16);
+  Y = (int16_t)XY;
+
+  if (XY == TOUCH_NONE)
+  {
+    if (!ctx->TouchDown)
+      return 0;
+    ctx->TouchDown = false;
+    return TouchPush(ctx, EVE_TOUCH_RELEASE);
+  }
+  if (!ctx->TouchDown)
+  {
+    ctx->TouchDown = true;
+    ctx->TouchTag = Regs[8];
+    ctx->TouchX = X;
+    ctx->TouchY = Y;
+    return TouchPush(ctx, EVE_TOUCH_PRESS);
+  }
+  if (X == ctx->TouchX && Y == ctx->TouchY)
+    return 0;
+  ctx->TouchX = X;
+  ctx->TouchY = Y;
+  return TouchPush(ctx, EVE_TOUCH_DRAG);
+}
+
+// Milliseconds until the registers are due to be read again, 0 if they are now.  With a touch down, or no
+// interrupt to wait on, that is EVE_TOUCH_POLL_MS after the last time - or straight away on First when there is
+// no clock to tell.
+static uint32_t TouchPollDue(EveContext *ctx, bool First)
+{
+  uint32_t Since;
+
+  if (ctx->Hal.Wait_IRQ && !ctx->TouchDown)
+    return 0xFFFFFFFF;                                                   // INT says when
+  if (!ctx->Hal.Micros)
+    return First ? 0 : EVE_TOUCH_POLL_MS;
+  Since = (Micros(ctx) - ctx->TouchLast) / 1000;
+  return Since < EVE_TOUCH_POLL_MS ? EVE_TOUCH_POLL_MS - Since : 0;
+}
+
+// Wait up to TimeoutMs for the touch screen to do something and queue the events.  Returns the number queued,
+// 0 once TimeoutMs is up with nothing to report.  A TimeoutMs of 0 never blocks - call it that way from a loop
+// that has other work to do.  Without Hal.Micros or Hal.Wait_IRQ such a call always reads the registers, as
+// there is nothing to say EVE_TOUCH_POLL_MS has not gone by, so the caller has to set the pace.  Nor is there
+// anything to say how much of a wait an interrupt cut short, so each one is counted as a millisecond and the
+// whole call can take longer than TimeoutMs.
+uint8_t Eve_TouchService(EveContext *ctx, uint32_t TimeoutMs)
+{
+  uint32_t Left = TimeoutMs, Due, Wait, Start, Spent;
+  bool First = true, Irq;
+  uint8_t Queued = 0;
+
+  STAT_ENTER(ctx, EVE_STAT_TOUCH);
+  while (!Queued)
+  {
+    Due = TouchPollDue(ctx, First);
+    Wait = Due < Left ? Due : Left;
+    Irq = false;
+    Start = Micros(ctx);
+    if (ctx->Hal.Wait_IRQ)
+      Irq = ctx->Hal.Wait_IRQ(ctx->Hal.User, Wait);                     // Returns early if INT goes active
+    else if (Wait)
+      Delay(ctx, Wait);
+    if (!Irq && Wait < Due)
+      break;                                                             // Out of time before the next read
+    Spent = Wait;
+    if (Irq)                                                             // Only as long as it actually took
+      Spent = ctx->Hal.Micros ? (Micros(ctx) - Start) / 1000 : 1;
+    Left -= Spent < Left ? Spent : Left;
+    if (Irq)
+      Eve_rd8(ctx, REG_INT_FLAGS + RAM_REG);                             // Release INT - the registers say the rest
+    ctx->TouchLast = Micros(ctx);
+    Queued = TouchSample(ctx);
+    First = false;
+  }
+  STAT_LEAVE(ctx);
+  return Queued;
+}
+
+// Take the oldest event off the queue.  Returns false when it is empty.
+bool Eve_TouchGet(EveContext *ctx, EveTouchEvent *Event)
+{
+  uint8_t Head = ctx->TouchHead;
+
+  if (Head == ctx->TouchTail)
+    return false;
+  TOUCH_BARRIER();                                                        // Read the event after the index
+  *Event = ctx->TouchQueue[Head];
+  TOUCH_BARRIER();                                                        // and finish with the slot before handing it back
+  ctx->TouchHead = (Head + 1) & (EVE_TOUCH_QUEUE - 1);
+  return true;
+}
+
+// *** Touch snapshots *******************************************************************************************
+// The five capacitive touch points, their tags and the trackers are spread over a dozen registers.  They all sit
+// in REG_CTOUCH_TOUCH1_XY .. REG_CTOUCH_TOUCH3_XY, so one burst reads the lot, and the trackers take one more.
+
+#define SNAPSHOT_FIRST   REG_CTOUCH_TOUCH1_XY
+#define SNAPSHOT_SIZE    (REG_CTOUCH_TOUCH3_XY + 4 - SNAPSHOT_FIRST)
+
+// Cap Eve_TouchSnapshot() at MaxHz reads a second (0 for none) - more often and it hands back the last one.
+// The cap needs the HAL's Micros.  Trackers adds REG_TRACKER .. REG_TRACKER_4 to each read, for CMD_TRACK.
+void Eve_TouchSnapshotConfig(EveContext *ctx, uint16_t MaxHz, bool Trackers)
+{
+  ctx->SnapshotPeriod = MaxHz ? 1000000UL / MaxHz : 0;
+  ctx->SnapshotTrackers = Trackers;
+  ctx->SnapshotValid = false;
+}
+
+static uint32_t Snap32(const uint8_t *Regs, uint32_t Reg)
+{
+  const uint8_t *p = Regs + Reg - SNAPSHOT_FIRST;
+
+  return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void SnapPoint(EveTouchSnapshot *Snapshot, uint8_t n, uint32_t XY, uint8_t Tag)
+{
+  Snapshot->X[n] = (int16_t)(XY >> 16);
+  Snapshot->Y[n] = (int16_t)XY;
+  Snapshot->Tag[n] = Tag;
+  if (Snapshot->X[n] != EVE_TOUCH_NONE)
+    Snapshot->Touched |= 1 << n;
+}
+
+// Every touch point, tag and (see Eve_TouchSnapshotConfig()) tracker in two SPI transactions at most.  Points
+// 1 - 4 are only there on a capacitive panel in extended mode (REG_CTOUCH_EXTEND 0) - otherwise they read
+// as not touched.  Returns false if the rate cap handed back the last snapshot instead of reading a new one.
+bool Eve_TouchSnapshot(EveContext *ctx, EveTouchSnapshot *Snapshot)
+{
+  uint8_t Regs[SNAPSHOT_SIZE], Trackers[4 * EVE_TOUCH_POINTS];
+  EveTouchSnapshot *Snap = &ctx->Snapshot;
+  uint32_t Now = Micros(ctx), Tracker;
+  uint8_t n;
+
+  if (ctx->SnapshotValid && ctx->SnapshotPeriod && ctx->Hal.Micros && Now - ctx->SnapshotLast < ctx->SnapshotPeriod)
+  {
+    *Snapshot = *Snap;
+    return false;
+  }
+
+  STAT_ENTER(ctx, EVE_STAT_TOUCH);
+  Eve_ReadBlockRAM(ctx, SNAPSHOT_FIRST + RAM_REG, Regs, sizeof(Regs));
+  if (ctx->SnapshotTrackers)
+    Eve_ReadBlockRAM(ctx, REG_TRACKER + RAM_REG, Trackers, sizeof(Trackers));
+  STAT_LEAVE(ctx);
+
+  memset(Snap, 0, sizeof(EveTouchSnapshot));
+  SnapPoint(Snap, 0, Snap32(Regs, REG_CTOUCH_TOUCH_XY), Regs[REG_CTOUCH_TAG - SNAPSHOT_FIRST]);
+  for (n = 1; n < EVE_TOUCH_POINTS; n++)
+    SnapPoint(Snap, n, TOUCH_NONE, 0);
+  if (ctx->Touch == TOUCH_TPC)                                             // On a resistive panel these are other things
+  {
+    SnapPoint(Snap, 1, Snap32(Regs, REG_CTOUCH_TOUCH1_XY), Regs[REG_CTOUCH_TAG1 - SNAPSHOT_FIRST]);
+    SnapPoint(Snap, 2, Snap32(Regs, REG_CTOUCH_TOUCH2_XY), Regs[REG_CTOUCH_TAG2 - SNAPSHOT_FIRST]);
+    SnapPoint(Snap, 3, Snap32(Regs, REG_CTOUCH_TOUCH3_XY), Regs[REG_CTOUCH_TAG3 - SNAPSHOT_FIRST]);
+    SnapPoint(Snap, 4, (Snap32(Regs, REG_CTOUCH_TOUCH4_X) << 16) | (Snap32(Regs, REG_CTOUCH_TOUCH4_Y) & 0xFFFF),
+              Regs[REG_CTOUCH_TAG4 - SNAPSHOT_FIRST]);
+  }
+  if (ctx->SnapshotTrackers)
+    for (n = 0; n < EVE_TOUCH_POINTS; n++)
+    {
+      Tracker = Trackers[4 * n] | ((uint32_t)Trackers[4 * n + 1] << 8) | ((uint32_t)Trackers[4 * n + 2] << 16) | ((uint32_t)Trackers[4 * n + 3] << 24);
+      Snap->TrackerTag[n] = (uint8_t)Tracker;
+      Snap->TrackerValue[n] = (uint16_t)(Tracker >> 16);
+    }
+
+  ctx->SnapshotValid = true;
+  ctx->SnapshotLast = Now;
+  *Snapshot = *Snap;
+  return true;
+}
+
+// ***************************************************************************************************************
+// *** Frame pipeline ********************************************************************************************
+// ***************************************************************************************************************
+// Wait4CoProFIFOEmpty() holds the host until the CoPro has finished a frame.  With these the host hands a frame
+// over and carries on - building the next one, polling touch, whatever - while the CoPro renders:
+//
+//   Eve_FrameBegin();
+//   ... Cmd_*() and Send_CMD() ...
+//   Eve_FrameSubmit();
+//   ... 
+//   Eve_FramePoll();                // now and then - runs the callback for every frame the CoPro got through
+//
+// Submitting only blocks when the FIFO is full or EVE_FRAME_QUEUE frames are still in flight.  "Done" means
+// the CoPro has executed the frame's CMD_SWAP - the new display list is then shown from the next vertical blank.
+
+// Register a function to be told about finished frames.  Completed is false when the CoPro faulted and the
+// frame was thrown away.
+void Eve_SetFrameCallback(EveContext *ctx, EveFrameCallback Callback, void *User)
+{
+  ctx->FrameDone = Callback;
+  ctx->FrameDoneUser = User;
+}
+
+// Start building a frame (CMD_DLSTART) and return its number
+uint32_t Eve_FrameBegin(EveContext *ctx)
+{
+  while (ctx->InFlightCount == EVE_FRAME_QUEUE)
+    Eve_FramePoll(ctx);                                      // Wait for a slot
+
+  Eve_Send_CMD(ctx, CMD_DLSTART);
+  return ++ctx->FrameNumber;
+}
+
+// Finish the frame (DISPLAY, CMD_SWAP), give it to the CoPro and return without waiting for it
+uint32_t Eve_FrameSubmit(EveContext *ctx)
+{
+  uint8_t Slot;
+
+  Eve_Send_CMD(ctx, DISPLAY());
+  Eve_Send_CMD(ctx, CMD_SWAP);
+  Eve_UpdateFIFO(ctx);
+
+  Slot = (ctx->InFlightFirst + ctx->InFlightCount) % EVE_FRAME_QUEUE;
+  ctx->InFlight[Slot].Frame = ctx->FrameNumber;
+  ctx->InFlight[Slot].End = ctx->FifoTotal;                         // A skipped frame ends with the one before it
+  ctx->InFlightCount++;
+  return ctx->FrameNumber;
+}
+
+// See how far the CoPro has got - one register read - and report the frames it has finished.
+// Returns the number of frames still in flight, so while (Eve_FramePoll()); waits for them all.
+uint8_t Eve_FramePoll(EveContext *ctx)
+{
+  uint32_t Consumed;
+  uint16_t Rd;
+
+  if (!ctx->InFlightCount)
+    return 0;
+
+  STAT_ENTER(ctx, EVE_STAT_FRAME_POLL);
+  Rd = ReadCoProPointer(ctx);
+  if (Rd == 0xFFF)
+  {
+    CoProRecover(ctx);                                       // Fails every frame in flight
+    STAT_LEAVE(ctx);
+    return 0;
+  }
+
+  Consumed = FifoConsumed(ctx, Rd);
+  while (ctx->InFlightCount && (int32_t)(Consumed - ctx->InFlight[ctx->InFlightFirst].End) >= 0)
+  {
+    uint32_t Frame = ctx->InFlight[ctx->InFlightFirst].Frame;
+
+    ctx->InFlightFirst = (ctx->InFlightFirst + 1) % EVE_FRAME_QUEUE;
+    ctx->InFlightCount--;
+    if (ctx->FrameDone)
+      ctx->FrameDone(Frame, true, ctx->FrameDoneUser);
+  }
+  STAT_LEAVE(ctx);
+  return ctx->InFlightCount;
+}
+
+// ***************************************************************************************************************
+// *** Frame skipping ********************************************************************************************
+// ***************************************************************************************************************
+
+// Forget the last frame so the next one is sent even if it is identical.  Call this after changing anything
+// a frame draws from behind the library's back - wr32() into RAM_G or RAM_DL, REG_DLSWAP and the like.
+void Eve_FrameInvalidate(EveContext *ctx)
+{
+#if !defined(EVE_NO_FRAME_SKIP)
+  ctx->LastValid = false;
+  ctx->FrameOpen = false;
+#endif
+}
+
+// Frames sent, frames dropped as repeats and frames that could not be checked (too big or volatile).
+// All zero when built with EVE_NO_FRAME_SKIP.
+void Eve_FrameStatsSnapshot(EveContext *ctx, EveFrameStats *Snapshot)
+{
+#if !defined(EVE_NO_FRAME_SKIP)
+  *Snapshot = ctx->FrameStats;
+#else
+  memset(Snapshot, 0, sizeof(EveFrameStats));
+#endif
+}
+
+void Eve_FrameStatsReset(EveContext *ctx)
+{
+#if !defined(EVE_NO_FRAME_SKIP)
+  memset(&ctx->FrameStats, 0, sizeof(ctx->FrameStats));
+#endif
+}
+
+// ***************************************************************************************************************
+// *** Bus instrumentation ***************************************************************************************
+// ***************************************************************************************************************
+
+// Copy out the per entry point counters - Stats must have room for EVE_STAT_COUNT entries.
+// Without EVE_INSTRUMENT there is nothing to count and the snapshot is all zero.
+void Eve_StatsSnapshot(EveContext *ctx, EveStatEntry *Snapshot)
+{
+#if defined(EVE_INSTRUMENT)
+  memcpy(Snapshot, ctx->Stats, sizeof(ctx->Stats));
+#else
+  (void)ctx;
+  memset(Snapshot, 0, sizeof(EveStatEntry) * EVE_STAT_COUNT);
+#endif
+}
+
+void Eve_StatsReset(EveContext *ctx)
+{
+#if defined(EVE_INSTRUMENT)
+  memset(ctx->Stats, 0, sizeof(ctx->Stats));
+#else
+  (void)ctx;
+#endif
+}
+
+const char *Eve_StatName(uint8_t Id)
+{
+  static const char *Names[EVE_STAT_COUNT] = 
+  {
+    "register", "FT81x_Init", "Send_CMD", "UpdateFIFO", "Cmd_Text", "Cmd_Button", "CoProWrCmdBuf", 
+    "Wait4CoProFIFO", "Wait4CoProFIFOEmpty", "WriteBlockRAM", "ReadBlockRAM", "Calibrate_Manual", "Flash",
+    "Eve_FramePoll", "MediaFifo",
+    "Eve_VideoPoll", "Touch"
+  };
+  return (Id < EVE_STAT_COUNT) ? Names[Id] : "?";
+}
+
+// Log the non empty counters as a table
+void Eve_StatsPrint(EveContext *ctx)
+{
+  EveStatEntry Snapshot[EVE_STAT_COUNT];
+  EveFrameStats Frames;
+  uint8_t Id;
+
+  Eve_StatsSnapshot(ctx, Snapshot);
+  Log("%-20s %8s %8s %10s %10s %10s\n", "entry", "calls", "cs", "written", "read", "us");
+  for (Id = 0; Id < EVE_STAT_COUNT; Id++)
+  {
+    if (!Snapshot[Id].CsCycles && !Snapshot[Id].Calls)
+      continue;
+    Log("%-20s %8lu %8lu %10lu %10lu %10lu\n", Eve_StatName(Id), (unsigned long)Snapshot[Id].Calls, 
+        (unsigned long)Snapshot[Id].CsCycles, (unsigned long)Snapshot[Id].BytesWritten, 
+        (unsigned long)Snapshot[Id].BytesRead, (unsigned long)Snapshot[Id].Micros);
+  }
+
+  Eve_FrameStatsSnapshot(ctx, &Frames);
+  Log("frames submitted %lu, skipped %lu, unchecked %lu\n", (unsigned long)Frames.Submitted, 
+      (unsigned long)Frames.Skipped, (unsigned long)Frames.Unchecked);
+}
+
+// Where the last Eve_FT81x_Init() spent its time
+void Eve_BootProfile(EveContext *ctx, EveBootProfile *Profile)
+{
+  *Profile = ctx->Boot;
+}
+
+const char *Eve_BootPhaseName(uint8_t Phase)
+{
+  static const char *Names[EVE_BOOT_COUNT] =
+  {
+    "reset", "wake", "REG_ID", "REG_CPURESET", "setup", "touch", "touch upload", "touch reset", "first swap"
+  };
+  return (Phase < EVE_BOOT_COUNT) ? Names[Phase] : "?";
+}
+
+// Log the boot profile as a table.  Without a clock there are only the delays and polls to show.
+void Eve_BootProfilePrint(EveContext *ctx)
+{
+  uint8_t Phase;
+
+  if (!ctx->Hal.Micros)
+  {
+    Log("%-20s %10s %8s   (no clock - define EVE_HAL_MICROS for times)\n", "phase", "delay ms", "polls");
+    for (Phase = 0; Phase < EVE_BOOT_COUNT; Phase++)
+      Log("%-20s %10lu %8lu\n", Eve_BootPhaseName(Phase), (unsigned long)ctx->Boot.DelayMs[Phase],
+          (unsigned long)ctx->Boot.Polls[Phase]);
+    return;
+  }
+  Log("%-20s %10s %10s %8s\n", "phase", "us", "delay ms", "polls");
+  for (Phase = 0; Phase < EVE_BOOT_COUNT; Phase++)
+    Log("%-20s %10lu %10lu %8lu\n", Eve_BootPhaseName(Phase), (unsigned long)ctx->Boot.Micros[Phase],
+        (unsigned long)ctx->Boot.DelayMs[Phase], (unsigned long)ctx->Boot.Polls[Phase]);
+  Log("%-20s %10lu\n", "total", (unsigned long)ctx->Boot.Total);
+}
+
+// ***************************************************************************************************************
+// *** Default context API ***************************************************************************************
+// ***************************************************************************************************************
+// The original single display API.  Each of these is the Eve_ function of the same name working on the
+// default context, which uses the HAL in hw_api.h.
+
+uint32_t Display_Width(void)
+{
+  return Eve_Display_Width(&DefaultContext);
+}
+
+uint32_t Display_Height(void)
+{
+  return Eve_Display_Height(&DefaultContext);
+}
+
+uint8_t Display_Touch(void)
+{
+  return Eve_Display_Touch(&DefaultContext);
+}
+
+uint32_t Display_HOffset(void)
+{
+  return Eve_Display_HOffset(&DefaultContext);
+}
+
+uint32_t Display_VOffset(void)
+{
+  return Eve_Display_VOffset(&DefaultContext);
+}
+
+int FT81x_Init(int display, int board, int touch)
+{
+  return Eve_FT81x_Init(&DefaultContext, display, board, touch);
+}
+
+uint8_t InitError(void)
+{
+  return Eve_InitError(&DefaultContext);
+}
+
+void Eve_Reset(void)
+{
+  Eve_HardReset(&DefaultContext);
+}
+
+void Cap_Touch_Upload(void)
+{
+  Eve_Cap_Touch_Upload(&DefaultContext);
+}
+
+void HostCommand(uint8_t HCMD)
+{
+  Eve_HostCommand(&DefaultContext, HCMD);
+}
+
+void wr32(uint32_t address, uint32_t parameter)
+{
+  Eve_wr32(&DefaultContext, address, parameter);
+}
+
+void wr16(uint32_t address, uint16_t parameter)
+{
+  Eve_wr16(&DefaultContext, address, parameter);
+}
+
+void wr8(uint32_t address, uint8_t parameter)
+{
+  Eve_wr8(&DefaultContext, address, parameter);
+}
+
+uint32_t rd32(uint32_t address)
+{
+  return Eve_rd32(&DefaultContext, address);
+}
+
+uint16_t rd16(uint32_t address)
+{
+  return Eve_rd16(&DefaultContext, address);
+}
+
+uint8_t rd8(uint32_t address)
+{
+  return Eve_rd8(&DefaultContext, address);
+}
+
+void FlushFIFO(void)
+{
+  Eve_FlushFIFO(&DefaultContext);
+}
+
+void Send_CMD(uint32_t data)
+{
+  Eve_Send_CMD(&DefaultContext, data);
+}
+
+void Send_String(const char* str)
+{
+  Eve_Send_String(&DefaultContext, str);
+}
+
+void UpdateFIFO(void)
+{
+  Eve_UpdateFIFO(&DefaultContext);
+}
+
+uint8_t Cmd_READ_REG_ID(void)
+{
+  return Eve_Cmd_READ_REG_ID(&DefaultContext);
+}
+
+void Cmd_Slider(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t options, uint16_t val, uint16_t range)
+{
+  Eve_Cmd_Slider(&DefaultContext, x, y, w, h, options, val, range);
+}
+
+void Cmd_Spinner(uint16_t x, uint16_t y, uint16_t style, uint16_t scale)
+{
+  Eve_Cmd_Spinner(&DefaultContext, x, y, style, scale);
+}
+
+void Cmd_Gauge(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor, uint16_t val, uint16_t range)
+{
+  Eve_Cmd_Gauge(&DefaultContext, x, y, r, options, major, minor, val, range);
+}
+
+void Cmd_Dial(uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t val)
+{
+  Eve_Cmd_Dial(&DefaultContext, x, y, r, options, val);
+}
+
+void Cmd_Track(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t tag)
+{
+  Eve_Cmd_Track(&DefaultContext, x, y, w, h, tag);
+}
+
+void Cmd_Number(uint16_t x, uint16_t y, uint16_t font, uint16_t options, uint32_t num)
+{
+  Eve_Cmd_Number(&DefaultContext, x, y, font, options, num);
+}
+
+void Cmd_Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1)
+{
+  Eve_Cmd_Gradient(&DefaultContext, x0, y0, rgb0, x1, y1, rgb1);
+}
+
+void Cmd_Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
+{
+  Eve_Cmd_Button(&DefaultContext, x, y, w, h, font, options, str);
+}
+
+void Cmd_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str)
+{
+  Eve_Cmd_Text(&DefaultContext, x, y, font, options, str);
+}
+
+void Cmd_Keys(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str)
+{
+  Eve_Cmd_Keys(&DefaultContext, x, y, w, h, font, options, str);
+}
+
+void Cmd_Toggle(uint16_t x, uint16_t y, uint16_t w, uint16_t font, uint16_t options, uint16_t state, const char* str)
+{
+  Eve_Cmd_Toggle(&DefaultContext, x, y, w, font, options, state, str);
+}
+
+void Cmd_SetBitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height)
+{
+  Eve_Cmd_SetBitmap(&DefaultContext, addr, fmt, width, height);
+}
+
+void Cmd_SetFont(uint32_t font, uint32_t ptr)
+{
+  Eve_Cmd_SetFont(&DefaultContext, font, ptr);
+}
+
+void Cmd_Memset(uint32_t ptr, uint32_t value, uint32_t num)
+{
+  Eve_Cmd_Memset(&DefaultContext, ptr, value, num);
+}
+
+void Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num)
+{
+  Eve_Cmd_Memcpy(&DefaultContext, dest, src, num);
+}
+
+void Cmd_Append(uint32_t ptr, uint32_t num)
+{
+  Eve_Cmd_Append(&DefaultContext, ptr, num);
+}
+
+void Cmd_Inflate(uint32_t ptr)
+{
+  Eve_Cmd_Inflate(&DefaultContext, ptr);
+}
+
+uint32_t Cmd_MemCrc(uint32_t ptr, uint32_t num)
+{
+  return Eve_Cmd_MemCrc(&DefaultContext, ptr, num);
+}
+
+void Cmd_LoadImage(uint32_t ptr, uint32_t options)
+{
+  Eve_Cmd_LoadImage(&DefaultContext, ptr, options);
+}
+
+void Cmd_MediaFifo(uint32_t ptr, uint32_t size)
+{
+  Eve_Cmd_MediaFifo(&DefaultContext, ptr, size);
+}
+
+void Cmd_PlayVideo(uint32_t options)
+{
+  Eve_Cmd_PlayVideo(&DefaultContext, options);
+}
+
+void Cmd_VideoStart(void)
+{
+  Eve_Cmd_VideoStart(&DefaultContext);
+}
+
+void Cmd_VideoFrame(uint32_t dst, uint32_t ptr)
+{
+  Eve_Cmd_VideoFrame(&DefaultContext, dst, ptr);
+}
+
+void Cmd_GetPtr(void)
+{
+  Eve_Cmd_GetPtr(&DefaultContext);
+}
+
+void Cmd_GradientColor(uint32_t c)
+{
+  Eve_Cmd_GradientColor(&DefaultContext, c);
+}
+
+void Cmd_FGcolor(uint32_t c)
+{
+  Eve_Cmd_FGcolor(&DefaultContext, c);
+}
+
+void Cmd_BGcolor(uint32_t c)
+{
+  Eve_Cmd_BGcolor(&DefaultContext, c);
+}
+
+void Cmd_Translate(uint32_t tx, uint32_t ty)
+{
+  Eve_Cmd_Translate(&DefaultContext, tx, ty);
+}
+
+void Cmd_Rotate(uint32_t a)
+{
+  Eve_Cmd_Rotate(&DefaultContext, a);
+}
+
+void Cmd_SetRotate(uint32_t rotation)
+{
+  Eve_Cmd_SetRotate(&DefaultContext, rotation);
+}
+
+void Cmd_Scale(uint32_t sx, uint32_t sy)
+{
+  Eve_Cmd_Scale(&DefaultContext, sx, sy);
+}
+
+void Cmd_Flash_Fast(void)
+{
+  Eve_Cmd_Flash_Fast(&DefaultContext);
+}
+
+void Cmd_FlashRead(uint32_t dest, uint32_t src, uint32_t num)
+{
+  Eve_Cmd_FlashRead(&DefaultContext, dest, src, num);
+}
+
+void Cmd_FlashUpdate(uint32_t dest, uint32_t src, uint32_t num)
+{
+  Eve_Cmd_FlashUpdate(&DefaultContext, dest, src, num);
+}
+
+void Cmd_Calibrate(uint32_t result)
+{
+  Eve_Cmd_Calibrate(&DefaultContext, result);
+}
+
+void Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset)
+{
+  Eve_Calibrate_Manual(&DefaultContext, Width, Height, V_Offset, H_Offset);
+}
+
+void Cmd_AnimStart(int32_t ch, uint32_t aoptr, uint32_t loop)
+{
+  Eve_Cmd_AnimStart(&DefaultContext, ch, aoptr, loop);
+}
+
+void Cmd_AnimStop(int32_t ch)
+{
+  Eve_Cmd_AnimStop(&DefaultContext, ch);
+}
+
+void Cmd_AnimXY(int32_t ch, int16_t x, int16_t y)
+{
+  Eve_Cmd_AnimXY(&DefaultContext, ch, x, y);
+}
+
+void Cmd_AnimDraw(int32_t ch)
+{
+  Eve_Cmd_AnimDraw(&DefaultContext, ch);
+}
+
+void Cmd_AnimDrawFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame)
+{
+  Eve_Cmd_AnimDrawFrame(&DefaultContext, x, y, aoptr, frame);
+}
+
+uint16_t CoProFIFO_FreeSpace(void)
+{
+  return Eve_CoProFIFO_FreeSpace(&DefaultContext);
+}
+
+void Wait4CoProFIFO(uint32_t room)
+{
+  Eve_Wait4CoProFIFO(&DefaultContext, room);
+}
+
+void Wait4CoProFIFOEmpty(void)
+{
+  Eve_Wait4CoProFIFOEmpty(&DefaultContext);
+}
+
+void StartCoProTransfer(uint32_t address, uint8_t reading)
+{
+  Eve_StartCoProTransfer(&DefaultContext, address, reading);
+}
+
+void CoProWrCmdBuf(const uint8_t *buff, uint32_t count)
+{
+  Eve_CoProWrCmdBuf(&DefaultContext, buff, count);
+}
+
+uint32_t WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count)
+{
+  return Eve_WriteBlockRAM(&DefaultContext, Add, buff, count);
+}
+
+uint32_t ReadBlockRAM(uint32_t Add, uint8_t *buff, uint32_t count)
+{
+  return Eve_ReadBlockRAM(&DefaultContext, Add, buff, count);
+}
+
+bool FlashAttach(void)
+{
+  return Eve_FlashAttach(&DefaultContext);
+}
+
+bool FlashDetach(void)
+{
+  return Eve_FlashDetach(&DefaultContext);
+}
+
+bool FlashFast(void)
+{
+  return Eve_FlashFast(&DefaultContext);
+}
+
+bool FlashErase(void)
+{
+  return Eve_FlashErase(&DefaultContext);
+}
+
+bool FlashIndexLoad(void)
+{
+  return Eve_FlashIndexLoad(&DefaultContext);
+}
+
+const EveFlashAsset *FlashAsset(uint16_t Id)
+{
+  return Eve_FlashAsset(&DefaultContext, Id);
+}
+
+void TouchStart(void)
+{
+  Eve_TouchStart(&DefaultContext);
+}
+
+void TouchStop(void)
+{
+  Eve_TouchStop(&DefaultContext);
+}
+
+uint8_t TouchService(uint32_t TimeoutMs)
+{
+  return Eve_TouchService(&DefaultContext, TimeoutMs);
+}
+
+bool TouchGet(EveTouchEvent *Event)
+{
+  return Eve_TouchGet(&DefaultContext, Event);
+}
+
+void TouchSnapshotConfig(uint16_t MaxHz, bool Trackers)
+{
+  Eve_TouchSnapshotConfig(&DefaultContext, MaxHz, Trackers);
+}
+
+bool TouchSnapshot(EveTouchSnapshot *Snapshot)
+{
+  return Eve_TouchSnapshot(&DefaultContext, Snapshot);
+}
+
 #if defined(EVE_MO_INTERNAL_BUILD) 
   void EVE_SPI_Enable(void)
   {
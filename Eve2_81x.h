@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include "MatrixEve2Conf.h"    // Library build options size the context below
 // =====================================================================================
 // Required Functions - Hardware driver or otherwise environment specific. Abstracted  |
 // and found in hw_api.h.                                                              |
@@ -345,6 +346,41 @@ extern "C" {
 #define FLASH_STATUS_BASIC         2UL
 #define FLASH_STATUS_FULL          3UL
 
+// Interrupt sources - REG_INT_FLAGS (cleared by reading it), REG_INT_MASK - FT81x Series Programmers Guide Section 3.6
+#define INT_SWAP                   0x01
+#define INT_TOUCH                  0x02   // Touch detected
+#define INT_TAG                    0x04   // REG_TOUCH_TAG changed
+#define INT_SOUND                  0x08
+#define INT_PLAYBACK               0x10
+#define INT_CMDEMPTY               0x20
+#define INT_CMDFLAG                0x40
+#define INT_CONVCOMPLETE           0x80
+
+// Why Eve_FT81x_Init() returned 0 - Eve_InitError()
+#define EVE_INIT_OK                0
+#define EVE_INIT_NO_PANEL          1      // Unknown display, or one left out of EVE_PANELS
+#define EVE_INIT_NO_ID             2      // REG_ID never read 0x7C - no power, clock or SPI
+#define EVE_INIT_CPU_RESET         3      // The engines never came out of reset (REG_CPURESET)
+
+// Flash image layout - built by eve_flashimg.c, read by Eve_FlashIndexLoad()
+//   0     The blob (unified.blob) the BT81x needs to run the flash in full speed mode - 4K
+//   4096  The index: a header then one entry per asset ID, all words little endian
+//   ...   The assets, each FLASH_ASSET_ALIGN aligned so CMD_FLASHSOURCE and ASTC can use them in place
+#define FLASH_BLOB_SIZE            4096
+#define FLASH_INDEX_ADDR           4096
+#define FLASH_INDEX_MAGIC          0x49455645UL   // "EVEI"
+#define FLASH_INDEX_VERSION        1
+#define FLASH_INDEX_HEADER_SIZE    16             // Magic, Version (16), Count (16), CRC-32 of the entries, image size
+#define FLASH_INDEX_ENTRY_SIZE     16             // Addr, Size, Type (16), Format (16), Width (16), Height (16)
+#define FLASH_INDEX_MAX            255            // Entries - the whole index fits in one sector
+#define FLASH_ASSET_ALIGN          64
+
+// Flash asset types
+#define FLASH_ASSET_RAW            0
+#define FLASH_ASSET_BITMAP         1
+#define FLASH_ASSET_FONT           2
+#define FLASH_ASSET_ANIM           3
+
 
 // These defined "macros" are supplied by FTDI - Manufacture command bit-fields from parameters
 // FT81x Series Programmers Guide is refered to as "FT-PG"
@@ -366,15 +402,272 @@ extern "C" {
 #define BEGIN(PrimitiveTypeRef) ((31UL<<24)|(((PrimitiveTypeRef)&15UL)<<0))                                                                                              // BEGIN - FT-PG Section 4.05
 #define END() ((33UL<<24))                                                                                                                                               // END - FT-PG Section 4.30
 #define DISPLAY() ((0UL<<24))                                                                                                                                            // DISPLAY - FT-PG Section 4.29
+#define SAVE_CONTEXT() ((35UL<<24))                                                                                                                                      // SAVE_CONTEXT - FT-PG Section 4.40
+#define RESTORE_CONTEXT() ((34UL<<24))                                                                                                                                   // RESTORE_CONTEXT - FT-PG Section 4.39
 
 // Non FTDI Helper Macros
 #define MAKE_COLOR(r,g,b) (( r << 16) | ( g << 8) | (b))
 
-// Global Variables
-extern uint16_t FifoWriteLocation;
+// Bus instrumentation - only collected when the library is built with EVE_INSTRUMENT defined.
+// SPI traffic is charged to the outermost of these entry points that is running when it happens.
+enum
+{
+  EVE_STAT_REGISTER,             // wr8/16/32, rd8/16/32 and friends called directly by the application
+  EVE_STAT_INIT,                 // FT81x_Init(), Cap_Touch_Upload()
+  EVE_STAT_SEND_CMD,             // Send_CMD() and the Cmd_* widgets - only when the staging buffer fills
+  EVE_STAT_UPDATE_FIFO,          // UpdateFIFO(), FlushFIFO()
+  EVE_STAT_CMD_TEXT,
+  EVE_STAT_CMD_BUTTON,
+  EVE_STAT_COPRO_WRCMDBUF,
+  EVE_STAT_FIFO_WAIT,            // CoProFIFO_FreeSpace(), Wait4CoProFIFO() polling
+  EVE_STAT_FIFO_EMPTY,           // Wait4CoProFIFOEmpty() polling
+  EVE_STAT_BLOCK_WRITE,
+  EVE_STAT_BLOCK_READ,
+  EVE_STAT_CALIBRATE,
+  EVE_STAT_FLASH,                // FlashAttach(), FlashDetach(), FlashFast(), FlashErase()
+  EVE_STAT_FRAME_POLL,           // Eve_FramePoll()
+  EVE_STAT_MEDIA_FIFO,           // Eve_MediaFifo_Write() and the streaming built on it
+  EVE_STAT_VIDEO,                // Eve_VideoStart(), Eve_VideoPoll()
+  EVE_STAT_TOUCH,                // Eve_TouchStart(), Eve_TouchService(), Eve_TouchSnapshot()
+  EVE_STAT_COUNT
+};
+
+typedef struct
+{
+  uint32_t Calls;                // Times the entry point was entered (outermost only)
+  uint32_t CsCycles;             // SPI transactions
+  uint32_t BytesWritten;         // Bytes sent, including address bytes
+  uint32_t BytesRead;            // Bytes received
+  uint32_t Micros;               // Wall time spent inside the entry point, from HAL_Micros()
+} EveStatEntry;
+
+// Frame skipping counters - see Eve_FrameStatsSnapshot()
+typedef struct
+{
+  uint32_t Submitted;            // Frames (CMD_DLSTART .. CMD_SWAP) sent to Eve
+  uint32_t Skipped;              // Frames identical to the one on screen, dropped before any SPI traffic
+  uint32_t Unchecked;            // Frames sent without a chance of skipping - bigger than the staging buffer or volatile
+} EveFrameStats;
+
+// Phases of Eve_FT81x_Init() - see Eve_BootProfile()
+enum
+{
+  EVE_BOOT_RESET,                // Eve_HardReset() - the PD pulse in the HAL
+  EVE_BOOT_WAKE,                 // HCMD_CLKEXT, HCMD_ACTIVE
+  EVE_BOOT_REG_ID,               // Until REG_ID reads 0x7C
+  EVE_BOOT_CPU_RESET,            // Until REG_CPURESET clears
+  EVE_BOOT_SETUP,                // Clock, CoPro recovery, panel timing
+  EVE_BOOT_TOUCH,                // Touch, GPIO and backlight registers
+  EVE_BOOT_TOUCH_UPLOAD,         // Cap_Touch_Upload() - the Goodix configuration through CoProWrCmdBuf()
+  EVE_BOOT_TOUCH_RESET,          // Cap_Touch_Upload() - the touch engine reset and its delays
+  EVE_BOOT_FIRST_SWAP,           // First display list, until REG_DLSWAP shows it taken
+  EVE_BOOT_COUNT
+};
+
+typedef struct
+{
+  uint32_t Micros[EVE_BOOT_COUNT];       // Time in each phase, from the HAL's Micros (0 without one)
+  uint32_t DelayMs[EVE_BOOT_COUNT];      // Of which asked of the HAL's Delay
+  uint32_t Polls[EVE_BOOT_COUNT];        // Register reads spent waiting on Eve
+  uint32_t Total;                        // Micros for the whole of Eve_FT81x_Init()
+} EveBootProfile;
+
+// One asset in the flash image, as found by Eve_FlashAsset()
+typedef struct
+{
+  uint32_t Addr;                 // Byte address in flash, FLASH_ASSET_ALIGN aligned
+  uint32_t Size;                 // Bytes, 0 for an ID with no asset
+  uint16_t Type;                 // FLASH_ASSET_*
+  uint16_t Format;               // Bitmap format for bitmaps, free for the rest
+  uint16_t Width;
+  uint16_t Height;
+} EveFlashAsset;
+
+// Touch events - see Eve_TouchService().  It reads the touch registers no more than every EVE_TOUCH_POLL_MS when
+// it has a clock (Hal.Micros) or an interrupt (Hal.Wait_IRQ) to go by.  With neither it cannot tell how long
+// it has been, so Eve_TouchService(ctx, 0) reads them on every call - pace those calls yourself, or pass a
+// TimeoutMs and let it wait out EVE_TOUCH_POLL_MS with Delay().
+enum
+{
+  EVE_TOUCH_PRESS,
+  EVE_TOUCH_DRAG,                // Moved while down
+  EVE_TOUCH_RELEASE
+};
+
+typedef struct
+{
+  uint8_t Type;                  // EVE_TOUCH_*
+  uint8_t Tag;                   // Tag under the point where the touch started, 0 for none
+  int16_t X;                     // Screen coordinates - where it was last seen for a release
+  int16_t Y;
+} EveTouchEvent;
+
+// Every touch register at once - see Eve_TouchSnapshot()
+#define EVE_TOUCH_POINTS 5
+#define EVE_TOUCH_NONE   (-32768)        // X and Y of a point not touched
+
+typedef struct
+{
+  int16_t X[EVE_TOUCH_POINTS];   // Screen coordinates, EVE_TOUCH_NONE when not touched
+  int16_t Y[EVE_TOUCH_POINTS];
+  uint8_t Tag[EVE_TOUCH_POINTS];
+  uint8_t Touched;               // Bit n set while point n is down
+  uint8_t TrackerTag[EVE_TOUCH_POINTS];      // REG_TRACKER .. REG_TRACKER_4, when asked for
+  uint16_t TrackerValue[EVE_TOUCH_POINTS];
+} EveTouchSnapshot;
+
+// Called from Eve_FramePoll() for each frame the CoPro has finished with - see Eve_SetFrameCallback()
+typedef void (*EveFrameCallback)(uint32_t Frame, bool Completed, void *User);
+
+// Supplies data for Eve_CoProStream() and Eve_MediaFifo_Stream() - fill up to Size bytes of Buffer and return how many, 0 at the end
+typedef uint32_t (*EveProducer)(void *User, uint8_t *Buffer, uint32_t Size);
+
+// *** Contexts ****************************************************************************************************
+// Everything the library knows about one Eve lives in an EveContext, and every Eve_ function takes the context
+// it works on as the first parameter.  Contexts share nothing, so several displays can be driven at the same
+// time, each from its own thread and over its own SPI bus.
+//
+// The original API (wr32(), Send_CMD(), Cmd_Text() ...) is still here and works on the default context, which
+// uses the HAL functions in hw_api.h.  Eve_Default() returns it for code that mixes the two.
+//
+// The size of EveContext depends on the build options in MatrixEve2Conf.h - build everything with the same ones.
+
+// How a context reaches its Eve.  User is passed back to every call.  Micros is only needed with EVE_INSTRUMENT
+// and to time Eve_BootProfile().
+// Wait_IRQ lets touch events wait on Eve's INT pin rather than polling - see Eve_TouchService().
+typedef struct
+{
+  void *User;
+  void (*SPI_Enable)(void *User);                                         // Select Eve (CS)
+  void (*SPI_Disable)(void *User);                                        // Deselect Eve
+  uint8_t (*SPI_Write)(void *User, uint8_t data);                         // Single byte transfer
+  void (*SPI_WriteBuffer)(void *User, uint8_t *Buffer, uint32_t Length);
+  void (*SPI_ReadBuffer)(void *User, uint8_t *Buffer, uint32_t Length);
+  void (*Delay)(void *User, uint32_t milliSeconds);
+  void (*Eve_Reset_HW)(void *User);                                       // Pulse PD
+  uint32_t (*Micros)(void *User);                                         // Free running microsecond counter, may be NULL
+  bool (*Wait_IRQ)(void *User, uint32_t TimeoutMs);                       // Wait for INT to go active, true if it did.  May be NULL
+} EveHal;
+
+typedef struct
+{
+  EveHal Hal;
+
+  // The display, from Eve_FT81x_Init()
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t HOffset;
+  uint32_t VOffset;
+  uint8_t Touch;
+  uint8_t InitError;                     // EVE_INIT_*
+  EveBootProfile Boot;                   // Where the last Eve_FT81x_Init() spent its time
+  bool Booting;                          // Inside Eve_FT81x_Init()
+  uint8_t BootPhase;
+  uint32_t BootMark;                     // Micros when BootPhase started
+
+  // Host side staging of CoPro commands.  Send_CMD() only appends here - nothing goes over SPI until the
+  // buffer fills or UpdateFIFO() is called.  FifoWriteLocation always reflects what has actually been
+  // written to RAM_CMD, so the staged bytes sit logically just past it.
+  uint8_t CmdStage[EVE_CMD_STAGE_SIZE];
+  uint16_t CmdStageCount;
+  uint16_t FifoWriteLocation;
+
+  // BT81x (EVE3/EVE4) parts take commands through REG_CMDB_WRITE, and the CoPro moves its own write pointer.
+  // FT81x parts use the original RAM_CMD + REG_CMD_WRITE method.  Picked by FT81x_Init().
+  bool UseCmdB;
+  uint16_t FifoUnpublished;              // Bytes in RAM_CMD that REG_CMD_WRITE does not cover yet
+  uint16_t CoProRead;                    // Last good REG_CMD_READ seen - the CoPro has got at least this far
+  uint32_t FifoTotal;                    // Every byte ever put in the FIFO, wraps at 4G - frames complete against this
+  uint16_t FifoCredits;                  // Bytes that can be written to the FIFO without looking - see WaitCredits()
+
+  // Media FIFO in RAM_G, from Eve_MediaFifo_Init().  MediaFifoSize is 0 until there is one.
+  uint32_t MediaFifoBase;
+  uint32_t MediaFifoSize;
+  uint32_t MediaFifoWrite;               // Offset of the next byte - where REG_MEDIAFIFO_WRITE is once published
+  uint32_t MediaFifoUnpublished;
+  uint32_t MediaFifoSpace;               // Bytes that can be written without looking, as FifoCredits
+
+  // The flash image's index, by asset ID - see Eve_FlashIndexLoad().  FlashAssetCount is 0 without one.
+  EveFlashAsset FlashAssets[EVE_FLASH_ASSETS];
+  uint16_t FlashAssetCount;
+
+  // Touch events from Eve_TouchService(), waiting for Eve_TouchGet().  The queue has one producer and one
+  // consumer and takes no lock - each side only moves its own index.
+  EveTouchEvent TouchQueue[EVE_TOUCH_QUEUE];
+  volatile uint8_t TouchHead;            // Next event to get
+  volatile uint8_t TouchTail;            // Where the next event goes
+  uint32_t TouchDropped;                 // Events lost to a full queue
+  bool TouchDown;
+  uint8_t TouchTag;                      // Tag the touch that is down started on
+  int16_t TouchX, TouchY;
+  uint32_t TouchLast;                    // Micros at the last poll, when there is no Wait_IRQ
+
+  // The last Eve_TouchSnapshot(), handed out again until SnapshotPeriod has gone by
+  EveTouchSnapshot Snapshot;
+  bool SnapshotValid;
+  bool SnapshotTrackers;
+  uint32_t SnapshotPeriod;               // Microseconds, 0 for no cap
+  uint32_t SnapshotLast;                 // Micros at the last read
+
+  // Frames handed to the CoPro by Eve_FrameSubmit() that it has not got to the end of yet, oldest first
+  struct
+  {
+    uint32_t Frame;
+    uint32_t End;                        // FifoTotal just past the frame's CMD_SWAP
+  } InFlight[EVE_FRAME_QUEUE];
+  uint8_t InFlightFirst;
+  uint8_t InFlightCount;
+  uint32_t FrameNumber;
+  EveFrameCallback FrameDone;
+  void *FrameDoneUser;
+
+#if !defined(EVE_NO_FRAME_SKIP)
+  bool FrameOpen;                        // CMD_DLSTART seen, no CMD_SWAP yet
+  bool FrameSent;                        // Part of the open frame has already gone over SPI
+  bool FrameVolatile;                    // The open frame draws something that changes by itself
+  bool LastValid;                        // LastHash describes what Eve is showing
+  uint16_t FrameStart;                   // Offset in CmdStage of the open frame's CMD_DLSTART
+  uint64_t FrameHash;
+  uint64_t LastHash;
+  EveFrameStats FrameStats;
+#endif
+
+#if defined(EVE_INSTRUMENT)
+  EveStatEntry Stats[EVE_STAT_COUNT];
+  uint8_t StatScope;
+  uint8_t StatDepth;
+  uint32_t StatStart;
+#endif
+} EveContext;
+
+// Video playback - see Eve_VideoPoll()
+typedef struct
+{
+  uint32_t Frames;               // Video frames decoded
+  uint32_t Dropped;              // Display periods in which a due frame was not ready
+  uint32_t Underruns;            // Times the media FIFO was found empty while the decoder waited for data
+  uint32_t Bytes;                // Video data fed to the media FIFO
+} EveVideoStats;
+
+typedef struct
+{
+  EveProducer Producer;
+  void *User;
+  uint32_t Dest;                 // Where each frame is decoded to
+  uint32_t DonePtr;              // CMD_VIDEOFRAME's completion word in RAM_G
+  uint32_t Period;               // Display frames per video frame
+  uint32_t NextDue;              // REG_FRAMES value the next frame is due at
+  uint32_t FrameEnd;             // FifoTotal just past the CMD_VIDEOFRAME being decoded
+  bool Decoding;
+  bool InputDone;                // The producer has returned 0
+  bool Playing;
+  EveVideoStats Stats;
+  uint8_t Buffer[EVE_CMD_STAGE_SIZE];   // Bounce buffer - the staging buffer is busy with whatever else is drawn
+} EveVideo;
 
 // Function Prototypes
 int EVE_EXPORT FT81x_Init(int display, int board, int touch);
+uint8_t EVE_EXPORT InitError(void);
 void EVE_EXPORT Eve_Reset(void);
 void EVE_EXPORT Cap_Touch_Upload(void);
 
@@ -386,6 +679,8 @@ uint8_t EVE_EXPORT rd8(uint32_t RegAddr);
 uint16_t EVE_EXPORT rd16(uint32_t RegAddr);
 uint32_t EVE_EXPORT rd32(uint32_t RegAddr);
 void EVE_EXPORT Send_CMD(uint32_t data);
+void EVE_EXPORT Send_String(const char* str);
+void EVE_EXPORT FlushFIFO(void);
 void EVE_EXPORT UpdateFIFO(void);
 uint8_t EVE_EXPORT Cmd_READ_REG_ID(void);
 
@@ -399,9 +694,21 @@ void EVE_EXPORT Cmd_Number(uint16_t x, uint16_t y, uint16_t font, uint16_t optio
 void EVE_EXPORT Cmd_Gradient(uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1);
 void EVE_EXPORT Cmd_Button(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
 void EVE_EXPORT Cmd_Text(uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str);
+void EVE_EXPORT Cmd_Keys(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
+void EVE_EXPORT Cmd_Toggle(uint16_t x, uint16_t y, uint16_t w, uint16_t font, uint16_t options, uint16_t state, const char* str);
 
 void EVE_EXPORT Cmd_SetBitmap(uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height);
+void EVE_EXPORT Cmd_SetFont(uint32_t font, uint32_t ptr);
+void EVE_EXPORT Cmd_Memset(uint32_t ptr, uint32_t value, uint32_t num);
 void EVE_EXPORT Cmd_Memcpy(uint32_t dest, uint32_t src, uint32_t num);
+void EVE_EXPORT Cmd_Append(uint32_t ptr, uint32_t num);
+void EVE_EXPORT Cmd_Inflate(uint32_t ptr);
+uint32_t EVE_EXPORT Cmd_MemCrc(uint32_t ptr, uint32_t num);
+void EVE_EXPORT Cmd_LoadImage(uint32_t ptr, uint32_t options);
+void EVE_EXPORT Cmd_MediaFifo(uint32_t ptr, uint32_t size);
+void EVE_EXPORT Cmd_PlayVideo(uint32_t options);
+void EVE_EXPORT Cmd_VideoStart(void);
+void EVE_EXPORT Cmd_VideoFrame(uint32_t dst, uint32_t ptr);
 void EVE_EXPORT Cmd_GetPtr(void);
 void EVE_EXPORT Cmd_GradientColor(uint32_t c);
 void EVE_EXPORT Cmd_FGcolor(uint32_t c);
@@ -412,6 +719,8 @@ void EVE_EXPORT Cmd_SetRotate(uint32_t rotation);
 void EVE_EXPORT Cmd_Scale(uint32_t sx, uint32_t sy);
 void EVE_EXPORT Cmd_Calibrate(uint32_t result);
 void EVE_EXPORT Cmd_Flash_Fast(void);
+void EVE_EXPORT Cmd_FlashRead(uint32_t dest, uint32_t src, uint32_t num);
+void EVE_EXPORT Cmd_FlashUpdate(uint32_t dest, uint32_t src, uint32_t num);
 
 void EVE_EXPORT Cmd_AnimStart(int32_t ch, uint32_t aoptr, uint32_t loop);
 void EVE_EXPORT Cmd_AnimStop(int32_t ch);
@@ -419,6 +728,28 @@ void EVE_EXPORT Cmd_AnimXY(int32_t ch, int16_t x, int16_t y);
 void EVE_EXPORT Cmd_AnimDraw(int32_t ch);
 void EVE_EXPORT Cmd_AnimDrawFrame(int16_t x, int16_t y, uint32_t aoptr, uint32_t frame);
 
+void EVE_EXPORT Eve_SetFrameCallback(EveContext *ctx, EveFrameCallback Callback, void *User);
+uint32_t EVE_EXPORT Eve_FrameBegin(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_FrameSubmit(EveContext *ctx);
+uint8_t EVE_EXPORT Eve_FramePoll(EveContext *ctx);
+
+void EVE_EXPORT Eve_FrameInvalidate(EveContext *ctx);
+void EVE_EXPORT Eve_FrameStatsSnapshot(EveContext *ctx, EveFrameStats *Snapshot);
+void EVE_EXPORT Eve_FrameStatsReset(EveContext *ctx);
+
+uint32_t EVE_EXPORT Eve_CoProStream(EveContext *ctx, EveProducer Producer, void *User);
+
+bool EVE_EXPORT Eve_MediaFifo_Init(EveContext *ctx, uint32_t Base, uint32_t Size);
+uint32_t EVE_EXPORT Eve_MediaFifo_Write(EveContext *ctx, const uint8_t *buff, uint32_t count);
+uint32_t EVE_EXPORT Eve_MediaFifo_Stream(EveContext *ctx, EveProducer Producer, void *User);
+uint32_t EVE_EXPORT Eve_MediaFifo_LoadImage(EveContext *ctx, uint32_t Dest, uint32_t Options, EveProducer Producer, void *User);
+
+bool EVE_EXPORT Eve_VideoStart(EveContext *ctx, EveVideo *Video, uint32_t Dest, uint32_t DonePtr, uint32_t Period, EveProducer Producer, void *User);
+uint8_t EVE_EXPORT Eve_VideoPoll(EveContext *ctx, EveVideo *Video);
+
+void EVE_EXPORT Eve_SegmentBegin(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_SegmentEnd(EveContext *ctx, uint32_t dest);
+
 void EVE_EXPORT Calibrate_Manual(uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset);
 
 uint16_t EVE_EXPORT CoProFIFO_FreeSpace(void);
@@ -427,6 +758,7 @@ void EVE_EXPORT Wait4CoProFIFOEmpty(void);
 void EVE_EXPORT StartCoProTransfer(uint32_t address, uint8_t reading);
 void EVE_EXPORT CoProWrCmdBuf(const uint8_t *buffer, uint32_t count);
 uint32_t EVE_EXPORT WriteBlockRAM(uint32_t Add, const uint8_t *buff, uint32_t count);
+uint32_t EVE_EXPORT ReadBlockRAM(uint32_t Add, uint8_t *buff, uint32_t count);
 int32_t EVE_EXPORT CalcCoef(int32_t Q, int32_t K);
 uint32_t EVE_EXPORT Display_Width();
 uint32_t EVE_EXPORT Display_Height();
@@ -434,11 +766,125 @@ uint8_t EVE_EXPORT Display_Touch();
 uint32_t EVE_EXPORT Display_HOffset();
 uint32_t EVE_EXPORT Display_VOffset();
 
+/* The same, for a given context */
+EveContext EVE_EXPORT *Eve_Default(void);
+void EVE_EXPORT Eve_InitContext(EveContext *ctx, const EveHal *Hal);
+uint32_t EVE_EXPORT Eve_Display_Width(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_Display_Height(EveContext *ctx);
+uint8_t EVE_EXPORT Eve_Display_Touch(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_Display_HOffset(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_Display_VOffset(EveContext *ctx);
+int EVE_EXPORT Eve_FT81x_Init(EveContext *ctx, int display, int board, int touch);
+uint8_t EVE_EXPORT Eve_InitError(EveContext *ctx);
+void EVE_EXPORT Eve_HardReset(EveContext *ctx);
+void EVE_EXPORT Eve_Cap_Touch_Upload(EveContext *ctx);
+void EVE_EXPORT Eve_HostCommand(EveContext *ctx, uint8_t HCMD);
+void EVE_EXPORT Eve_wr32(EveContext *ctx, uint32_t address, uint32_t parameter);
+void EVE_EXPORT Eve_wr16(EveContext *ctx, uint32_t address, uint16_t parameter);
+void EVE_EXPORT Eve_wr8(EveContext *ctx, uint32_t address, uint8_t parameter);
+uint32_t EVE_EXPORT Eve_rd32(EveContext *ctx, uint32_t address);
+uint16_t EVE_EXPORT Eve_rd16(EveContext *ctx, uint32_t address);
+uint8_t EVE_EXPORT Eve_rd8(EveContext *ctx, uint32_t address);
+void EVE_EXPORT Eve_FlushFIFO(EveContext *ctx);
+void EVE_EXPORT Eve_Send_CMD(EveContext *ctx, uint32_t data);
+void EVE_EXPORT Eve_Send_String(EveContext *ctx, const char* str);
+void EVE_EXPORT Eve_UpdateFIFO(EveContext *ctx);
+uint8_t EVE_EXPORT Eve_Cmd_READ_REG_ID(EveContext *ctx);
+void EVE_EXPORT Eve_Cmd_Slider(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t options, uint16_t val, uint16_t range);
+void EVE_EXPORT Eve_Cmd_Spinner(EveContext *ctx, uint16_t x, uint16_t y, uint16_t style, uint16_t scale);
+void EVE_EXPORT Eve_Cmd_Gauge(EveContext *ctx, uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t major, uint16_t minor, uint16_t val, uint16_t range);
+void EVE_EXPORT Eve_Cmd_Dial(EveContext *ctx, uint16_t x, uint16_t y, uint16_t r, uint16_t options, uint16_t val);
+void EVE_EXPORT Eve_Cmd_Track(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t tag);
+void EVE_EXPORT Eve_Cmd_Number(EveContext *ctx, uint16_t x, uint16_t y, uint16_t font, uint16_t options, uint32_t num);
+void EVE_EXPORT Eve_Cmd_Gradient(EveContext *ctx, uint16_t x0, uint16_t y0, uint32_t rgb0, uint16_t x1, uint16_t y1, uint32_t rgb1);
+void EVE_EXPORT Eve_Cmd_Button(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
+void EVE_EXPORT Eve_Cmd_Text(EveContext *ctx, uint16_t x, uint16_t y, uint16_t font, uint16_t options, const char* str);
+void EVE_EXPORT Eve_Cmd_Keys(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t font, uint16_t options, const char* str);
+void EVE_EXPORT Eve_Cmd_Toggle(EveContext *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t font, uint16_t options, uint16_t state, const char* str);
+void EVE_EXPORT Eve_Cmd_SetBitmap(EveContext *ctx, uint32_t addr, uint16_t fmt, uint16_t width, uint16_t height);
+void EVE_EXPORT Eve_Cmd_SetFont(EveContext *ctx, uint32_t font, uint32_t ptr);
+void EVE_EXPORT Eve_Cmd_Memset(EveContext *ctx, uint32_t ptr, uint32_t value, uint32_t num);
+void EVE_EXPORT Eve_Cmd_Memcpy(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num);
+void EVE_EXPORT Eve_Cmd_Append(EveContext *ctx, uint32_t ptr, uint32_t num);
+void EVE_EXPORT Eve_Cmd_Inflate(EveContext *ctx, uint32_t ptr);
+uint32_t EVE_EXPORT Eve_Cmd_MemCrc(EveContext *ctx, uint32_t ptr, uint32_t num);
+uint16_t EVE_EXPORT Eve_Cmd_MemCrcQueue(EveContext *ctx, uint32_t ptr, uint32_t num);
+uint32_t EVE_EXPORT Eve_CmdResult(EveContext *ctx, uint16_t Where);
+uint32_t EVE_EXPORT Eve_Crc32(uint32_t Crc, const uint8_t *Data, uint32_t Size);
+void EVE_EXPORT Eve_Cmd_LoadImage(EveContext *ctx, uint32_t ptr, uint32_t options);
+void EVE_EXPORT Eve_Cmd_MediaFifo(EveContext *ctx, uint32_t ptr, uint32_t size);
+void EVE_EXPORT Eve_Cmd_PlayVideo(EveContext *ctx, uint32_t options);
+void EVE_EXPORT Eve_Cmd_VideoStart(EveContext *ctx);
+void EVE_EXPORT Eve_Cmd_VideoFrame(EveContext *ctx, uint32_t dst, uint32_t ptr);
+void EVE_EXPORT Eve_Cmd_GetPtr(EveContext *ctx);
+void EVE_EXPORT Eve_Cmd_GradientColor(EveContext *ctx, uint32_t c);
+void EVE_EXPORT Eve_Cmd_FGcolor(EveContext *ctx, uint32_t c);
+void EVE_EXPORT Eve_Cmd_BGcolor(EveContext *ctx, uint32_t c);
+void EVE_EXPORT Eve_Cmd_Translate(EveContext *ctx, uint32_t tx, uint32_t ty);
+void EVE_EXPORT Eve_Cmd_Rotate(EveContext *ctx, uint32_t a);
+void EVE_EXPORT Eve_Cmd_SetRotate(EveContext *ctx, uint32_t rotation);
+void EVE_EXPORT Eve_Cmd_Scale(EveContext *ctx, uint32_t sx, uint32_t sy);
+void EVE_EXPORT Eve_Cmd_Flash_Fast(EveContext *ctx);
+void EVE_EXPORT Eve_Cmd_FlashRead(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num);
+void EVE_EXPORT Eve_Cmd_FlashUpdate(EveContext *ctx, uint32_t dest, uint32_t src, uint32_t num);
+void EVE_EXPORT Eve_Cmd_Calibrate(EveContext *ctx, uint32_t result);
+void EVE_EXPORT Eve_Calibrate_Manual(EveContext *ctx, uint16_t Width, uint16_t Height, uint16_t V_Offset, uint16_t H_Offset);
+void EVE_EXPORT Eve_Cmd_AnimStart(EveContext *ctx, int32_t ch, uint32_t aoptr, uint32_t loop);
+void EVE_EXPORT Eve_Cmd_AnimStop(EveContext *ctx, int32_t ch);
+void EVE_EXPORT Eve_Cmd_AnimXY(EveContext *ctx, int32_t ch, int16_t x, int16_t y);
+void EVE_EXPORT Eve_Cmd_AnimDraw(EveContext *ctx, int32_t ch);
+void EVE_EXPORT Eve_Cmd_AnimDrawFrame(EveContext *ctx, int16_t x, int16_t y, uint32_t aoptr, uint32_t frame);
+uint16_t EVE_EXPORT Eve_CoProFIFO_FreeSpace(EveContext *ctx);
+void EVE_EXPORT Eve_Wait4CoProFIFO(EveContext *ctx, uint32_t room);
+void EVE_EXPORT Eve_Wait4CoProFIFOEmpty(EveContext *ctx);
+uint32_t EVE_EXPORT Eve_CoProMark(EveContext *ctx);
+uint16_t EVE_EXPORT Eve_FifoWriteLocation(EveContext *ctx);
+bool EVE_EXPORT Eve_WaitCoProMark(EveContext *ctx, uint32_t Mark);
+void EVE_EXPORT Eve_StartCoProTransfer(EveContext *ctx, uint32_t address, uint8_t reading);
+void EVE_EXPORT Eve_CoProWrCmdBuf(EveContext *ctx, const uint8_t *buff, uint32_t count);
+uint32_t EVE_EXPORT Eve_WriteBlockRAM(EveContext *ctx, uint32_t Add, const uint8_t *buff, uint32_t count);
+uint32_t EVE_EXPORT Eve_ReadBlockRAM(EveContext *ctx, uint32_t Add, uint8_t *buff, uint32_t count);
+bool EVE_EXPORT Eve_FlashAttach(EveContext *ctx);
+bool EVE_EXPORT Eve_FlashDetach(EveContext *ctx);
+bool EVE_EXPORT Eve_FlashFast(EveContext *ctx);
+bool EVE_EXPORT Eve_FlashErase(EveContext *ctx);
+bool EVE_EXPORT Eve_FlashIndexLoad(EveContext *ctx);
+const EveFlashAsset EVE_EXPORT *Eve_FlashAsset(EveContext *ctx, uint16_t Id);
+
+/* Touch events */
+void EVE_EXPORT Eve_TouchStart(EveContext *ctx);
+void EVE_EXPORT Eve_TouchStop(EveContext *ctx);
+uint8_t EVE_EXPORT Eve_TouchService(EveContext *ctx, uint32_t TimeoutMs);
+bool EVE_EXPORT Eve_TouchGet(EveContext *ctx, EveTouchEvent *Event);
+void EVE_EXPORT Eve_TouchSnapshotConfig(EveContext *ctx, uint16_t MaxHz, bool Trackers);
+bool EVE_EXPORT Eve_TouchSnapshot(EveContext *ctx, EveTouchSnapshot *Snapshot);
+
+/* Bus instrumentation */
+void EVE_EXPORT Eve_StatsSnapshot(EveContext *ctx, EveStatEntry *Snapshot);
+void EVE_EXPORT Eve_StatsReset(EveContext *ctx);
+const char EVE_EXPORT *Eve_StatName(uint8_t Id);
+void EVE_EXPORT Eve_StatsPrint(EveContext *ctx);
+
+/* Boot profile */
+void EVE_EXPORT Eve_BootProfile(EveContext *ctx, EveBootProfile *Profile);
+const char EVE_EXPORT *Eve_BootPhaseName(uint8_t Phase);
+void EVE_EXPORT Eve_BootProfilePrint(EveContext *ctx);
+
 /* Flash commands */
 bool EVE_EXPORT FlashAttach(void);
 bool EVE_EXPORT FlashDetach(void);
 bool EVE_EXPORT FlashFast(void);
 bool EVE_EXPORT FlashErase(void);
+bool EVE_EXPORT FlashIndexLoad(void);
+const EveFlashAsset EVE_EXPORT *FlashAsset(uint16_t Id);
+
+/* Touch events */
+void EVE_EXPORT TouchStart(void);
+void EVE_EXPORT TouchStop(void);
+uint8_t EVE_EXPORT TouchService(uint32_t TimeoutMs);
+bool EVE_EXPORT TouchGet(EveTouchEvent *Event);
+void EVE_EXPORT TouchSnapshotConfig(uint16_t MaxHz, bool Trackers);
+bool EVE_EXPORT TouchSnapshot(EveTouchSnapshot *Snapshot);
 
 #if defined(EVE_MO_INTERNAL_BUILD) 
   void EVE_EXPORT EVE_SPI_Enable(void);
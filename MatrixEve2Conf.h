@@ -1,3 +1,5 @@
+#pragma once
+
 #define DISPLAY_70 1
 #define DISPLAY_50 2 
 #define DISPLAY_43 3
@@ -16,4 +18,88 @@
 #define TOUCH_TPR 1
 #define TOUCH_TPC 2
 
+// Library build options - define any of these ahead of this file (or on the compiler command line) to override
+
+// Panels Eve_FT81x_Init() has timings for - all of them unless EVE_PANELS lists the ones this build needs, e.g.
+//   #define EVE_PANELS (EVE_PANEL(DISPLAY_43) | EVE_PANEL(DISPLAY_70))
+// and the table entries for the others are left out.
+#define EVE_PANEL(display) (1UL << (display))
+#ifndef EVE_PANELS
+#  define EVE_PANELS 0xFFFFFFFFUL
+#endif
+
+// How long Eve_FT81x_Init() waits after waking Eve for REG_ID to read 0x7C and then for REG_CPURESET to clear,
+// before giving up with EVE_INIT_NO_ID or EVE_INIT_CPU_RESET.  Eve is normally ready in 20 - 40ms.
+#ifndef EVE_BOOT_TIMEOUT_MS
+#  define EVE_BOOT_TIMEOUT_MS 300
+#endif
+
+// Size in bytes of the host side staging buffer that Send_CMD() and the Cmd_* functions append to.  
+// The staged words are pushed into RAM_CMD as one SPI burst by UpdateFIFO() or when the buffer fills.
+// Eve_CoProStream() and Eve_MediaFifo_Stream() also use it as their bounce buffer, so it sets the burst size for
+// streamed data.
+// Must be a multiple of 4 and no larger than the FIFO (FT_CMD_FIFO_SIZE - 4).
+#ifndef EVE_CMD_STAGE_SIZE
+#  define EVE_CMD_STAGE_SIZE 1024
+#endif
+
+// Largest number of payload bytes handed to HAL_SPI_WriteBuffer() / HAL_SPI_ReadBuffer() in one call by
+// WriteBlockRAM(), ReadBlockRAM() and data streamed through the FIFO.  Lower this if your HAL has a DMA
+// transfer limit.
+#ifndef EVE_SPI_MAX_CHUNK
+#  define EVE_SPI_MAX_CHUNK 4096
+#endif
+
+// Number of frames Eve_FrameSubmit() lets the CoPro fall behind before Eve_FrameBegin() waits for it.
+#ifndef EVE_FRAME_QUEUE
+#  define EVE_FRAME_QUEUE 4
+#endif
+
+// Number of blocks a RamGHeap (eve_ramg.h) can hand out at once.  Each costs 24 bytes of the heap structure.
+#ifndef EVE_RAMG_BLOCKS
+#  define EVE_RAMG_BLOCKS 64
+#endif
+
+// Number of bitmaps a BitmapCache (eve_cache.h) can have registered, resident or not.
+#ifndef EVE_CACHE_BITMAPS
+#  define EVE_CACHE_BITMAPS 64
+#endif
+
+// Number of asset IDs Eve_FlashIndexLoad() keeps from the flash image's index (at most FLASH_INDEX_MAX).  Each
+// costs 16 bytes of EveContext.
+#ifndef EVE_FLASH_ASSETS
+#  define EVE_FLASH_ASSETS 64
+#endif
+
+// Touch events Eve_TouchService() can queue before Eve_TouchGet() takes them.  A power of 2, at most 128.
+#ifndef EVE_TOUCH_QUEUE
+#  define EVE_TOUCH_QUEUE 16
+#endif
+
+// How often Eve_TouchService() reads the touch registers while a touch is down, or all the time when there is
+// no interrupt to wait on.  16ms is a frame at 60Hz, so polling adds no latency anyone can see.  Telling when
+// it is due takes a clock (HAL_Micros()) - without one or an interrupt, a call with no timeout always reads.
+#ifndef EVE_TOUCH_POLL_MS
+#  define EVE_TOUCH_POLL_MS 16
+#endif
+
+// Define EVE_NO_MALLOC to guarantee that the library never touches the heap.  Any use of malloc() and
+// friends in a library source file then becomes a build error rather than a surprise at run time (see
+// eve_nomalloc.h).  The host side eve_asset.c and eve_deflate.c need the heap and so no longer build.
+// #define EVE_NO_MALLOC
+
+// Define EVE_INSTRUMENT to count SPI transactions, bytes and time per library entry point - see Eve_StatsSnapshot().
+// Your HAL must then provide HAL_Micros().  Left undefined the counting compiles away completely.
+// #define EVE_INSTRUMENT
+
+// Define EVE_HAL_MICROS if your HAL provides HAL_Micros() but you do not want EVE_INSTRUMENT, so that
+// Eve_BootProfile() still has a clock to time FT81x_Init() with.
+// #define EVE_HAL_MICROS
+
+// Define EVE_HAL_IRQ if your HAL provides HAL_Wait_IRQ(), so that touch events wait on Eve's INT pin and the
+// bus is left alone while nobody touches the screen.  Without it Eve_TouchService() polls every EVE_TOUCH_POLL_MS.
+// #define EVE_HAL_IRQ
 
+// Frames (CMD_DLSTART .. CMD_SWAP) that are identical to the last one sent are dropped before they reach SPI.
+// Frames larger than EVE_CMD_STAGE_SIZE are always sent.  Define EVE_NO_FRAME_SKIP to send every frame.
+// #define EVE_NO_FRAME_SKIP
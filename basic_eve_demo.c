@@ -4,6 +4,7 @@
 #include "Eve2_81x.h"
 #include "hw_api.h"
 #include "MatrixEve2Conf.h"
+#include "eve_calib.h"
 
 //MakeScreen_MatrixOrbital draws a blue dot in the center screen, along
 //with the text "MATRIX ORBITAL"
@@ -27,10 +28,19 @@ void MakeScreen_MatrixOrbital(uint8_t DotSize)
 }
 
 
-// A calibration screen for the touch digitizer 
+// A calibration screen for the touch digitizer, only shown when there is no calibration kept for this panel
 void Calibrate(void)
 {
-	Calibrate_Manual(Display_Width(), Display_Height(), Display_VOffset(), Display_HOffset());
+	CalibStore Store;
+	CalibData Data;
+
+	Calib_FileStore(&Store, "eve_calib.bin");
+	if (Calib_Restore(Eve_Default(), &Store))
+		return;
+	if (Calib_Run(Eve_Default(), 5, 8, &Data))
+		Calib_Save(Eve_Default(), &Store, &Data);
+	else
+		Calibrate_Manual(Display_Width(), Display_Height(), Display_VOffset(), Display_HOffset());
 }
 
 // A Clear screen function 
@@ -46,9 +56,13 @@ void ClearScreen(void)
 	HAL_Delay(10);
 }
 
+// Build with EVE_DEMO_NO_MAIN to use the screens above from another program (see eve_bench.c)
+#if !defined(EVE_DEMO_NO_MAIN)
 int main()
 {
 	FT81x_Init(DISPLAY_101, BOARD_EVE3, TOUCH_TPN); //Initialize the EVE graphics controller. 
+	if (Eve_Default()->Hal.Micros)                   //Only with a clock (EVE_HAL_MICROS) to time it by
+		Eve_BootProfilePrint(Eve_Default());        //Where the bring-up spent its time
 	ClearScreen();	                                //Clear any remnants in the RAM
 	if (Display_Touch() == TOUCH_TPR)
 	{
@@ -56,7 +70,7 @@ int main()
 	}
 
 	MakeScreen_MatrixOrbital(30);                   //Draw the Matrix Orbital Screen
-	uint8_t pressed = 0;
+	TouchStart();                                   //Touch events rather than polling REG_TOUCH_TAG
 
 	while (1)
 	{
@@ -64,24 +78,19 @@ int main()
 		if (_kbhit())
 			break;
 #endif
-		uint8_t Tag = rd8(REG_TOUCH_TAG + RAM_REG);  //Check for touches
-		switch (Tag)
+		EveTouchEvent Event;
+
+		TouchService(100);                            //Sleeps until the screen is touched or 100ms go by
+		while (TouchGet(&Event))
 		{
-			case 1:
-				if (!pressed)
-				{
-					MakeScreen_MatrixOrbital(120); //Blue dot is 120 when touched
-					pressed = 1;
-				}
-				break;
-			default:
-				if (pressed)
-				{
-					pressed = 0;
-					MakeScreen_MatrixOrbital(30); //Blue dot size is 30 when not touched
-				}
-				break;
-		}		
+			if (Event.Tag != 1)
+				continue;
+			if (Event.Type == EVE_TOUCH_PRESS)
+				MakeScreen_MatrixOrbital(120);            //Blue dot is 120 when touched
+			else if (Event.Type == EVE_TOUCH_RELEASE)
+				MakeScreen_MatrixOrbital(30);             //Blue dot size is 30 when not touched
+		}
 	}
 	HAL_Close();
 }
+#endif
@@ -0,0 +1,164 @@
+// Compressed asset upload - see eve_asset.h.
+//
+// An upload goes like this:
+//  - The data is hashed (64 bit FNV-1a) and the cache is asked for <dir>/<hash>-<size>.zz.
+//  - On a miss it is compressed with Deflate_Compress() and, if that made it smaller, written to the cache.
+//    Data that does not compress is simply written to RAM_G with WriteBlockRAM() - nothing is cached.
+//  - The zlib stream goes through the FIFO behind CMD_INFLATE, then CMD_MEMCRC has the CoPro work out the
+//    CRC-32 of what landed in RAM_G.  If that is not the CRC-32 of the data, the data is sent again as is.
+//
+// A cached blob carries the Adler-32 of the data it came from in its last four bytes, which is checked
+// before the blob is used - a damaged cache file or a hash collision just means compressing again.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "eve_asset.h"
+#include "eve_deflate.h"
+#include "eve_nomalloc.h"
+
+#define CACHE_PATH_MAX 512
+
+// ***************************************************************************************************************
+// *** Checksums *************************************************************************************************
+// ***************************************************************************************************************
+
+static uint64_t Fnv1a64(const uint8_t *Data, uint32_t Size)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+
+  while (Size--)
+    h = (h ^ *Data++) * 0x00000100000001B3ULL;
+  return h;
+}
+
+static uint32_t TrailerAdler(const uint8_t *Blob, uint32_t Size)
+{
+  Blob += Size - 4;
+  return ((uint32_t)Blob[0] << 24) | ((uint32_t)Blob[1] << 16) | ((uint32_t)Blob[2] << 8) | Blob[3];
+}
+
+// ***************************************************************************************************************
+// *** Cache *****************************************************************************************************
+// ***************************************************************************************************************
+
+static bool CachePath(const char *Dir, char *Path, const uint8_t *Data, uint32_t Size)
+{
+  if (!Dir)
+    return false;
+  return snprintf(Path, CACHE_PATH_MAX, "%s/%016llx-%08lx.zz", Dir,
+                  (unsigned long long)Fnv1a64(Data, Size), (unsigned long)Size) < CACHE_PATH_MAX;
+}
+
+// The cached blob for Path, if there is one and it belongs to data with this Adler-32.  Caller frees it.
+static uint8_t *CacheRead(const char *Path, uint32_t Adler, uint32_t *BlobSize)
+{
+  FILE *f = fopen(Path, "rb");
+  uint8_t *Blob = NULL;
+  long n;
+
+  if (!f)
+    return NULL;
+  if (fseek(f, 0, SEEK_END) == 0 && (n = ftell(f)) >= 6 && fseek(f, 0, SEEK_SET) == 0)
+  {
+    Blob = (uint8_t*)malloc(n);
+    if (Blob && (fread(Blob, 1, n, f) != (size_t)n || Blob[0] != 0x78 || TrailerAdler(Blob, n) != Adler))
+    {
+      free(Blob);
+      Blob = NULL;
+    }
+    *BlobSize = (uint32_t)n;
+  }
+  fclose(f);
+  return Blob;
+}
+
+// Write through a temporary file so that a half written blob is never found under the real name
+static void CacheWrite(const char *Path, const uint8_t *Blob, uint32_t Size)
+{
+  char Tmp[CACHE_PATH_MAX + 4];
+  FILE *f;
+  bool Ok;
+
+  snprintf(Tmp, sizeof(Tmp), "%s.tmp", Path);
+  if ((f = fopen(Tmp, "wb")) == NULL)
+    return;
+  Ok = fwrite(Blob, 1, Size, f) == Size;
+  Ok = (fclose(f) == 0) && Ok;
+  remove(Path);                                                    // rename() will not replace a file everywhere
+  if (!Ok || rename(Tmp, Path) != 0)
+    remove(Tmp);
+}
+
+// ***************************************************************************************************************
+// *** Upload ****************************************************************************************************
+// ***************************************************************************************************************
+
+void Asset_Init(AssetUploader *Up, const char *CacheDir)
+{
+  memset(Up, 0, sizeof(AssetUploader));
+  Up->CacheDir = (CacheDir && *CacheDir) ? CacheDir : NULL;
+}
+
+static bool UploadRaw(EveContext *ctx, AssetStats *Stats, uint32_t Dest, const uint8_t *Data, uint32_t Size, uint32_t Crc)
+{
+  Eve_WriteBlockRAM(ctx, Dest, Data, Size);
+  Stats->SentBytes += Size;
+  return Eve_Cmd_MemCrc(ctx, Dest, Size) == Crc;
+}
+
+// Put Size bytes of Data into RAM_G at Dest.  Returns true once CMD_MEMCRC agrees that they are there.
+bool Asset_Upload(EveContext *ctx, AssetUploader *Up, uint32_t Dest, const uint8_t *Data, uint32_t Size)
+{
+  AssetStats *Stats = &Up->Stats;
+  char Path[CACHE_PATH_MAX];
+  uint8_t *Blob = NULL;
+  uint32_t BlobSize = 0, Crc = Eve_Crc32(0, Data, Size);
+  bool Cached = CachePath(Up->CacheDir, Path, Data, Size);
+  bool Ok;
+
+  Stats->Uploads++;
+  Stats->DataBytes += Size;
+
+  if (Cached && (Blob = CacheRead(Path, Deflate_Adler32(Data, Size), &BlobSize)) != NULL)
+    Stats->CacheHits++;
+  else if ((Blob = (uint8_t*)malloc(Deflate_Bound(Size))) != NULL)
+  {
+    BlobSize = Deflate_Compress(Data, Size, Blob, Deflate_Bound(Size));
+    if (BlobSize && BlobSize < Size)
+    {
+      Stats->Compressed++;
+      if (Cached)
+        CacheWrite(Path, Blob, BlobSize);
+    }
+    else
+    {
+      free(Blob);
+      Blob = NULL;
+    }
+  }
+
+  if (!Blob)
+  {
+    Stats->Raw++;
+    Ok = UploadRaw(ctx, Stats, Dest, Data, Size, Crc);
+    if (!Ok)
+      Stats->Failures++;
+    return Ok;
+  }
+
+  Eve_Cmd_Inflate(ctx, Dest);
+  Eve_CoProWrCmdBuf(ctx, Blob, BlobSize);
+  Stats->SentBytes += BlobSize;
+  free(Blob);
+
+  Ok = Eve_Cmd_MemCrc(ctx, Dest, Size) == Crc;
+  if (!Ok)
+  {
+    Stats->Retries++;
+    Ok = UploadRaw(ctx, Stats, Dest, Data, Size, Crc);
+    if (!Ok)
+      Stats->Failures++;
+  }
+  return Ok;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Compressed asset upload - host side, see eve_asset.c.
+//
+// Asset_Upload() puts a block of data (a bitmap, a font, anything) into RAM_G the cheap way: deflated on the
+// host, sent through the FIFO behind CMD_INFLATE and checked with CMD_MEMCRC.  Compressed copies are kept
+// in a cache directory keyed by the content, so each asset is only ever compressed once.
+//
+// The state lives in an AssetUploader the caller owns: the cache directory, given to Asset_Init() - pass
+// getenv("EVE_ASSET_CACHE") to take it from the environment - and the counts of what happened.  Without a
+// directory everything still works, the compression is just done again each time.  The directory has to
+// exist already.  Each thread uploading needs its own AssetUploader.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+
+typedef struct
+{
+  uint32_t Uploads;
+  uint32_t CacheHits;             // Compressed copy found in the cache
+  uint32_t Compressed;            // Compressed here and now
+  uint32_t Raw;                   // Sent as is - did not compress
+  uint32_t Retries;               // CRC mismatch after inflating, sent again as is
+  uint32_t Failures;              // CRC mismatch even then
+  uint64_t DataBytes;             // Bytes that ended up in RAM_G
+  uint64_t SentBytes;             // Bytes that went through the FIFO or into RAM_G to get them there
+} AssetStats;
+
+typedef struct
+{
+  const char *CacheDir;           // NULL for no cache
+  AssetStats Stats;               // Read or clear as you like
+} AssetUploader;
+
+void Asset_Init(AssetUploader *Up, const char *CacheDir);     // NULL or "" for no cache
+bool Asset_Upload(EveContext *ctx, AssetUploader *Up, uint32_t Dest, const uint8_t *Data, uint32_t Size);
+
+#ifdef __cplusplus
+}
+#endif
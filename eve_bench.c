@@ -0,0 +1,898 @@
+// Frame level benchmarks with bus cost budgets
+//
+// Every scenario is run against the simulated Eve in hw_api_sim.c, once as an EVE2 (FT81x, RAM_CMD) board
+// and once as an EVE3 (BT81x, REG_CMDB_WRITE) board.  The SPI transactions, bytes and simulated time it took
+// are printed as one JSON object per line and checked against the budget for that scenario (the library logs
+// to stdout too, so keep the lines starting with '{').  The exit code is the number of scenarios that went
+// over budget, so a change to the transport that makes frames more expensive fails the run.
+//
+//   cc -DEVE_DEMO_NO_MAIN eve_bench.c basic_eve_demo.c Eve2_81x.c hw_api_sim.c eve_asset.c eve_deflate.c eve_ramg.c eve_cache.c
+//     eve_flash.c eve_calib.c -o eve_bench
+//   ./eve_bench [scenario]
+//
+// The bus model defaults to 10MHz SPI - see hw_api_sim.h for how to change it.  Budgets are only meaningful
+// for the default model.
+
+#include <stdio.h>
+#include <string.h>
+#include "Eve2_81x.h"
+#include "hw_api.h"
+#include "hw_api_sim.h"
+#include "MatrixEve2Conf.h"
+#include "eve_asset.h"
+#include "eve_ramg.h"
+#include "eve_cache.h"
+#include "eve_flash.h"
+#include "eve_calib.h"
+
+#define BENCH_DISPLAY      DISPLAY_70
+#define BENCH_PAYLOAD      (200 * 1024)
+#define BENCH_UPLOAD       (100 * 1024)
+#define BENCH_ASSET_W      320
+#define BENCH_ASSET_H      160
+#define BENCH_SEGMENT      (RAM_G + 0x80000)
+#define BENCH_MEDIA_FIFO   (RAM_G + 0xE0000)
+#define BENCH_MEDIA_SIZE   (64 * 1024)
+#define BENCH_VIDEO_FRAMES 30
+#define BENCH_VIDEO_CHUNK  6000
+#define BENCH_VIDEO_SIZE   (12 + 12 + 64 + 12 + BENCH_VIDEO_FRAMES * (8 + BENCH_VIDEO_CHUNK) + 8 + BENCH_VIDEO_FRAMES * 16)
+#define BENCH_VIDEO_DONE   (RAM_G + 0xDFFFC)
+#define BENCH_HEAP         (RAM_G + 0x40000)
+#define BENCH_HEAP_SIZE    (256 * 1024)
+#define BENCH_HEAP_BITMAPS 16
+#define BENCH_PAGES        3
+#define BENCH_PAGE_BITMAPS 8
+#define BENCH_PAGE_FRAMES  6
+#define BENCH_FLASH_IMAGE  (1024 * 1024)
+#define BENCH_FLASH_ADDR   (1024 * 1024)
+#define BENCH_FLASH_SCRATCH (RAM_G + 0xC0000)
+
+void MakeScreen_MatrixOrbital(uint8_t DotSize);   // basic_eve_demo.c
+
+static uint8_t Payload[BENCH_PAYLOAD];
+static uint8_t Bitmap[BENCH_ASSET_W * BENCH_ASSET_H * 2];
+static uint8_t Video[BENCH_VIDEO_SIZE];
+static uint8_t FlashImage[BENCH_FLASH_IMAGE];
+static bool RunFailed;
+
+typedef struct
+{
+	const char *Name;
+	int Board;
+	void (*Setup)(void);                         // Not measured, may be NULL
+	void (*Run)(void);
+	uint64_t MaxBytes;                           // Written + read
+	uint64_t MaxTransactions;
+	uint64_t MaxMicros;
+} Scenario;
+
+// ***************************************************************************************************************
+// *** Scenarios *************************************************************************************************
+// ***************************************************************************************************************
+
+static int Board;
+
+static void Bench_Init(void)
+{
+	FT81x_Init(BENCH_DISPLAY, Board, TOUCH_TPR);
+}
+
+static void Bench_MatrixOrbital(void)
+{
+	MakeScreen_MatrixOrbital(30);
+	Wait4CoProFIFOEmpty();
+}
+
+// The same screen again, as an application that rebuilds it on every tick would - this one should be free
+static void Bench_SameScreen(void)
+{
+	MakeScreen_MatrixOrbital(30);
+}
+
+// Numbers whose parameter words are CMD_SWAP and CMD_DLSTART - the second time round it should be free too
+static void Bench_Numbers(void)
+{
+	EveContext *ctx = Eve_Default();
+
+	Eve_Send_CMD(ctx, CMD_DLSTART);
+	Eve_Send_CMD(ctx, CLEAR(1, 1, 1));
+	Eve_Cmd_Number(ctx, 20, 20, 28, OPT_SIGNED, (uint32_t)-255);
+	Eve_Cmd_Number(ctx, 20, 60, 28, OPT_SIGNED, (uint32_t)-256);
+	Eve_Send_CMD(ctx, DISPLAY());
+	Eve_Send_CMD(ctx, CMD_SWAP);
+	Eve_UpdateFIFO(ctx);
+}
+
+static void Bench_Calibrate(void)
+{
+	Sim_ScriptTouch(150, 150);
+	Sim_ScriptTouch(850, 500);
+	Sim_ScriptTouch(500, 850);
+	Calibrate_Manual(Display_Width(), Display_Height(), Display_VOffset(), Display_HOffset());
+}
+
+// 50 widgets: 17 gauges, 17 sliders and 16 labels
+static void DrawDashboard(EveContext *ctx)
+{
+	char Label[16];
+	uint16_t i;
+
+	Eve_Send_CMD(ctx, CMD_DLSTART);
+	Eve_Send_CMD(ctx, CLEAR_COLOR_RGB(0, 0, 32));
+	Eve_Send_CMD(ctx, CLEAR(1, 1, 1));
+	for (i = 0; i < 17; i++)
+		Eve_Cmd_Gauge(ctx, 40 + (i % 9) * 88, 60 + (i / 9) * 100, 40, 0, 10, 5, i * 3, 100);
+	for (i = 0; i < 17; i++)
+		Eve_Cmd_Slider(ctx, 20 + (i % 6) * 130, 260 + (i / 6) * 50, 100, 12, 0, i * 6, 100);
+	for (i = 0; i < 16; i++)
+	{
+		sprintf(Label, "Channel %u", i);
+		Eve_Cmd_Text(ctx, 10 + (i % 8) * 98, 420 + (i / 8) * 24, 26, 0, Label);
+	}
+	Eve_Send_CMD(ctx, DISPLAY());
+	Eve_Send_CMD(ctx, CMD_SWAP);
+	Eve_UpdateFIFO(ctx);
+	Eve_Wait4CoProFIFOEmpty(ctx);
+}
+
+static void Bench_Dashboard(void)
+{
+	DrawDashboard(Eve_Default());
+}
+
+// A second display on its own simulated bus, driven alongside the default one.  Both buses are measured.
+static SimDevice *Second;
+static EveContext SecondCtx;
+
+static void Bench_SecondDisplay(void)
+{
+	EveHal Hal;
+
+	if (!Second)
+		Second = Sim_Create();
+	Sim_Hal(Second, &Hal);
+	Eve_InitContext(&SecondCtx, &Hal);
+	Eve_FT81x_Init(&SecondCtx, DISPLAY_43, Board, TOUCH_TPR);
+}
+
+static void Bench_TwoDisplays(void)
+{
+	DrawDashboard(Eve_Default());
+	DrawDashboard(&SecondCtx);
+}
+
+// The same dashboard with the labels and gauges recorded once as a segment and only the sliders live
+static uint32_t SegmentSize;
+
+static void Bench_DashboardRecord(void)
+{
+	char Label[16];
+	uint16_t i;
+
+	Eve_SegmentBegin(Eve_Default());
+	Send_CMD(COLOR_RGB(255, 255, 255));
+	for (i = 0; i < 17; i++)
+		Cmd_Gauge(40 + (i % 9) * 88, 60 + (i / 9) * 100, 40, 0, 10, 5, i * 3, 100);
+	for (i = 0; i < 16; i++)
+	{
+		sprintf(Label, "Channel %u", i);
+		Cmd_Text(10 + (i % 8) * 98, 420 + (i / 8) * 24, 26, 0, Label);
+	}
+	SegmentSize = Eve_SegmentEnd(Eve_Default(), BENCH_SEGMENT);
+}
+
+static void Bench_DashboardRetained(void)
+{
+	uint16_t i;
+
+	Send_CMD(CMD_DLSTART);
+	Send_CMD(CLEAR_COLOR_RGB(0, 0, 32));
+	Send_CMD(CLEAR(1, 1, 1));
+	Cmd_Append(BENCH_SEGMENT, SegmentSize);
+	for (i = 0; i < 17; i++)
+		Cmd_Slider(20 + (i % 6) * 130, 260 + (i / 6) * 50, 100, 12, 0, i * 6, 100);
+	Send_CMD(DISPLAY());
+	Send_CMD(CMD_SWAP);
+	UpdateFIFO();
+	Wait4CoProFIFOEmpty();
+}
+
+// Four dashboard frames through the pipeline - submitted back to back, then polled until the CoPro is done
+static uint32_t FramesDone;
+
+static void Bench_FrameDone(uint32_t Frame, bool Completed, void *User)
+{
+	(void)Frame;
+	(void)User;
+	if (Completed)
+		FramesDone++;
+}
+
+static void Bench_Pipelined(void)
+{
+	uint16_t f, i;
+
+	FramesDone = 0;
+	Eve_SetFrameCallback(Eve_Default(), Bench_FrameDone, NULL);
+	for (f = 0; f < 4; f++)
+	{
+		Eve_FrameBegin(Eve_Default());
+		Send_CMD(CLEAR_COLOR_RGB(0, 0, 32));
+		Send_CMD(CLEAR(1, 1, 1));
+		Cmd_Append(BENCH_SEGMENT, SegmentSize);
+		for (i = 0; i < 17; i++)
+			Cmd_Slider(20 + (i % 6) * 130, 260 + (i / 6) * 50, 100, 12, 0, (i * 6 + f) % 100, 100);
+		Eve_FrameSubmit(Eve_Default());
+	}
+	while (Eve_FramePoll(Eve_Default()))
+		;
+	if (FramesDone != 4)
+	{
+		printf("pipelined: %u of 4 frames completed\n", FramesDone);
+		RunFailed = true;
+	}
+}
+
+// A frame of about 10K - more than twice the FIFO - built without waiting on the CoPro anywhere
+static void Bench_LongFrame(void)
+{
+	char Label[32];
+	uint16_t i;
+
+	Send_CMD(CMD_DLSTART);
+	Send_CMD(CLEAR(1, 1, 1));
+	for (i = 0; i < 300; i++)
+	{
+		sprintf(Label, "Line %u of a long list", i);
+		Cmd_Text(10 + (i % 3) * 260, (i / 3) * 5, 20, 0, Label);
+	}
+	Send_CMD(DISPLAY());
+	Send_CMD(CMD_SWAP);
+	UpdateFIFO();
+	Wait4CoProFIFOEmpty();
+}
+
+// A 200K JPEG through the command FIFO behind CMD_LOADIMAGE
+static void Bench_CmdBuf(void)
+{
+	Send_CMD(CMD_LOADIMAGE);
+	Send_CMD(RAM_G);
+	Send_CMD(0);
+	CoProWrCmdBuf(Payload, BENCH_PAYLOAD);
+	Wait4CoProFIFOEmpty();
+}
+
+// The same JPEG pulled from a producer in odd sized pieces, as it would come off a file
+static uint32_t Produced;
+
+static uint32_t Bench_Producer(void *User, uint8_t *Buffer, uint32_t Size)
+{
+	uint32_t n = BENCH_PAYLOAD - Produced;
+
+	(void)User;
+	if (n > 777)
+		n = 777;
+	if (n > Size)
+		n = Size;
+	memcpy(Buffer, Payload + Produced, n);
+	Produced += n;
+	return n;
+}
+
+static void Bench_Stream(void)
+{
+	Produced = 0;
+	Send_CMD(CMD_LOADIMAGE);
+	Send_CMD(RAM_G);
+	Send_CMD(0);
+	Eve_CoProStream(Eve_Default(), Bench_Producer, NULL);
+	Wait4CoProFIFOEmpty();
+}
+
+// The same JPEG again, but through a 64K media FIFO with CMD_LOADIMAGE and OPT_MEDIAFIFO
+static void Bench_MediaFifoSetup(void)
+{
+	Eve_MediaFifo_Init(Eve_Default(), BENCH_MEDIA_FIFO, BENCH_MEDIA_SIZE);
+}
+
+static void Bench_MediaFifo(void)
+{
+	Produced = 0;
+	if (Eve_MediaFifo_LoadImage(Eve_Default(), RAM_G, 0, Bench_Producer, NULL) != BENCH_PAYLOAD)
+		RunFailed = true;
+}
+
+// 30 frames of 320x240 motion JPEG at 30fps on a 60Hz panel, with a widget drawn over each frame
+static EveVideo BenchVideo;
+static uint32_t VideoFed;
+
+static uint32_t Bench_VideoProducer(void *User, uint8_t *Buffer, uint32_t Size)
+{
+	uint32_t n = BENCH_VIDEO_SIZE - VideoFed;
+
+	(void)User;
+	if (n > 777)
+		n = 777;
+	if (n > Size)
+		n = Size;
+	memcpy(Buffer, Video + VideoFed, n);
+	VideoFed += n;
+	return n;
+}
+
+static uint8_t *PutTag(uint8_t *p, const char *Tag, uint32_t Value)
+{
+	memcpy(p, Tag, 4);
+	p[4] = (uint8_t)Value; p[5] = (uint8_t)(Value >> 8); p[6] = (uint8_t)(Value >> 16); p[7] = (uint8_t)(Value >> 24);
+	return p + 8;
+}
+
+// Just enough of an AVI: RIFF header, hdrl list with avih, movi list of 00dc chunks and idx1
+static void MakeVideo(void)
+{
+	uint8_t *p = Video;
+	uint32_t i;
+
+	p = PutTag(p, "RIFF", BENCH_VIDEO_SIZE - 8);
+	memcpy(p, "AVI ", 4); p += 4;
+	p = PutTag(p, "LIST", 4 + 64);
+	memcpy(p, "hdrl", 4); p += 4;
+	p = PutTag(p, "avih", 56);
+	memset(p, 0, 56);
+	p[16] = BENCH_VIDEO_FRAMES;                      // dwTotalFrames
+	p += 56;
+	p = PutTag(p, "LIST", 4 + BENCH_VIDEO_FRAMES * (8 + BENCH_VIDEO_CHUNK));
+	memcpy(p, "movi", 4); p += 4;
+	for (i = 0; i < BENCH_VIDEO_FRAMES; i++)
+	{
+		p = PutTag(p, "00dc", BENCH_VIDEO_CHUNK);
+		memset(p, (uint8_t)i, BENCH_VIDEO_CHUNK);
+		p[0] = 0xFF; p[1] = 0xD8;
+		p[BENCH_VIDEO_CHUNK - 2] = 0xFF; p[BENCH_VIDEO_CHUNK - 1] = 0xD9;
+		p += BENCH_VIDEO_CHUNK;
+	}
+	p = PutTag(p, "idx1", BENCH_VIDEO_FRAMES * 16);
+	memset(p, 0, BENCH_VIDEO_FRAMES * 16);
+}
+
+static void Bench_Video(void)
+{
+	EveContext *ctx = Eve_Default();
+	uint32_t Shown = 0;
+
+	VideoFed = 0;
+	Eve_VideoStart(ctx, &BenchVideo, RAM_G, BENCH_VIDEO_DONE, 2, Bench_VideoProducer, NULL);
+	while (Eve_VideoPoll(ctx, &BenchVideo))
+	{
+		if (BenchVideo.Stats.Frames != Shown)
+		{
+			Shown = BenchVideo.Stats.Frames;
+			Eve_FrameBegin(ctx);
+			Eve_Send_CMD(ctx, CLEAR(1, 1, 1));
+			Eve_Cmd_SetBitmap(ctx, RAM_G, RGB565, 320, 240);
+			Eve_Send_CMD(ctx, BEGIN(BITMAPS));
+			Eve_Send_CMD(ctx, VERTEX2F(0, 0));
+			Eve_Send_CMD(ctx, END());
+			Eve_Cmd_Button(ctx, 340, 20, 120, 40, 27, 0, "Stop");
+			Eve_FrameSubmit(ctx);
+		}
+		Eve_FramePoll(ctx);
+		HAL_Delay(4);
+	}
+	while (Eve_FramePoll(ctx));
+	if (BenchVideo.Stats.Frames != BENCH_VIDEO_FRAMES || BenchVideo.Stats.Dropped || BenchVideo.Stats.Underruns)
+		RunFailed = true;
+}
+
+static void Bench_Upload(void)
+{
+	WriteBlockRAM(RAM_G, Payload, BENCH_UPLOAD);
+}
+
+// The same amount of data as a compressible RGB565 bitmap, deflated and sent behind CMD_INFLATE
+static AssetUploader BenchAssets;
+
+static void Bench_Asset(void)
+{
+	if (!Asset_Upload(Eve_Default(), &BenchAssets, RAM_G, Bitmap, sizeof(Bitmap)))
+		RunFailed = true;
+}
+
+// 16 8K bitmaps with every other one freed, and a display list segment pointing at the ones left, compacted
+static RamGHeap BenchHeap;
+static RamGHandle HeapBitmaps[BENCH_HEAP_BITMAPS], HeapList;
+static uint32_t HeapCrc[BENCH_HEAP_BITMAPS];
+
+static void Bench_RamGSetup(void)
+{
+	EveContext *ctx = Eve_Default();
+	uint32_t List[BENCH_HEAP_BITMAPS / 2], i;
+
+	RamG_Init(&BenchHeap, ctx, BENCH_HEAP, BENCH_HEAP_SIZE);
+	for (i = 0; i < BENCH_HEAP_BITMAPS; i++)
+	{
+		HeapBitmaps[i] = RamG_AllocBitmap(&BenchHeap, RGB565, 64, 64, 0);
+		Eve_WriteBlockRAM(ctx, RamG_Addr(&BenchHeap, HeapBitmaps[i]), Payload + i * 1000, RamG_Size(&BenchHeap, HeapBitmaps[i]));
+	}
+	HeapList = RamG_Alloc(&BenchHeap, sizeof(List), 4, RAMG_DISPLAY_LIST);
+	for (i = 0; i < BENCH_HEAP_BITMAPS; i += 2)
+		RamG_Free(&BenchHeap, HeapBitmaps[i]);
+	for (i = 1; i < BENCH_HEAP_BITMAPS; i += 2)
+	{
+		HeapCrc[i] = Eve_Cmd_MemCrc(ctx, RamG_Addr(&BenchHeap, HeapBitmaps[i]), RamG_Size(&BenchHeap, HeapBitmaps[i]));
+		List[i / 2] = BITMAP_SOURCE(RamG_Addr(&BenchHeap, HeapBitmaps[i]));
+	}
+	Eve_WriteBlockRAM(ctx, RamG_Addr(&BenchHeap, HeapList), (uint8_t*)List, sizeof(List));
+}
+
+static void Bench_RamGCompact(void)
+{
+	EveContext *ctx = Eve_Default();
+	RamGReport Report;
+	uint32_t i;
+
+	RamG_Compact(&BenchHeap);
+	RamG_GetReport(&BenchHeap, &Report);
+	if (Report.FreeExtents != 1)
+		RunFailed = true;
+	for (i = 1; i < BENCH_HEAP_BITMAPS; i += 2)
+	{
+		if (Eve_Cmd_MemCrc(ctx, RamG_Addr(&BenchHeap, HeapBitmaps[i]), RamG_Size(&BenchHeap, HeapBitmaps[i])) != HeapCrc[i] ||
+		    Eve_rd32(ctx, RamG_Addr(&BenchHeap, HeapList) + i / 2 * 4) != BITMAP_SOURCE(RamG_Addr(&BenchHeap, HeapBitmaps[i])))
+			RunFailed = true;
+	}
+}
+
+// Three pages of eight 8K bitmaps through a cache with room for two pages, each page prefetched while the
+// one before it is on screen, then back to the first
+static BitmapCache BenchCache;
+
+static bool Bench_CacheReader(void *User, uint32_t Id, uint32_t Offset, uint8_t *Buffer, uint32_t Size)
+{
+	(void)User;
+	memcpy(Buffer, Payload + Id * 4096 + Offset, Size);
+	return true;
+}
+
+static void Bench_CacheSetup(void)
+{
+	uint32_t i;
+
+	RamG_Init(&BenchHeap, Eve_Default(), BENCH_HEAP, BENCH_PAGE_BITMAPS * 2 * 64 * 64 * 2);
+	Cache_Init(&BenchCache, Eve_Default(), &BenchHeap, 0, 15);
+	for (i = 0; i < BENCH_PAGES * BENCH_PAGE_BITMAPS; i++)
+		Cache_AddReader(&BenchCache, i, RGB565, 64, 64, Bench_CacheReader, NULL);
+}
+
+static void Bench_CachePage(uint32_t Page)
+{
+	EveContext *ctx = Eve_Default();
+	uint32_t Frame, i;
+
+	for (Frame = 0; Frame < BENCH_PAGE_FRAMES; Frame++)
+	{
+		Eve_FrameBegin(ctx);
+		Cache_FrameBegin(&BenchCache);
+		Eve_Send_CMD(ctx, CLEAR(1, 1, 1));
+		Eve_Send_CMD(ctx, BEGIN(BITMAPS));
+		for (i = 0; i < BENCH_PAGE_BITMAPS; i++)
+		{
+			if (Cache_Bitmap(&BenchCache, Page * BENCH_PAGE_BITMAPS + i) == CACHE_NO_HANDLE)
+				RunFailed = true;
+			Eve_Send_CMD(ctx, VERTEX2F(i * 80 * 16, 100 * 16));
+		}
+		Eve_Send_CMD(ctx, END());
+		Eve_FrameSubmit(ctx);
+		Eve_FramePoll(ctx);
+	}
+}
+
+static void Bench_CachePages(void)
+{
+	uint32_t Next[BENCH_PAGE_BITMAPS], Page, i;
+	CacheStats Stats;
+
+	for (Page = 0; Page <= BENCH_PAGES; Page++)
+	{
+		Bench_CachePage(Page % BENCH_PAGES);
+		if (Page + 1 < BENCH_PAGES)
+		{
+			for (i = 0; i < BENCH_PAGE_BITMAPS; i++)
+				Next[i] = (Page + 1) * BENCH_PAGE_BITMAPS + i;
+			Cache_Prefetch(&BenchCache, Next, BENCH_PAGE_BITMAPS);
+		}
+	}
+	while (Eve_FramePoll(Eve_Default()));
+	Cache_GetStats(&BenchCache, &Stats);
+	if (Stats.Misses != 2 * BENCH_PAGE_BITMAPS || Stats.Prefetches != 2 * BENCH_PAGE_BITMAPS || Stats.Failures)
+		RunFailed = true;
+}
+
+// A 1M asset image already in flash with three 4K icons changed on the host
+static void Bench_FlashSetup(void)
+{
+	uint32_t Size, i;
+	uint8_t *Flash = Sim_Flash(&Size);
+
+	for (i = 0; i < BENCH_FLASH_IMAGE; i++)
+		FlashImage[i] = (uint8_t)(i * 13 + (i >> 12));
+	memcpy(Flash + BENCH_FLASH_ADDR, FlashImage, BENCH_FLASH_IMAGE);
+	for (i = 0; i < FLASH_SECTOR_SIZE; i++)
+	{
+		FlashImage[3 * FLASH_SECTOR_SIZE + i] ^= 0x5A;
+		FlashImage[100 * FLASH_SECTOR_SIZE + i] = 0;
+		FlashImage[101 * FLASH_SECTOR_SIZE + i] = (uint8_t)i;
+	}
+}
+
+static void Bench_FlashUpdate(void)
+{
+	FlashUpdateStats Stats;
+	uint32_t Size;
+
+	if (!Flash_Update(Eve_Default(), BENCH_FLASH_ADDR, FlashImage, BENCH_FLASH_IMAGE, BENCH_FLASH_SCRATCH, &Stats) ||
+	    Stats.Changed != 3 || memcmp(Sim_Flash(&Size) + BENCH_FLASH_ADDR, FlashImage, BENCH_FLASH_IMAGE))
+		RunFailed = true;
+}
+
+// A flash image index (eve_flashimg.c) with assets at IDs 0, 1 and 5
+static void Bench_FlashIndexSetup(void)
+{
+	static const uint32_t Entries[6][4] =
+	{
+		{ 8192, 76800, FLASH_ASSET_BITMAP | (RGB565 << 16), 320 | (120 << 16) },
+		{ 84992, 9000, FLASH_ASSET_FONT, 0 },
+		{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 },
+		{ 94016, 500000, FLASH_ASSET_ANIM, 0 },
+	};
+	uint32_t Size, i;
+	uint8_t *Index = Sim_Flash(&Size) + FLASH_INDEX_ADDR;
+
+	memcpy(Index + FLASH_INDEX_HEADER_SIZE, Entries, sizeof(Entries));       // Little endian host
+	Index[0] = 'E';
+	Index[1] = 'V';
+	Index[2] = 'E';
+	Index[3] = 'I';
+	Index[4] = FLASH_INDEX_VERSION;
+	Index[5] = 0;
+	Index[6] = 6;
+	Index[7] = 0;
+	i = Eve_Crc32(0, Index + FLASH_INDEX_HEADER_SIZE, sizeof(Entries));
+	memcpy(Index + 8, &i, 4);
+	i = 594016;
+	memcpy(Index + 12, &i, 4);
+}
+
+static void Bench_FlashIndex(void)
+{
+	const EveFlashAsset *Asset = NULL;
+
+	if (!Eve_FlashFast(Eve_Default()) || !Eve_FlashIndexLoad(Eve_Default()) ||
+	    (Asset = Eve_FlashAsset(Eve_Default(), 0)) == NULL || Asset->Width != 320 ||
+	    Asset->Format != RGB565 || Eve_FlashAsset(Eve_Default(), 3) || Eve_FlashAsset(Eve_Default(), 6) ||
+	    !Eve_FlashAsset(Eve_Default(), 5) || Eve_FlashAsset(Eve_Default(), 5)->Size != 500000)
+		RunFailed = true;
+}
+
+// A second and a half of an idle touch screen, with a tap on tag 1 a second in
+static void Bench_TouchSetup(void)
+{
+	Sim_ScriptPress(1, 400, 240, 1000, 120);
+}
+
+static void Bench_Touch(void)
+{
+	EveTouchEvent Event;
+	uint64_t End = Sim_TimeNs() + 1500000000ULL;
+	uint8_t Seen = 0;
+
+	Eve_TouchStart(Eve_Default());
+	while (Sim_TimeNs() < End)
+	{
+		Eve_TouchService(Eve_Default(), 100);
+		while (Eve_TouchGet(Eve_Default(), &Event))
+			if (Event.Tag == 1 && Event.Type == (Seen ? EVE_TOUCH_RELEASE : EVE_TOUCH_PRESS))
+				Seen++;
+	}
+	Eve_TouchStop(Eve_Default());
+	if (Seen != 2)
+		RunFailed = true;
+}
+
+// The same waiting on INT, as a build with EVE_HAL_IRQ would
+static bool Bench_WaitIRQ(void *User, uint32_t TimeoutMs)
+{
+	(void)User;
+	return HAL_Wait_IRQ(TimeoutMs);
+}
+
+static void Bench_TouchIrq(void)
+{
+	Eve_Default()->Hal.Wait_IRQ = Bench_WaitIRQ;
+	Bench_Touch();
+	Eve_Default()->Hal.Wait_IRQ = NULL;
+}
+
+static uint32_t Bench_Micros(void *User)
+{
+	(void)User;
+	return HAL_Micros();
+}
+
+// A second of sampling every millisecond, capped at 120Hz, with a press half way through
+static void Bench_TouchSnapshotSetup(void)
+{
+	Sim_ScriptPress(7, 123, 45, 500, 100);
+}
+
+static void Bench_TouchSnapshot(void)
+{
+	EveTouchSnapshot Snapshot;
+	uint64_t End = Sim_TimeNs() + 1000000000ULL;
+	uint32_t Fresh = 0, Touched = 0;
+
+	Eve_Default()->Hal.Micros = Bench_Micros;
+	Eve_TouchSnapshotConfig(Eve_Default(), 120, true);
+	while (Sim_TimeNs() < End)
+	{
+		Fresh += Eve_TouchSnapshot(Eve_Default(), &Snapshot);
+		if (Snapshot.Touched == 1 && Snapshot.Tag[0] == 7 && Snapshot.X[0] == 123 && Snapshot.Y[0] == 45)
+			Touched++;
+		HAL_Delay(1);
+	}
+	Eve_TouchSnapshotConfig(Eve_Default(), 0, false);
+	Eve_Default()->Hal.Micros = NULL;
+	if (Fresh < 100 || Fresh > 120 || Touched < 90)
+		RunFailed = true;
+}
+
+// A CalibStore in host memory
+static uint8_t CalibRecord[CALIB_RECORD_SIZE];
+static bool CalibKept;
+
+static bool Bench_CalibLoad(void *User, uint8_t *Record, uint32_t Size)
+{
+	(void)User;
+	memcpy(Record, CalibRecord, Size);
+	return CalibKept;
+}
+
+static bool Bench_CalibSave(void *User, const uint8_t *Record, uint32_t Size)
+{
+	(void)User;
+	memcpy(CalibRecord, Record, Size);
+	return CalibKept = true;
+}
+
+static const CalibStore BenchCalibStore = { Bench_CalibLoad, Bench_CalibSave, NULL };
+static CalibFlash BenchCalibFlash;
+
+// Where a panel that is mirrored in y and a little off centre reads screen point (x, y)
+static uint16_t RawX(uint32_t x) { return (uint16_t)(80 + x * 860 / Display_Width()); }
+static uint16_t RawY(uint32_t y) { return (uint16_t)(950 - y * 880 / Display_Height()); }
+
+// Five points of four readings each, jittered by up to 3 raw steps, fitted and kept
+static void Bench_CalibrateLS(void)
+{
+	static const uint8_t Where[5][2] = { { 1, 1 }, { 9, 1 }, { 9, 9 }, { 1, 9 }, { 5, 5 } };
+	static const int8_t Jitter[4] = { 3, -2, -3, 2 };
+	uint32_t x, y, i, j;
+	int32_t Fx, Fy;
+	CalibData Data;
+
+	for (i = 0; i < 5; i++)
+	{
+		x = Display_Width() * Where[i][0] / 10;
+		y = Display_Height() * Where[i][1] / 10;
+		for (j = 0; j < 4; j++)
+			Sim_ScriptTouch(RawX(x) + Jitter[j], RawY(y) - Jitter[3 - j]);
+		Sim_ScriptTouch(0x8000, 0x8000);                               // Lifted
+	}
+	if (!Calib_Run(Eve_Default(), 5, 4, &Data) || Data.Error > 16 || !Calib_Save(Eve_Default(), &BenchCalibStore, &Data))
+	{
+		RunFailed = true;
+		return;
+	}
+
+	// Anywhere on the screen should now come out within a pixel
+	for (x = 0; x < Display_Width(); x += 50)
+		for (y = 0; y < Display_Height(); y += 50)
+		{
+			Fx = (int32_t)(((int64_t)Data.Transform[0] * RawX(x) + (int64_t)Data.Transform[1] * RawY(y) + Data.Transform[2]) >> 16);
+			Fy = (int32_t)(((int64_t)Data.Transform[3] * RawX(x) + (int64_t)Data.Transform[4] * RawY(y) + Data.Transform[5]) >> 16);
+			if (Fx < (int32_t)x - 1 || Fx > (int32_t)x + 1 || Fy < (int32_t)y - 1 || Fy > (int32_t)y + 1)
+				RunFailed = true;
+		}
+}
+
+// What Bench_CalibrateLS() would have kept, both in memory and in the last flash sector
+static void Bench_CalibKeep(void)
+{
+	CalibData Data = { { 52428, 0, -4128768, 0, -48770, 3008102 }, Calib_Signature(Eve_Default()), 5, 4 };
+	CalibStore Flash;
+	uint32_t Size;
+
+	Sim_Flash(&Size);
+	BenchCalibFlash.ctx = Eve_Default();
+	BenchCalibFlash.Addr = Size - FLASH_SECTOR_SIZE;
+	Calib_FlashStore(&Flash, &BenchCalibFlash);
+	if (!Calib_Save(Eve_Default(), &BenchCalibStore, &Data) || !Calib_Save(Eve_Default(), &Flash, &Data))
+		RunFailed = true;
+}
+
+// Boot with a calibration already kept - one write of the six registers
+static void Bench_CalibRestore(void)
+{
+	if (!Calib_Restore(Eve_Default(), &BenchCalibStore))
+		RunFailed = true;
+}
+
+static void Bench_CalibRestoreFlash(void)
+{
+	CalibStore Store;
+
+	Calib_FlashStore(&Store, &BenchCalibFlash);
+	if (!Calib_Restore(Eve_Default(), &Store))
+		RunFailed = true;
+}
+
+// A capacitive panel brought up from cold with the HAL clock, so every phase of the boot is timed
+static void Bench_BootProfile(void)
+{
+	EveBootProfile Profile;
+	uint32_t Sum = 0;
+	uint8_t Phase;
+
+	Eve_Default()->Hal.Micros = Bench_Micros;
+	FT81x_Init(BENCH_DISPLAY, Board, TOUCH_TPC);
+	Eve_Default()->Hal.Micros = NULL;
+	Eve_BootProfile(Eve_Default(), &Profile);
+	for (Phase = 0; Phase < EVE_BOOT_COUNT; Phase++)
+		Sum += Profile.Micros[Phase];
+	if (Sum != Profile.Total || !Profile.Polls[EVE_BOOT_REG_ID] || !Profile.Micros[EVE_BOOT_RESET] ||
+	    Profile.DelayMs[EVE_BOOT_TOUCH_RESET] != (Board == BOARD_EVE2 ? 101 : 0))
+		RunFailed = true;
+}
+
+static const Scenario Scenarios[] =
+{
+	{ "init",                BOARD_EVE2,  NULL,                   Bench_Init,               300,     50,   45000 },
+	{ "init",                BOARD_EVE3,  NULL,                   Bench_Init,               300,     50,   45000 },
+	{ "matrixorbital",       BOARD_EVE2,  NULL,                   Bench_MatrixOrbital,      120,     5,    105 },
+	{ "matrixorbital",       BOARD_EVE3,  NULL,                   Bench_MatrixOrbital,      120,     5,    105 },
+	{ "matrixorbital_same",  BOARD_EVE2,  Bench_MatrixOrbital,    Bench_SameScreen,         0,       0,    0 },
+	{ "matrixorbital_same",  BOARD_EVE3,  Bench_MatrixOrbital,    Bench_SameScreen,         0,       0,    0 },
+	{ "numbers_same",        BOARD_EVE2,  Bench_Numbers,          Bench_Numbers,            0,       0,    0 },
+	{ "numbers_same",        BOARD_EVE3,  Bench_Numbers,          Bench_Numbers,            0,       0,    0 },
+	{ "calibrate",           BOARD_EVE2,  NULL,                   Bench_Calibrate,          520,     24,   901000 },
+	{ "calibrate",           BOARD_EVE3,  NULL,                   Bench_Calibrate,          520,     24,   901000 },
+	{ "dashboard",           BOARD_EVE2,  NULL,                   Bench_Dashboard,          1200,    7,    1000 },
+	{ "dashboard",           BOARD_EVE3,  NULL,                   Bench_Dashboard,          1200,    7,    1000 },
+	{ "two_displays",        BOARD_EVE2,  Bench_SecondDisplay,    Bench_TwoDisplays,        2400,    14,   2000 },
+	{ "two_displays",        BOARD_EVE3,  Bench_SecondDisplay,    Bench_TwoDisplays,        2400,    14,   2000 },
+	{ "dashboard_retained",  BOARD_EVE2,  Bench_DashboardRecord,  Bench_DashboardRetained,  420,     6,    360 },
+	{ "dashboard_retained",  BOARD_EVE3,  Bench_DashboardRecord,  Bench_DashboardRetained,  420,     6,    360 },
+	{ "dashboard_pipelined", BOARD_EVE2,  Bench_DashboardRecord,  Bench_Pipelined,          1600,    11,   1350 },
+	{ "dashboard_pipelined", BOARD_EVE3,  Bench_DashboardRecord,  Bench_Pipelined,          1600,    11,   1350 },
+	{ "long_frame",          BOARD_EVE2,  NULL,                   Bench_LongFrame,          11500,   24,   9500 },
+	{ "long_frame",          BOARD_EVE3,  NULL,                   Bench_LongFrame,          11500,   24,   9500 },
+	{ "cmdbuf_200k",         BOARD_EVE2,  NULL,                   Bench_CmdBuf,             208000,  250,  170000 },
+	{ "cmdbuf_200k",         BOARD_EVE3,  NULL,                   Bench_CmdBuf,             207000,  120,  170000 },
+	{ "stream_200k",         BOARD_EVE2,  NULL,                   Bench_Stream,             209000,  600,  170000 },
+	{ "stream_200k",         BOARD_EVE3,  NULL,                   Bench_Stream,             207000,  300,  170000 },
+	{ "mediafifo_200k",      BOARD_EVE2,  Bench_MediaFifoSetup,   Bench_MediaFifo,          207000,  240,  170000 },
+	{ "mediafifo_200k",      BOARD_EVE3,  Bench_MediaFifoSetup,   Bench_MediaFifo,          207000,  240,  170000 },
+	{ "video_30f",           BOARD_EVE2,  Bench_MediaFifoSetup,   Bench_Video,              190000,  900,  1050000 },
+	{ "video_30f",           BOARD_EVE3,  Bench_MediaFifoSetup,   Bench_Video,              190000,  900,  1050000 },
+	{ "upload_100k",         BOARD_EVE2,  NULL,                   Bench_Upload,             104000,  28,   85000 },
+	{ "upload_100k",         BOARD_EVE3,  NULL,                   Bench_Upload,             104000,  28,   85000 },
+	{ "asset_100k",          BOARD_EVE2,  NULL,                   Bench_Asset,              4000,    12,   3500 },
+	{ "asset_100k",          BOARD_EVE3,  NULL,                   Bench_Asset,              4000,    12,   3500 },
+	{ "ramg_compact",        BOARD_EVE2,  Bench_RamGSetup,        Bench_RamGCompact,        700,     60,   800 },
+	{ "ramg_compact",        BOARD_EVE3,  Bench_RamGSetup,        Bench_RamGCompact,        700,     60,   800 },
+	{ "cache_pages",         BOARD_EVE2,  Bench_CacheSetup,       Bench_CachePages,         270000,  320,  220000 },
+	{ "cache_pages",         BOARD_EVE3,  Bench_CacheSetup,       Bench_CachePages,         270000,  320,  220000 },
+	{ "flash_update",        BOARD_EVE2,  Bench_FlashSetup,       Bench_FlashUpdate,        34000,   720,  170000 },
+	{ "flash_update",        BOARD_EVE3,  Bench_FlashSetup,       Bench_FlashUpdate,        34000,   720,  170000 },
+	{ "flash_index",         BOARD_EVE2,  Bench_FlashIndexSetup,  Bench_FlashIndex,         260,     20,   300 },
+	{ "flash_index",         BOARD_EVE3,  Bench_FlashIndexSetup,  Bench_FlashIndex,         260,     20,   300 },
+	{ "touch_poll",          BOARD_EVE2,  Bench_TouchSetup,       Bench_Touch,              2000,    130,   1600000 },
+	{ "touch_poll",          BOARD_EVE3,  Bench_TouchSetup,       Bench_Touch,              2000,    130,   1600000 },
+	{ "touch_irq",           BOARD_EVE2,  Bench_TouchSetup,       Bench_TouchIrq,           260,     24,    1600000 },
+	{ "touch_irq",           BOARD_EVE3,  Bench_TouchSetup,       Bench_TouchIrq,           260,     24,    1600000 },
+	{ "touch_snapshot",      BOARD_EVE2,  Bench_TouchSnapshotSetup, Bench_TouchSnapshot,    17000,   230,   1100000 },
+	{ "touch_snapshot",      BOARD_EVE3,  Bench_TouchSnapshotSetup, Bench_TouchSnapshot,    17000,   230,   1100000 },
+	{ "calibrate_ls",        BOARD_EVE2,  NULL,                   Bench_CalibrateLS,        1200,    100,   200000 },
+	{ "calibrate_ls",        BOARD_EVE3,  NULL,                   Bench_CalibrateLS,        1200,    100,   200000 },
+	{ "calib_restore",       BOARD_EVE2,  Bench_CalibKeep,        Bench_CalibRestore,       40,      1,     30 },
+	{ "calib_restore",       BOARD_EVE3,  Bench_CalibKeep,        Bench_CalibRestore,       40,      1,     30 },
+	{ "calib_restore_flash", BOARD_EVE2,  Bench_CalibKeep,        Bench_CalibRestoreFlash,  200,     12,    200 },
+	{ "calib_restore_flash", BOARD_EVE3,  Bench_CalibKeep,        Bench_CalibRestoreFlash,  200,     12,    200 },
+	{ "boot_profile",        BOARD_EVE2,  NULL,                   Bench_BootProfile,        1800,    80,    160000 },
+	{ "boot_profile",        BOARD_EVE3,  NULL,                   Bench_BootProfile,        400,     60,    45000 },
+};
+
+// ***************************************************************************************************************
+
+int main(int argc, char **argv)
+{
+	const Scenario *s;
+	SimStats Stats, More;
+	uint64_t Bytes, Micros;
+	uint32_t i, x, y;
+	uint16_t Pixel;
+	int Failed = 0;
+	bool Pass;
+
+	// Something that looks enough like a JPEG for the CoPro to find the end of it
+	for (i = 0; i < BENCH_PAYLOAD; i++)
+		Payload[i] = (uint8_t)((i * 7) & 0x7F);
+	Payload[0] = 0xFF; Payload[1] = 0xD8;
+	Payload[BENCH_PAYLOAD - 2] = 0xFF; Payload[BENCH_PAYLOAD - 1] = 0xD9;
+
+	// Something that looks enough like a UI bitmap - flat panels, a gradient and a checker pattern
+	for (y = 0; y < BENCH_ASSET_H; y++)
+		for (x = 0; x < BENCH_ASSET_W; x++)
+		{
+			if (y < 24)
+				Pixel = 0x18E3;
+			else if (((x / 16) ^ (y / 16)) & 1)
+				Pixel = (uint16_t)(((y >> 2) << 11) | ((x >> 3) << 5) | 0x0F);
+			else
+				Pixel = 0xFFFF;
+			Bitmap[(y * BENCH_ASSET_W + x) * 2] = (uint8_t)Pixel;
+			Bitmap[(y * BENCH_ASSET_W + x) * 2 + 1] = (uint8_t)(Pixel >> 8);
+		}
+	Asset_Init(&BenchAssets, NULL);
+	MakeVideo();
+
+	for (i = 0; i < sizeof(Scenarios) / sizeof(Scenarios[0]); i++)
+	{
+		s = &Scenarios[i];
+		if (argc > 1 && strcmp(argv[1], s->Name))
+			continue;
+
+		if (Board != s->Board || s->Run == Bench_Init)
+		{
+			Board = s->Board;
+			if (s->Run != Bench_Init)
+				Bench_Init();                    // Every other scenario wants a running display
+		}
+
+		if (s->Setup)
+			s->Setup();
+
+		Sim_ResetStats();
+		if (Second)
+			SimDev_ResetStats(Second);
+		RunFailed = false;
+		s->Run();
+		Sim_GetStats(&Stats);
+		if (Second && s->Setup == Bench_SecondDisplay)
+		{
+			SimDev_GetStats(Second, &More);
+			Stats.Transactions += More.Transactions;
+			Stats.BytesWritten += More.BytesWritten;
+			Stats.BytesRead += More.BytesRead;
+			Stats.TimeNs += More.TimeNs;
+			Stats.Swaps += More.Swaps;
+		}
+
+		Bytes = Stats.BytesWritten + Stats.BytesRead;
+		Micros = Stats.TimeNs / 1000;
+		Pass = Bytes <= s->MaxBytes && Stats.Transactions <= s->MaxTransactions && Micros <= s->MaxMicros && !RunFailed;
+		if (!Pass)
+			Failed++;
+
+		printf("{\"scenario\":\"%s\",\"board\":\"%s\",\"transactions\":%llu,\"bytes_written\":%llu,\"bytes_read\":%llu,"
+		       "\"time_us\":%llu,\"swaps\":%u,\"budget_bytes\":%llu,\"budget_transactions\":%llu,\"budget_us\":%llu,\"pass\":%s}\n",
+		       s->Name, s->Board == BOARD_EVE2 ? "eve2" : "eve3",
+		       (unsigned long long)Stats.Transactions, (unsigned long long)Stats.BytesWritten,
+		       (unsigned long long)Stats.BytesRead, (unsigned long long)Micros, Stats.Swaps,
+		       (unsigned long long)s->MaxBytes, (unsigned long long)s->MaxTransactions,
+		       (unsigned long long)s->MaxMicros, Pass ? "true" : "false");
+	}
+	Sim_Destroy(Second);
+	HAL_Close();
+	return Failed;
+}
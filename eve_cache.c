@@ -0,0 +1,340 @@
+// Bitmap cache - see eve_cache.h.
+//
+// Entries are looked up by ID with a straight search - there are only EVE_CACHE_BITMAPS of them.  The cache
+// keeps a clock that ticks on every draw and prefetch, and each entry remembers when it was last touched, so
+// the least recently used entry is the resident one with the oldest time that is not pinned.
+//
+// An entry is pinned while any frame that may draw from it can still reach the screen: the one being built,
+// the ones Eve_FrameSubmit() may have queued (EVE_FRAME_QUEUE) and the one on screen.  Bitmap handles are only
+// held for the frame being built - the display list starts from scratch every frame - so any handle not used
+// in it yet can be given to another entry.  Each frame sets a handle up (Cmd_SetBitmap()) the first time it
+// is used.
+//
+// The heap may be shared, so pinned entries are RAMG_PINNED in it too and RamG_Compact() leaves them where the
+// frames that draw them expect.  An entry it does move is in none of those frames, so no handle is set up for
+// it in the frame being built and the next Cmd_SetBitmap() picks up the new address.
+//
+// Loading writes RAM_G, which Eve_WriteBlockRAM() and friends already tell the frame skipping about, so a frame
+// that draws a newly loaded bitmap is never mistaken for the last one.
+
+#include <string.h>
+#include "eve_cache.h"
+#include "eve_nomalloc.h"
+
+static CacheEntry *Find(BitmapCache *Cache, uint32_t Id)
+{
+  uint16_t i;
+
+  for (i = 0; i < Cache->Count; i++)
+    if (Cache->Entries[i].Id == Id)
+      return &Cache->Entries[i];
+  return NULL;
+}
+
+static bool IsPinned(const BitmapCache *Cache, const CacheEntry *e)
+{
+  return e->Frame && Cache->Frame - e->Frame <= EVE_FRAME_QUEUE;
+}
+
+// Tell the heap whether e may be moved
+static void PinBlock(BitmapCache *Cache, CacheEntry *e)
+{
+  if (e->Block)
+    RamG_SetFlags(Cache->Heap, e->Block, IsPinned(Cache, e) ? RAMG_PINNED : 0);
+}
+
+// ***************************************************************************************************************
+// *** Registration **********************************************************************************************
+// ***************************************************************************************************************
+
+// Hand the cache bitmap handles FirstHandle .. FirstHandle + Handles - 1.  Leave out the ones the application
+// sets up itself, ROM fonts (16 - 31) and, on BT81x, the CoPro scratch handle (15).
+void Cache_Init(BitmapCache *Cache, EveContext *ctx, RamGHeap *Heap, uint8_t FirstHandle, uint8_t Handles)
+{
+  memset(Cache, 0, sizeof(BitmapCache));
+  Cache->ctx = ctx;
+  Cache->Heap = Heap;
+  if (FirstHandle > 31)
+    FirstHandle = 31;
+  if (Handles > 32 - FirstHandle)
+    Handles = 32 - FirstHandle;
+  Cache->FirstHandle = FirstHandle;
+  Cache->Handles = Handles;
+  Cache->Frame = 1;                                        // HandleFrame 0 is "not set up"
+}
+
+// Have bitmaps in host memory go through Upload rather than straight into RAM_G.  The cache itself never
+// compresses anything, so it needs neither eve_asset.c nor eve_deflate.c unless you opt in here.
+void Cache_SetUploader(BitmapCache *Cache, CacheUploader Upload, void *User)
+{
+  Cache->Upload = Upload;
+  Cache->UploadUser = User;
+}
+
+static CacheEntry *Add(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height)
+{
+  CacheEntry *e;
+
+  if (Find(Cache, Id) || Cache->Count == EVE_CACHE_BITMAPS || !RamG_BitmapSize(Format, Width, Height))
+    return NULL;
+  e = &Cache->Entries[Cache->Count++];
+  memset(e, 0, sizeof(CacheEntry));
+  e->Id = Id;
+  e->Format = Format;
+  e->Width = Width;
+  e->Height = Height;
+  e->Handle = CACHE_NO_HANDLE;
+  return e;
+}
+
+// A bitmap held in host memory, written to RAM_G as it is or through the Cache_SetUploader() callback
+bool Cache_AddMemory(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, const uint8_t *Data)
+{
+  CacheEntry *e = Add(Cache, Id, Format, Width, Height);
+
+  if (e)
+    e->Data = Data;
+  return e != NULL;
+}
+
+// A bitmap Reader fetches a piece at a time - from a file or an SD card perhaps
+bool Cache_AddReader(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, CacheReader Reader, void *User)
+{
+  CacheEntry *e = Add(Cache, Id, Format, Width, Height);
+
+  if (e)
+  {
+    e->Reader = Reader;
+    e->ReaderUser = User;
+  }
+  return e != NULL;
+}
+
+// A bitmap in the flash attached to a BT81x, copied with CMD_FLASHREAD.  FlashAddr must be 64 byte aligned and
+// the flash in full speed mode (Eve_FlashFast()).
+bool Cache_AddFlash(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, uint32_t FlashAddr)
+{
+  CacheEntry *e;
+
+  if (FlashAddr & 63)
+    return false;
+  e = Add(Cache, Id, Format, Width, Height);
+  if (e)
+    e->FlashAddr = FlashAddr;
+  return e != NULL;
+}
+
+// ***************************************************************************************************************
+// *** Residency *************************************************************************************************
+// ***************************************************************************************************************
+
+static void Unload(BitmapCache *Cache, CacheEntry *e)
+{
+  RamG_Free(Cache->Heap, e->Block);
+  e->Block = 0;
+  if (e->Handle != CACHE_NO_HANDLE)
+  {
+    Cache->HandleOwner[e->Handle] = 0;
+    e->Handle = CACHE_NO_HANDLE;
+  }
+}
+
+static bool LoadData(BitmapCache *Cache, CacheEntry *e)
+{
+  uint32_t Addr = RamG_Addr(Cache->Heap, e->Block), Size = RamG_BitmapSize(e->Format, e->Width, e->Height), Done, n;
+
+  if (e->Data && Cache->Upload)
+    return Cache->Upload(Cache->UploadUser, Cache->ctx, Addr, e->Data, Size);
+  if (e->Data)
+  {
+    Eve_WriteBlockRAM(Cache->ctx, Addr, e->Data, Size);
+    return true;
+  }
+
+  if (e->Reader)
+  {
+    for (Done = 0; Done < Size; Done += n)
+    {
+      n = Size - Done;
+      if (n > sizeof(Cache->Chunk))
+        n = sizeof(Cache->Chunk);
+      if (!e->Reader(e->ReaderUser, e->Id, Done, Cache->Chunk, n))
+        return false;
+      Eve_WriteBlockRAM(Cache->ctx, Addr + Done, Cache->Chunk, n);
+    }
+    return true;
+  }
+
+  Eve_Cmd_FlashRead(Cache->ctx, Addr, e->FlashAddr, RamG_Size(Cache->Heap, e->Block));    // Ahead of anything that draws it
+  return true;
+}
+
+// Make room for e, evicting the least recently used bitmaps that are not pinned, and load it
+static bool Load(BitmapCache *Cache, CacheEntry *e)
+{
+  CacheEntry *Victim;
+  uint16_t i;
+
+  while ((e->Block = RamG_AllocBitmap(Cache->Heap, e->Format, e->Width, e->Height, 0)) == 0)
+  {
+    Victim = NULL;
+    for (i = 0; i < Cache->Count; i++)
+      if (Cache->Entries[i].Block && !IsPinned(Cache, &Cache->Entries[i]) && (!Victim || Cache->Entries[i].LastUsed < Victim->LastUsed))
+        Victim = &Cache->Entries[i];
+    if (!Victim)
+    {
+      Cache->Stats.Failures++;
+      return false;
+    }
+    Unload(Cache, Victim);
+    Cache->Stats.Evictions++;
+  }
+
+  if (!LoadData(Cache, e))
+  {
+    Unload(Cache, e);
+    Cache->Stats.Failures++;
+    return false;
+  }
+  Cache->Stats.LoadedBytes += RamG_Size(Cache->Heap, e->Block);
+  return true;
+}
+
+// A handle for e - its own if it has one, a free one, or the one least recently drawn with that is not
+// already in this frame
+static uint8_t TakeHandle(BitmapCache *Cache, CacheEntry *e)
+{
+  CacheEntry *Owner, *Oldest = NULL;
+  uint8_t h, Pick = CACHE_NO_HANDLE;
+
+  if (e->Handle != CACHE_NO_HANDLE)
+    return e->Handle;
+  for (h = Cache->FirstHandle; h < Cache->FirstHandle + Cache->Handles; h++)
+  {
+    if (!Cache->HandleOwner[h])
+    {
+      Pick = h;
+      break;
+    }
+    Owner = &Cache->Entries[Cache->HandleOwner[h] - 1];
+    if (Owner->Frame != Cache->Frame && (!Oldest || Owner->LastUsed < Oldest->LastUsed))
+    {
+      Oldest = Owner;
+      Pick = h;
+    }
+  }
+  if (Pick == CACHE_NO_HANDLE)
+    return CACHE_NO_HANDLE;
+  if (Cache->HandleOwner[Pick])
+    Cache->Entries[Cache->HandleOwner[Pick] - 1].Handle = CACHE_NO_HANDLE;
+  Cache->HandleOwner[Pick] = (uint16_t)(e - Cache->Entries) + 1;
+  Cache->HandleFrame[Pick] = 0;                            // Set up for its new owner
+  e->Handle = Pick;
+  return Pick;
+}
+
+// ***************************************************************************************************************
+// *** Drawing ***************************************************************************************************
+// ***************************************************************************************************************
+
+// Call along with Eve_FrameBegin()
+void Cache_FrameBegin(BitmapCache *Cache)
+{
+  uint16_t i;
+
+  Cache->Frame++;
+  for (i = 0; i < Cache->Count; i++)                       // Unpin what has gone off the screen
+    PinBlock(Cache, &Cache->Entries[i]);
+}
+
+// Make bitmap Id resident, pin it for this frame and select its handle (BITMAP_HANDLE, and Cmd_SetBitmap()
+// the first time in the frame).  Follow with BEGIN(BITMAPS) and VERTEX2F(), or VERTEX2II() with the handle
+// returned.  Returns CACHE_NO_HANDLE, having drawn nothing, if the bitmap is unknown or cannot be loaded, or
+// every handle is already in use in this frame.
+uint8_t Cache_Bitmap(BitmapCache *Cache, uint32_t Id)
+{
+  CacheEntry *e = Find(Cache, Id);
+  uint8_t h;
+
+  if (!e)
+    return CACHE_NO_HANDLE;
+  if (e->Block)
+    Cache->Stats.Hits++;
+  else
+  {
+    Cache->Stats.Misses++;
+    if (!Load(Cache, e))
+      return CACHE_NO_HANDLE;
+  }
+  e->LastUsed = ++Cache->Clock;
+  e->Frame = Cache->Frame;
+  PinBlock(Cache, e);
+
+  if ((h = TakeHandle(Cache, e)) == CACHE_NO_HANDLE)
+  {
+    Cache->Stats.Failures++;
+    return CACHE_NO_HANDLE;
+  }
+  Eve_Send_CMD(Cache->ctx, BITMAP_HANDLE(h));
+  if (Cache->HandleFrame[h] != Cache->Frame)
+  {
+    Eve_Cmd_SetBitmap(Cache->ctx, RamG_Addr(Cache->Heap, e->Block), e->Format, e->Width, e->Height);
+    Cache->HandleFrame[h] = Cache->Frame;
+  }
+  return h;
+}
+
+// Load the bitmaps the next page will want while this one is on screen.  Pinned bitmaps are left alone, so
+// this evicts nothing the current frames draw.  Returns the number loaded.
+uint16_t Cache_Prefetch(BitmapCache *Cache, const uint32_t *Ids, uint16_t Count)
+{
+  CacheEntry *e;
+  uint16_t i, Loaded = 0;
+
+  for (i = 0; i < Count; i++)
+  {
+    if ((e = Find(Cache, Ids[i])) == NULL)
+      continue;
+    if (!e->Block)
+    {
+      if (!Load(Cache, e))
+        continue;
+      Cache->Stats.Prefetches++;
+      Loaded++;
+    }
+    e->LastUsed = ++Cache->Clock;
+  }
+  return Loaded;
+}
+
+bool Cache_IsResident(const BitmapCache *Cache, uint32_t Id)
+{
+  uint16_t i;
+
+  for (i = 0; i < Cache->Count; i++)
+    if (Cache->Entries[i].Id == Id)
+      return Cache->Entries[i].Block != 0;
+  return false;
+}
+
+// Drop a bitmap from RAM_G now - it is loaded again the next time it is drawn.  Ignored while it is pinned.
+void Cache_Evict(BitmapCache *Cache, uint32_t Id)
+{
+  CacheEntry *e = Find(Cache, Id);
+
+  if (e && e->Block && !IsPinned(Cache, e))
+  {
+    Unload(Cache, e);
+    Cache->Stats.Evictions++;
+  }
+}
+
+void Cache_GetStats(const BitmapCache *Cache, CacheStats *Stats)
+{
+  *Stats = Cache->Stats;
+}
+
+void Cache_ResetStats(BitmapCache *Cache)
+{
+  memset(&Cache->Stats, 0, sizeof(CacheStats));
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Bitmap cache - see eve_cache.c.
+//
+// Keeps as many bitmaps in RAM_G as fit and loads the rest when they are drawn.  Each bitmap is registered
+// once under an ID of your choosing along with where its data lives: in host memory, behind a reader
+// callback (a file, an SD card) or in the flash attached to a BT81x.  Cache_Bitmap() then makes the bitmap
+// resident, evicting the least recently drawn ones to make room, gives it one of the bitmap handles the cache
+// owns and selects that handle in the display list.  RAM_G comes from a RamGHeap (eve_ramg.h), which the cache
+// can share with the rest of the application.
+//
+// Call Cache_FrameBegin() as each frame is started.  Bitmaps drawn in any frame that can still reach the screen
+// are pinned and never evicted.  Cache_Prefetch() loads the next page's bitmaps ahead of time.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+#include "eve_ramg.h"
+
+#define CACHE_NO_HANDLE    0xFF
+
+// Reads Size bytes of bitmap Id from Offset into Buffer.  Returns false if it could not.
+typedef bool (*CacheReader)(void *User, uint32_t Id, uint32_t Offset, uint8_t *Buffer, uint32_t Size);
+
+// Puts Size bytes of Data into RAM_G at Dest some cheaper way than writing them as they are - Asset_Upload()
+// deflating them on the host, say.  Returns false if it could not.
+typedef bool (*CacheUploader)(void *User, EveContext *ctx, uint32_t Dest, const uint8_t *Data, uint32_t Size);
+
+typedef struct
+{
+  uint32_t Id;
+  uint16_t Format;
+  uint16_t Width;
+  uint16_t Height;
+  const uint8_t *Data;                   // In host memory, or
+  CacheReader Reader;                    // read from the host, or
+  void *ReaderUser;
+  uint32_t FlashAddr;                    // in flash when neither is set
+  RamGHandle Block;                      // 0 when not resident
+  uint8_t Handle;                        // Bitmap handle, CACHE_NO_HANDLE when it has none
+  uint32_t LastUsed;                     // Cache clock when last drawn or prefetched
+  uint32_t Frame;                        // Frame it was last drawn in
+} CacheEntry;
+
+typedef struct
+{
+  uint32_t Hits;
+  uint32_t Misses;
+  uint32_t Evictions;
+  uint32_t Prefetches;                   // Loaded ahead by Cache_Prefetch()
+  uint32_t Failures;                     // No room even with everything unpinned evicted, or the load failed
+  uint64_t LoadedBytes;
+} CacheStats;
+
+typedef struct
+{
+  EveContext *ctx;
+  RamGHeap *Heap;
+  CacheEntry Entries[EVE_CACHE_BITMAPS];
+  uint16_t Count;
+  uint8_t FirstHandle;
+  uint8_t Handles;
+  uint16_t HandleOwner[32];              // Entry index + 1, 0 for a free handle
+  uint32_t HandleFrame[32];              // Frame the handle was last set up in
+  uint32_t Clock;
+  uint32_t Frame;
+  CacheUploader Upload;                  // For bitmaps in host memory - NULL to write them as they are
+  void *UploadUser;
+  CacheStats Stats;
+  uint8_t Chunk[EVE_CMD_STAGE_SIZE];     // Bounce buffer for CacheReader loads
+} BitmapCache;
+
+void Cache_Init(BitmapCache *Cache, EveContext *ctx, RamGHeap *Heap, uint8_t FirstHandle, uint8_t Handles);
+void Cache_SetUploader(BitmapCache *Cache, CacheUploader Upload, void *User);
+bool Cache_AddMemory(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, const uint8_t *Data);
+bool Cache_AddReader(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, CacheReader Reader, void *User);
+bool Cache_AddFlash(BitmapCache *Cache, uint32_t Id, uint16_t Format, uint16_t Width, uint16_t Height, uint32_t FlashAddr);
+void Cache_FrameBegin(BitmapCache *Cache);
+uint8_t Cache_Bitmap(BitmapCache *Cache, uint32_t Id);
+uint16_t Cache_Prefetch(BitmapCache *Cache, const uint32_t *Ids, uint16_t Count);
+bool Cache_IsResident(const BitmapCache *Cache, uint32_t Id);
+void Cache_Evict(BitmapCache *Cache, uint32_t Id);
+void Cache_GetStats(const BitmapCache *Cache, CacheStats *Stats);
+void Cache_ResetStats(BitmapCache *Cache);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,350 @@
+// Touch calibration that is kept - see eve_calib.h.
+//
+// The transform maps a raw reading (x, y) to the screen as X = A x + B y + C and Y = D x + E y + F.  With
+// five or more points that is overdetermined, so each row is the least squares fit: the readings are taken
+// relative to their mean, which leaves a 2x2 set of normal equations for A and B (D and E) that is well
+// conditioned for raw values in the hundreds, and C (F) is whatever puts the mean reading on the mean target.
+//
+// The record a CalibStore keeps, little endian:
+//
+//   0  Magic "EVTC"       4  Version            6  Points         8  Signature
+//  12  Error             14  0                 16  A .. F        40  Check - FNV-1a of bytes 0 - 39
+
+#include <stdio.h>
+#include "eve_calib.h"
+#include "eve_nomalloc.h"
+
+#define CALIB_MAGIC      0x43545645              // "EVTC"
+#define CALIB_VERSION    1
+#define CALIB_UNTOUCHED  0x80000000              // REG_TOUCH_DIRECT_XY bit 31
+#define CALIB_POLL_MS    10                      // Between looks for a finger
+#define CALIB_SAMPLE_MS  5                       // Between readings of one that is down
+
+#define Delay(ctx, ms)   ((ctx)->Hal.Delay((ctx)->Hal.User, (ms)))
+
+// Where the targets go, in tenths of the screen.  Corners and centre first - any five of these are enough.
+static const uint8_t Where[CALIB_MAX_POINTS][2] =
+{
+  { 1, 1 }, { 9, 1 }, { 9, 9 }, { 1, 9 }, { 5, 5 }, { 5, 1 }, { 9, 5 }, { 5, 9 }, { 1, 5 }
+};
+
+#define SECTOR_SIZE 4096                         // Calib_FlashStore() writes whole sectors
+
+static uint32_t Fnv(uint32_t Hash, const uint8_t *Data, uint32_t Size)
+{
+  while (Size--)
+    Hash = (Hash ^ *Data++) * 16777619u;
+  return Hash;
+}
+
+static void Put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void Put32(uint8_t *p, uint32_t v)
+{
+  Put16(p, (uint16_t)v);
+  Put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t Get16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t Get32(const uint8_t *p)
+{
+  return Get16(p) | ((uint32_t)Get16(p + 2) << 16);
+}
+
+// Identifies the panel a calibration was made on - the timing and touch controller FT81x_Init() was given
+uint32_t Calib_Signature(EveContext *ctx)
+{
+  uint8_t Panel[17];
+
+  Put32(Panel, ctx->Width);
+  Put32(Panel + 4, ctx->Height);
+  Put32(Panel + 8, ctx->HOffset);
+  Put32(Panel + 12, ctx->VOffset);
+  Panel[16] = ctx->Touch;
+  return Fnv(2166136261u, Panel, sizeof(Panel));
+}
+
+static int32_t Fixed(double v)
+{
+  return (int32_t)(v * 65536.0 + (v < 0 ? -0.5 : 0.5));
+}
+
+// Fit one row of the transform, giving the three coefficients and the worst miss in pixels
+static double FitRow(const double *Screen, const double *Rx, const double *Ry, uint8_t Points, double Mx, double My,
+                     double Sxx, double Syy, double Sxy, double Det, int32_t *Row)
+{
+  double Ms = 0, Sxs = 0, Sys = 0, a, b, c, Miss, Worst = 0;
+  uint8_t i;
+
+  for (i = 0; i < Points; i++)
+    Ms += Screen[i];
+  Ms /= Points;
+  for (i = 0; i < Points; i++)
+  {
+    Sxs += (Rx[i] - Mx) * (Screen[i] - Ms);
+    Sys += (Ry[i] - My) * (Screen[i] - Ms);
+  }
+  a = (Sxs * Syy - Sys * Sxy) / Det;
+  b = (Sys * Sxx - Sxs * Sxy) / Det;
+  c = Ms - a * Mx - b * My;
+
+  for (i = 0; i < Points; i++)
+  {
+    Miss = a * Rx[i] + b * Ry[i] + c - Screen[i];
+    if (Miss < 0)
+      Miss = -Miss;
+    if (Miss > Worst)
+      Worst = Miss;
+  }
+  Row[0] = Fixed(a);
+  Row[1] = Fixed(b);
+  Row[2] = Fixed(c);
+  return Worst;
+}
+
+// Least squares fit of Points readings to their targets.  False if the readings do not span the panel.
+static bool Fit(const double *Sx, const double *Sy, const double *Rx, const double *Ry, uint8_t Points, CalibData *Result)
+{
+  double Mx = 0, My = 0, Sxx = 0, Syy = 0, Sxy = 0, Det, WorstX, WorstY;
+  uint8_t i;
+
+  for (i = 0; i < Points; i++)
+  {
+    Mx += Rx[i];
+    My += Ry[i];
+  }
+  Mx /= Points;
+  My /= Points;
+  for (i = 0; i < Points; i++)
+  {
+    Sxx += (Rx[i] - Mx) * (Rx[i] - Mx);
+    Syy += (Ry[i] - My) * (Ry[i] - My);
+    Sxy += (Rx[i] - Mx) * (Ry[i] - My);
+  }
+  Det = Sxx * Syy - Sxy * Sxy;
+  if (Det < 1.0)                                 // All in a line, or all the same
+    return false;
+
+  WorstX = FitRow(Sx, Rx, Ry, Points, Mx, My, Sxx, Syy, Sxy, Det, &Result->Transform[0]);
+  WorstY = FitRow(Sy, Rx, Ry, Points, Mx, My, Sxx, Syy, Sxy, Det, &Result->Transform[3]);
+  if (WorstY > WorstX)
+    WorstX = WorstY;
+  Result->Error = WorstX * 16 > 0xFFFF ? 0xFFFF : (uint16_t)(WorstX * 16);
+  Result->Points = Points;
+  return true;
+}
+
+static void Target(EveContext *ctx, uint32_t X, uint32_t Y, uint8_t n)
+{
+  char Num[2] = { (char)('1' + n), 0 };
+
+  Eve_Send_CMD(ctx, CMD_DLSTART);
+  Eve_Send_CMD(ctx, CLEAR_COLOR_RGB(0, 0, 0));
+  Eve_Send_CMD(ctx, CLEAR(1, 1, 1));
+  Eve_Send_CMD(ctx, COLOR_RGB(255, 0, 0));
+  Eve_Send_CMD(ctx, POINT_SIZE(20 * 16));
+  Eve_Send_CMD(ctx, BEGIN(POINTS));
+  Eve_Send_CMD(ctx, VERTEX2F(X * 16, Y * 16));
+  Eve_Send_CMD(ctx, END());
+  Eve_Send_CMD(ctx, COLOR_RGB(255, 255, 255));
+  Eve_Cmd_Text(ctx, ctx->Width / 2 + ctx->HOffset, ctx->Height / 3 + ctx->VOffset, 27, OPT_CENTER, "Calibrating");
+  Eve_Cmd_Text(ctx, ctx->Width / 2 + ctx->HOffset, ctx->Height * 2 / 3 + ctx->VOffset, 27, OPT_CENTER, "Hold each dot until it moves");
+  Eve_Cmd_Text(ctx, X, Y, 27, OPT_CENTER, Num);
+  Eve_Send_CMD(ctx, DISPLAY());
+  Eve_Send_CMD(ctx, CMD_SWAP);
+  Eve_UpdateFIFO(ctx);
+  Eve_Wait4CoProFIFOEmpty(ctx);
+}
+
+// Wait for a finger and average up to Samples raw readings while it stays down, then wait for it to lift
+static void Sample(EveContext *ctx, uint8_t Samples, double *Rx, double *Ry)
+{
+  uint32_t Raw, SumX = 0, SumY = 0, n = 0;
+
+  while ((Raw = Eve_rd32(ctx, REG_TOUCH_DIRECT_XY + RAM_REG)) & CALIB_UNTOUCHED)
+    Delay(ctx, CALIB_POLL_MS);
+  while (!(Raw & CALIB_UNTOUCHED))
+  {
+    SumX += (Raw >> 16) & 0x03FF;
+    SumY += Raw & 0x03FF;
+    if (++n == Samples)
+      break;
+    Delay(ctx, CALIB_SAMPLE_MS);
+    Raw = Eve_rd32(ctx, REG_TOUCH_DIRECT_XY + RAM_REG);
+  }
+  *Rx = (double)SumX / n;
+  *Ry = (double)SumY / n;
+
+  while (!(Eve_rd32(ctx, REG_TOUCH_DIRECT_XY + RAM_REG) & CALIB_UNTOUCHED))
+    Delay(ctx, CALIB_POLL_MS);
+}
+
+// An interactive calibration with Points targets (CALIB_MIN_POINTS - CALIB_MAX_POINTS), each the average of
+// Samples readings.  The fit is applied and left in Result for Calib_Save().  False if it could not be made.
+bool Calib_Run(EveContext *ctx, uint8_t Points, uint8_t Samples, CalibData *Result)
+{
+  double Sx[CALIB_MAX_POINTS], Sy[CALIB_MAX_POINTS], Rx[CALIB_MAX_POINTS], Ry[CALIB_MAX_POINTS];
+  uint8_t i;
+
+  if (Points < CALIB_MIN_POINTS || Points > CALIB_MAX_POINTS || Samples == 0 || Samples > CALIB_MAX_SAMPLES)
+    return false;
+
+  for (i = 0; i < Points; i++)
+  {
+    Sx[i] = ctx->Width * Where[i][0] / 10 + ctx->HOffset;
+    Sy[i] = ctx->Height * Where[i][1] / 10 + ctx->VOffset;
+    Target(ctx, (uint32_t)Sx[i], (uint32_t)Sy[i], i);
+    Sample(ctx, Samples, &Rx[i], &Ry[i]);
+  }
+  if (!Fit(Sx, Sy, Rx, Ry, Points, Result))
+    return false;
+  Result->Signature = Calib_Signature(ctx);
+  Calib_Apply(ctx, Result);
+  return true;
+}
+
+// Load REG_TOUCH_TRANSFORM_A - F in one write
+void Calib_Apply(EveContext *ctx, const CalibData *Data)
+{
+  uint8_t Regs[24];
+  uint8_t i;
+
+  for (i = 0; i < 6; i++)
+    Put32(Regs + 4 * i, (uint32_t)Data->Transform[i]);
+  Eve_WriteBlockRAM(ctx, REG_TOUCH_TRANSFORM_A + RAM_REG, Regs, sizeof(Regs));
+}
+
+bool Calib_Save(EveContext *ctx, const CalibStore *Store, const CalibData *Data)
+{
+  uint8_t Record[CALIB_RECORD_SIZE];
+  uint8_t i;
+
+  (void)ctx;
+  Put32(Record, CALIB_MAGIC);
+  Put16(Record + 4, CALIB_VERSION);
+  Put16(Record + 6, Data->Points);
+  Put32(Record + 8, Data->Signature);
+  Put16(Record + 12, Data->Error);
+  Put16(Record + 14, 0);
+  for (i = 0; i < 6; i++)
+    Put32(Record + 16 + 4 * i, (uint32_t)Data->Transform[i]);
+  Put32(Record + 40, Fnv(2166136261u, Record, 40));
+  return Store->Save(Store->User, Record, sizeof(Record));
+}
+
+// Read back what Calib_Save() kept.  False if there is nothing, it is damaged or it was made on another panel.
+bool Calib_Load(EveContext *ctx, const CalibStore *Store, CalibData *Data)
+{
+  uint8_t Record[CALIB_RECORD_SIZE];
+  uint8_t i;
+
+  if (!Store->Load(Store->User, Record, sizeof(Record)))
+    return false;
+  if (Get32(Record) != CALIB_MAGIC || Get16(Record + 4) != CALIB_VERSION || Get32(Record + 40) != Fnv(2166136261u, Record, 40))
+    return false;
+  if (Get32(Record + 8) != Calib_Signature(ctx))
+    return false;
+
+  Data->Points = Get16(Record + 6);
+  Data->Signature = Get32(Record + 8);
+  Data->Error = Get16(Record + 12);
+  for (i = 0; i < 6; i++)
+    Data->Transform[i] = (int32_t)Get32(Record + 16 + 4 * i);
+  return true;
+}
+
+// Call after FT81x_Init().  True if a calibration for this panel was found and applied - run Calib_Run() if not.
+bool Calib_Restore(EveContext *ctx, const CalibStore *Store)
+{
+  CalibData Data;
+
+  if (!Calib_Load(ctx, Store, &Data))
+    return false;
+  Calib_Apply(ctx, &Data);
+  return true;
+}
+
+// *** A file on the host **************************************************************************************
+
+static bool FileLoad(void *User, uint8_t *Record, uint32_t Size)
+{
+  FILE *f = fopen((const char *)User, "rb");
+  bool Ok;
+
+  if (!f)
+    return false;
+  Ok = fread(Record, 1, Size, f) == Size;
+  fclose(f);
+  return Ok;
+}
+
+static bool FileSave(void *User, const uint8_t *Record, uint32_t Size)
+{
+  FILE *f = fopen((const char *)User, "wb");
+  bool Ok;
+
+  if (!f)
+    return false;
+  Ok = fwrite(Record, 1, Size, f) == Size;
+  return fclose(f) == 0 && Ok;
+}
+
+void Calib_FileStore(CalibStore *Store, const char *Path)
+{
+  Store->Load = FileLoad;
+  Store->Save = FileSave;
+  Store->User = (void *)Path;
+}
+
+// *** A sector of the BT81x flash *****************************************************************************
+// The record is read back through RAM_G_WORKING with CMD_FLASHREAD.  Saving rewrites the whole sector, padded
+// with 0xFF by CMD_MEMSET in RAM_G_WORKING, so keep the sector for this alone - the last one of the flash is a
+// good choice.
+
+static bool FlashReady(EveContext *ctx)
+{
+  return Eve_rd8(ctx, REG_FLASH_STATUS + RAM_REG) == FLASH_STATUS_FULL || Eve_FlashFast(ctx);
+}
+
+static bool FlashLoad(void *User, uint8_t *Record, uint32_t Size)
+{
+  CalibFlash *Flash = (CalibFlash *)User;
+  EveContext *ctx = Flash->ctx;
+
+  if (!FlashReady(ctx))
+    return false;
+  Eve_Cmd_FlashRead(ctx, RAM_G_WORKING, Flash->Addr, (Size + 63) & ~63u);
+  if (!Eve_WaitCoProMark(ctx, Eve_CoProMark(ctx)))
+    return false;
+  Eve_ReadBlockRAM(ctx, RAM_G_WORKING, Record, Size);
+  return true;
+}
+
+static bool FlashSave(void *User, const uint8_t *Record, uint32_t Size)
+{
+  CalibFlash *Flash = (CalibFlash *)User;
+  EveContext *ctx = Flash->ctx;
+
+  if (!FlashReady(ctx))
+    return false;
+  Eve_WriteBlockRAM(ctx, RAM_G_WORKING, Record, Size);
+  Eve_Cmd_Memset(ctx, RAM_G_WORKING + Size, 0xFF, SECTOR_SIZE - Size);
+  Eve_Cmd_FlashUpdate(ctx, Flash->Addr, RAM_G_WORKING, SECTOR_SIZE);
+  return Eve_WaitCoProMark(ctx, Eve_CoProMark(ctx));
+}
+
+// Flash->Addr must be 4K aligned and Flash must stay around as long as Store does
+void Calib_FlashStore(CalibStore *Store, CalibFlash *Flash)
+{
+  Store->Load = FlashLoad;
+  Store->Save = FlashSave;
+  Store->User = Flash;
+}
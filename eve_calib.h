@@ -0,0 +1,60 @@
+#pragma once
+
+// Touch calibration that is kept - see eve_calib.c.
+//
+// Calib_Run() shows CALIB_MIN_POINTS or more targets, averages several raw readings at each and fits the touch
+// transform to all of them by least squares, so one bad tap or a noisy resistive panel does not skew the whole
+// screen the way the three point Calibrate_Manual() does.  Calib_Save() puts the result somewhere that survives
+// a power cycle through a CalibStore - a file on the host and a sector of the BT81x flash are provided - and at
+// the next boot Calib_Restore() checks it belongs to the same panel and loads all six REG_TOUCH_TRANSFORM
+// registers in one SPI write.  Nobody has to tap dots again until the panel changes.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+
+#define CALIB_MIN_POINTS   5
+#define CALIB_MAX_POINTS   9
+#define CALIB_MAX_SAMPLES  16                    // Raw readings averaged at each point
+#define CALIB_RECORD_SIZE  44                    // Bytes a CalibStore is given
+
+typedef struct
+{
+  int32_t Transform[6];                  // REG_TOUCH_TRANSFORM_A .. F, 16.16
+  uint32_t Signature;                    // Panel it was made on - Calib_Signature()
+  uint16_t Points;                       // Points it was fitted to
+  uint16_t Error;                        // Furthest any point lies from the fit, 1/16 pixel
+} CalibData;
+
+// Somewhere to keep a CALIB_RECORD_SIZE byte record.  Load returns false if there is nothing there.
+typedef struct
+{
+  bool (*Load)(void *User, uint8_t *Record, uint32_t Size);
+  bool (*Save)(void *User, const uint8_t *Record, uint32_t Size);
+  void *User;
+} CalibStore;
+
+// User for Calib_FlashStore() - the record lives at the start of the 4K flash sector at Addr
+typedef struct
+{
+  EveContext *ctx;
+  uint32_t Addr;
+} CalibFlash;
+
+uint32_t Calib_Signature(EveContext *ctx);
+bool Calib_Run(EveContext *ctx, uint8_t Points, uint8_t Samples, CalibData *Result);
+void Calib_Apply(EveContext *ctx, const CalibData *Data);
+bool Calib_Save(EveContext *ctx, const CalibStore *Store, const CalibData *Data);
+bool Calib_Load(EveContext *ctx, const CalibStore *Store, CalibData *Data);
+bool Calib_Restore(EveContext *ctx, const CalibStore *Store);
+
+void Calib_FileStore(CalibStore *Store, const char *Path);
+void Calib_FlashStore(CalibStore *Store, CalibFlash *Flash);
+
+#ifdef __cplusplus
+}
+#endif
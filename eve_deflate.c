@@ -0,0 +1,527 @@
+// Deflate compressor for CMD_INFLATE - see eve_deflate.h.
+//
+// LZ77 over a 32K window with hash chains and one step of lazy matching, then each block of symbols is
+// coded with its own (dynamic) Huffman tables - RFC 1951 section 3.2.7.  A block that would come out bigger
+// than the data it holds is sent stored instead, so incompressible data costs 5 bytes per 64K.
+// The output is wrapped as a zlib stream - RFC 1950: 2 byte header, the deflate data, Adler-32 of the input.
+//
+// Nothing clever: no optimal parsing and no block splitting heuristics.  UI artwork with flat areas and
+// gradients still typically ends up between 3 and 6 times smaller.
+
+#include <stdlib.h>
+#include <string.h>
+#include "eve_deflate.h"
+#include "eve_nomalloc.h"
+
+#define WINDOW_SIZE      32768
+#define WINDOW_MASK      (WINDOW_SIZE - 1)
+#define HASH_BITS        15
+#define HASH_SIZE        (1 << HASH_BITS)
+#define MIN_MATCH        3
+#define MAX_MATCH        258
+#define MAX_CHAIN        128             // Candidates looked at per position
+#define NICE_MATCH       128             // Stop looking once a match is this long
+#define BLOCK_SYMBOLS    16384           // Symbols per block before new tables are worth it
+#define STORED_MAX       65535
+
+#define LITLEN_CODES     286
+#define DIST_CODES       30
+#define CODELEN_CODES    19
+
+// Length codes 257..285 - base length and extra bits, RFC 1951 section 3.2.5
+static const uint16_t LenBase[29] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LenExtra[29] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DistBase[30] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+  4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DistExtra[30] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t CodeLenOrder[CODELEN_CODES] =
+{
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+typedef struct
+{
+  uint8_t *Out;
+  uint32_t Size;
+  uint32_t Pos;
+  uint64_t Bits;
+  uint8_t Count;
+  int Overflow;
+} BitWriter;
+
+typedef struct
+{
+  uint16_t Code[LITLEN_CODES];           // Bit reversed, ready to go out LSB first
+  uint8_t Len[LITLEN_CODES];
+} HuffCode;
+
+// ***************************************************************************************************************
+// *** Output ****************************************************************************************************
+// ***************************************************************************************************************
+
+static void PutBits(BitWriter *w, uint32_t Value, uint8_t Count)
+{
+  w->Bits |= (uint64_t)Value << w->Count;
+  w->Count += Count;
+  while (w->Count >= 8)
+  {
+    if (w->Pos < w->Size)
+      w->Out[w->Pos++] = (uint8_t)w->Bits;
+    else
+      w->Overflow = 1;
+    w->Bits >>= 8;
+    w->Count -= 8;
+  }
+}
+
+static void AlignByte(BitWriter *w)
+{
+  if (w->Count)
+    PutBits(w, 0, 8 - w->Count);
+}
+
+static void PutByte(BitWriter *w, uint8_t b)
+{
+  PutBits(w, b, 8);
+}
+
+// ***************************************************************************************************************
+// *** Huffman codes *********************************************************************************************
+// ***************************************************************************************************************
+
+// Code lengths for the given symbol frequencies, none longer than Limit.  Plain Huffman first - if that goes
+// over the limit the frequencies are flattened and it is tried again, which costs very little in practice.
+// At least two symbols always get a code, so every code is complete.
+static void BuildLengths(const uint32_t *Freq, int n, int Limit, uint8_t *Len)
+{
+  uint32_t Weight[2 * LITLEN_CODES], f[LITLEN_CODES];
+  int16_t Parent[2 * LITLEN_CODES];
+  int Leaf[LITLEN_CODES];
+  int Leaves, Nodes, i, j, a, b, Depth, Max;
+  int Done = 0;
+
+  for (i = 0; i < n; i++)
+    f[i] = Freq[i];
+
+  while (!Done)
+  {
+    memset(Len, 0, n);
+    Leaves = 0;
+    for (i = 0; i < n; i++)
+      if (f[i])
+        Leaf[Leaves++] = i;
+
+    if (Leaves < 2)                                                // Deflate wants at least two codes
+    {
+      a = Leaves ? Leaf[0] : 0;
+      Len[a] = 1;
+      Len[a ? 0 : 1] = 1;
+      return;
+    }
+
+    for (i = 0; i < Leaves; i++)
+    {
+      Weight[i] = f[Leaf[i]];
+      Parent[i] = -1;
+    }
+    Nodes = Leaves;
+    for (;;)
+    {
+      a = b = -1;                                                  // Two lightest nodes without a parent
+      for (j = 0; j < Nodes; j++)
+      {
+        if (Parent[j] != -1)
+          continue;
+        if (a < 0 || Weight[j] < Weight[a])
+        {
+          b = a;
+          a = j;
+        }
+        else if (b < 0 || Weight[j] < Weight[b])
+          b = j;
+      }
+      if (b < 0)
+        break;                                                     // Only the root is left
+      Weight[Nodes] = Weight[a] + Weight[b];
+      Parent[Nodes] = -1;
+      Parent[a] = Parent[b] = (int16_t)Nodes;
+      Nodes++;
+    }
+
+    Max = 0;
+    for (i = 0; i < Leaves; i++)
+    {
+      Depth = 0;
+      for (j = i; Parent[j] != -1; j = Parent[j])
+        Depth++;
+      Len[Leaf[i]] = (uint8_t)Depth;
+      if (Depth > Max)
+        Max = Depth;
+    }
+
+    Done = Max <= Limit;
+    for (i = 0; i < n; i++)
+      if (f[i])
+        f[i] = (f[i] >> 1) | 1;
+  }
+}
+
+// Canonical codes from the lengths - RFC 1951 section 3.2.2
+static void BuildCodes(HuffCode *h, int n)
+{
+  uint16_t Count[16] = { 0 }, Next[16];
+  uint16_t Code = 0, c, r;
+  int i, b;
+
+  for (i = 0; i < n; i++)
+    Count[h->Len[i]]++;
+  Count[0] = 0;
+  for (b = 1; b < 16; b++)
+  {
+    Code = (Code + Count[b - 1]) << 1;
+    Next[b] = Code;
+  }
+  for (i = 0; i < n; i++)
+  {
+    if (!h->Len[i])
+      continue;
+    c = Next[h->Len[i]]++;
+    for (r = 0, b = 0; b < h->Len[i]; b++)                         // Huffman codes go out MSB first
+      r = (r << 1) | ((c >> b) & 1);
+    h->Code[i] = r;
+  }
+}
+
+static void PutSymbol(BitWriter *w, const HuffCode *h, int Symbol)
+{
+  PutBits(w, h->Code[Symbol], h->Len[Symbol]);
+}
+
+// ***************************************************************************************************************
+// *** Blocks ****************************************************************************************************
+// ***************************************************************************************************************
+
+typedef struct
+{
+  uint16_t Lit[BLOCK_SYMBOLS];           // Literal byte, or match length
+  uint16_t Dist[BLOCK_SYMBOLS];          // 0 for a literal
+  uint32_t Count;
+} SymbolBuffer;
+
+static int LenCode(uint32_t Len)
+{
+  int i = 28;
+
+  while (LenBase[i] > Len)
+    i--;
+  return i;
+}
+
+static int DistCode(uint32_t Dist)
+{
+  int i = 29;
+
+  while (DistBase[i] > Dist)
+    i--;
+  return i;
+}
+
+static void PutStored(BitWriter *w, const uint8_t *Data, uint32_t Size, int Final)
+{
+  uint32_t Chunk, i;
+
+  do
+  {
+    Chunk = Size > STORED_MAX ? STORED_MAX : Size;
+    PutBits(w, (Final && Chunk == Size) ? 1 : 0, 1);
+    PutBits(w, 0, 2);
+    AlignByte(w);
+    PutBits(w, Chunk, 16);
+    PutBits(w, ~Chunk & 0xFFFF, 16);
+    for (i = 0; i < Chunk; i++)
+      PutByte(w, Data[i]);
+    Data += Chunk;
+    Size -= Chunk;
+  } while (Size);
+}
+
+// One block with its own tables, falling back to stored if that is smaller.  Raw is the input the symbols cover.
+static void PutBlock(BitWriter *w, const SymbolBuffer *s, const uint8_t *Raw, uint32_t RawSize, int Final)
+{
+  uint32_t LitFreq[LITLEN_CODES] = { 0 }, DistFreq[DIST_CODES] = { 0 }, CLFreq[CODELEN_CODES] = { 0 };
+  HuffCode Lit, Dist, CL;
+  uint8_t Lengths[LITLEN_CODES + DIST_CODES], Rle[LITLEN_CODES + DIST_CODES], RleExtra[LITLEN_CODES + DIST_CODES];
+  BitWriter Start = *w;
+  uint32_t i, n, Run, Rles = 0;
+  int HLit, HDist, HCLen, c;
+
+  for (i = 0; i < s->Count; i++)
+  {
+    if (s->Dist[i])
+    {
+      LitFreq[257 + LenCode(s->Lit[i])]++;
+      DistFreq[DistCode(s->Dist[i])]++;
+    }
+    else
+      LitFreq[s->Lit[i]]++;
+  }
+  LitFreq[256] = 1;                                                // End of block
+
+  memset(&Lit, 0, sizeof(Lit));
+  memset(&Dist, 0, sizeof(Dist));
+  memset(&CL, 0, sizeof(CL));
+  BuildLengths(LitFreq, LITLEN_CODES, 15, Lit.Len);
+  BuildLengths(DistFreq, DIST_CODES, 15, Dist.Len);
+  BuildCodes(&Lit, LITLEN_CODES);
+  BuildCodes(&Dist, DIST_CODES);
+
+  for (HLit = LITLEN_CODES; HLit > 257 && !Lit.Len[HLit - 1]; HLit--)
+    ;
+  for (HDist = DIST_CODES; HDist > 1 && !Dist.Len[HDist - 1]; HDist--)
+    ;
+
+  // The two sets of code lengths run together, squeezed with codes 16 (repeat), 17 and 18 (zeros)
+  memcpy(Lengths, Lit.Len, HLit);
+  memcpy(Lengths + HLit, Dist.Len, HDist);
+  n = HLit + HDist;
+  for (i = 0; i < n; i += Run)
+  {
+    for (Run = 1; i + Run < n && Lengths[i + Run] == Lengths[i]; Run++)
+      ;
+    if (Lengths[i] == 0 && Run >= 11)
+    {
+      if (Run > 138)
+        Run = 138;
+      Rle[Rles] = 18; RleExtra[Rles++] = (uint8_t)(Run - 11);
+    }
+    else if (Lengths[i] == 0 && Run >= 3)
+    {
+      Rle[Rles] = 17; RleExtra[Rles++] = (uint8_t)(Run - 3);
+    }
+    else if (Run >= 4)
+    {
+      Rle[Rles] = Lengths[i]; RleExtra[Rles++] = 0;             // The length itself, then repeats of it
+      Run--;
+      if (Run > 6)
+        Run = 6;
+      Rle[Rles] = 16; RleExtra[Rles++] = (uint8_t)(Run - 3);
+      Run++;
+    }
+    else
+    {
+      Rle[Rles] = Lengths[i]; RleExtra[Rles++] = 0;
+      Run = 1;
+    }
+  }
+  for (i = 0; i < Rles; i++)
+    CLFreq[Rle[i]]++;
+  BuildLengths(CLFreq, CODELEN_CODES, 7, CL.Len);
+  BuildCodes(&CL, CODELEN_CODES);
+  for (HCLen = CODELEN_CODES; HCLen > 4 && !CL.Len[CodeLenOrder[HCLen - 1]]; HCLen--)
+    ;
+
+  // Block header and tables - RFC 1951 section 3.2.7
+  PutBits(w, Final ? 1 : 0, 1);
+  PutBits(w, 2, 2);
+  PutBits(w, HLit - 257, 5);
+  PutBits(w, HDist - 1, 5);
+  PutBits(w, HCLen - 4, 4);
+  for (c = 0; c < HCLen; c++)
+    PutBits(w, CL.Len[CodeLenOrder[c]], 3);
+  for (i = 0; i < Rles; i++)
+  {
+    PutSymbol(w, &CL, Rle[i]);
+    if (Rle[i] == 16)
+      PutBits(w, RleExtra[i], 2);
+    else if (Rle[i] == 17)
+      PutBits(w, RleExtra[i], 3);
+    else if (Rle[i] == 18)
+      PutBits(w, RleExtra[i], 7);
+  }
+
+  for (i = 0; i < s->Count; i++)
+  {
+    if (s->Dist[i])
+    {
+      c = LenCode(s->Lit[i]);
+      PutSymbol(w, &Lit, 257 + c);
+      PutBits(w, s->Lit[i] - LenBase[c], LenExtra[c]);
+      c = DistCode(s->Dist[i]);
+      PutSymbol(w, &Dist, c);
+      PutBits(w, s->Dist[i] - DistBase[c], DistExtra[c]);
+    }
+    else
+      PutSymbol(w, &Lit, s->Lit[i]);
+  }
+  PutSymbol(w, &Lit, 256);
+
+  // Stored costs the data plus 5 bytes a piece - go back and do that if it is smaller
+  if ((w->Pos - Start.Pos) > RawSize + 5 * (RawSize / STORED_MAX + 1))
+  {
+    *w = Start;
+    PutStored(w, Raw, RawSize, Final);
+  }
+}
+
+// ***************************************************************************************************************
+// *** Matching **************************************************************************************************
+// ***************************************************************************************************************
+
+typedef struct
+{
+  int32_t Head[HASH_SIZE];
+  int32_t Prev[WINDOW_SIZE];
+  SymbolBuffer Symbols;
+} Deflater;
+
+static uint32_t Hash(const uint8_t *p)
+{
+  return ((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+static void Insert(Deflater *d, const uint8_t *In, uint32_t Pos)
+{
+  uint32_t h = Hash(In + Pos);
+
+  d->Prev[Pos & WINDOW_MASK] = d->Head[h];
+  d->Head[h] = (int32_t)Pos;
+}
+
+// Longest match for the data at Pos among the earlier positions with the same hash
+static uint32_t FindMatch(Deflater *d, const uint8_t *In, uint32_t Size, uint32_t Pos, uint32_t *Dist)
+{
+  int32_t Cand = d->Head[Hash(In + Pos)];
+  uint32_t Best = 0, Max = Size - Pos, Len;
+  int Chain = MAX_CHAIN;
+
+  if (Max > MAX_MATCH)
+    Max = MAX_MATCH;
+  while (Cand >= 0 && Pos - (uint32_t)Cand <= WINDOW_SIZE - 1 && Chain--)
+  {
+    if (In[Cand + Best] == In[Pos + Best])
+    {
+      for (Len = 0; Len < Max && In[Cand + Len] == In[Pos + Len]; Len++)
+        ;
+      if (Len > Best)
+      {
+        Best = Len;
+        *Dist = Pos - (uint32_t)Cand;
+        if (Len >= NICE_MATCH || Len == Max)
+          break;
+      }
+    }
+    Cand = d->Prev[Cand & WINDOW_MASK];
+  }
+  return Best >= MIN_MATCH ? Best : 0;
+}
+
+// ***************************************************************************************************************
+// *** Public ****************************************************************************************************
+// ***************************************************************************************************************
+
+uint32_t Deflate_Bound(uint32_t Size)
+{
+  return Size + 5 * (Size / STORED_MAX + 1) + 6 + 5 * (Size / BLOCK_SYMBOLS + 1) + 64;
+}
+
+uint32_t Deflate_Adler32(const uint8_t *Data, uint32_t Size)
+{
+  uint32_t a = 1, b = 0, n;
+
+  while (Size)
+  {
+    n = Size > 5552 ? 5552 : Size;                                 // Largest run that can not overflow b
+    Size -= n;
+    while (n--)
+    {
+      a += *Data++;
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+// Compress Size bytes from In into Out.  Returns the size of the zlib stream, or 0 if it did not fit in
+// OutSize (Deflate_Bound() is always enough) or there was no memory to work in.
+uint32_t Deflate_Compress(const uint8_t *In, uint32_t Size, uint8_t *Out, uint32_t OutSize)
+{
+  Deflater *d = (Deflater*)malloc(sizeof(Deflater));
+  BitWriter w = { Out, OutSize, 0, 0, 0, 0 };
+  SymbolBuffer *s;
+  uint32_t Pos = 0, BlockStart = 0, Len, Dist = 0, NextLen, NextDist = 0, Adler, i;
+
+  if (!d)
+    return 0;
+  s = &d->Symbols;
+  s->Count = 0;
+  for (i = 0; i < HASH_SIZE; i++)
+    d->Head[i] = -1;
+
+  PutByte(&w, 0x78);                                               // Deflate, 32K window
+  PutByte(&w, 0x9C);                                               // Default level, no dictionary, check bits
+
+  while (Pos < Size)
+  {
+    Len = 0;
+    if (Size - Pos >= MIN_MATCH)
+    {
+      Len = FindMatch(d, In, Size, Pos, &Dist);
+      Insert(d, In, Pos);
+      if (Len && Len < NICE_MATCH && Size - Pos - 1 >= MIN_MATCH)
+      {
+        NextLen = FindMatch(d, In, Size, Pos + 1, &NextDist);      // Lazy - a better match one byte on wins
+        if (NextLen > Len)
+          Len = 0;
+      }
+    }
+
+    if (Len)
+    {
+      s->Lit[s->Count] = (uint16_t)Len;
+      s->Dist[s->Count++] = (uint16_t)Dist;
+      for (i = 1; i < Len; i++)
+        if (Size - (Pos + i) >= MIN_MATCH)
+          Insert(d, In, Pos + i);
+      Pos += Len;
+    }
+    else
+    {
+      s->Lit[s->Count] = In[Pos];
+      s->Dist[s->Count++] = 0;
+      Pos++;
+    }
+
+    if (s->Count == BLOCK_SYMBOLS || Pos == Size)
+    {
+      PutBlock(&w, s, In + BlockStart, Pos - BlockStart, Pos == Size);
+      s->Count = 0;
+      BlockStart = Pos;
+    }
+  }
+  if (!Size)
+    PutStored(&w, In, 0, 1);                                       // Even nothing needs a final block
+  AlignByte(&w);
+
+  Adler = Deflate_Adler32(In, Size);
+  PutByte(&w, (uint8_t)(Adler >> 24));
+  PutByte(&w, (uint8_t)(Adler >> 16));
+  PutByte(&w, (uint8_t)(Adler >> 8));
+  PutByte(&w, (uint8_t)Adler);
+
+  free(d);
+  return w.Overflow ? 0 : w.Pos;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Deflate compressor for CMD_INFLATE - host side, see eve_deflate.c.
+//
+// Produces a zlib stream (RFC 1950 around RFC 1951 deflate data), which is what CMD_INFLATE expects.  It is
+// written for a PC building or uploading assets, not for the microcontroller driving Eve - it wants a few
+// hundred KB of heap while it works.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+uint32_t Deflate_Bound(uint32_t Size);             // Largest output Deflate_Compress() can produce for Size bytes
+uint32_t Deflate_Compress(const uint8_t *In, uint32_t Size, uint8_t *Out, uint32_t OutSize);
+uint32_t Deflate_Adler32(const uint8_t *Data, uint32_t Size);
+
+#ifdef __cplusplus
+}
+#endif
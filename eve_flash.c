@@ -0,0 +1,138 @@
+// Incremental flash update - see eve_flash.h.
+//
+// The image is taken FLASH_BATCH sectors at a time.  For each batch the FIFO gets a CMD_FLASHREAD and a
+// CMD_MEMCRC per sector, all reading into the same spare sector of RAM_G, and the CRCs are read back once the
+// CoPro has been through them.  The sectors whose CRC does not match the host's are then written.
+//
+// Writing a sector means sending it to RAM_G and following it with CMD_FLASHUPDATE, which keeps the CoPro
+// busy for tens of milliseconds erasing and programming.  Two RAM_G buffers take turns, so the next changed
+// sector is on its way over SPI while the one before it is being programmed - the host only waits for the
+// update that last used the buffer it is about to fill.
+//
+// A partial last sector is padded with 0xFF (erased flash) to the whole 4K - by CMD_MEMSET in RAM_G, and in the
+// host's CRC by carrying it on over 0xFF bytes - so nothing the size of a sector is kept on the host.
+
+#include <string.h>
+#include "eve_flash.h"
+#include "eve_nomalloc.h"
+
+#define FLASH_BATCH  64                          // 32 bytes of commands a sector - half the FIFO
+
+// Bytes of sector s that come from Image - the rest is padding
+static uint32_t SectorBytes(uint32_t Size, uint32_t s)
+{
+  uint32_t Offset = s * FLASH_SECTOR_SIZE;
+
+  return Size - Offset < FLASH_SECTOR_SIZE ? Size - Offset : FLASH_SECTOR_SIZE;
+}
+
+// CRC-32 of the host's copy of sector s, as it will be once padded
+static uint32_t SectorCrc(const uint8_t *Image, uint32_t Size, uint32_t s)
+{
+  uint8_t Erased[64];
+  uint32_t Bytes = SectorBytes(Size, s), Pad = FLASH_SECTOR_SIZE - Bytes, Step, Crc;
+
+  Crc = Eve_Crc32(0, Image + s * FLASH_SECTOR_SIZE, Bytes);
+  memset(Erased, 0xFF, sizeof(Erased));
+  for (; Pad; Pad -= Step)
+  {
+    Step = Pad < sizeof(Erased) ? Pad : sizeof(Erased);
+    Crc = Eve_Crc32(Crc, Erased, Step);
+  }
+  return Crc;
+}
+
+// Compare Count sectors from First.  Sets bit n of Differs for each sector First + n that is not the same in
+// flash.  Returns false if the CoPro faulted.
+static bool Compare(EveContext *ctx, uint32_t FlashAddr, const uint8_t *Image, uint32_t Size, uint32_t Scratch,
+                    uint32_t First, uint32_t Count, uint64_t *Differs)
+{
+  uint16_t Where[FLASH_BATCH];
+  uint32_t Buffer = Scratch + 2 * FLASH_SECTOR_SIZE, i;
+
+  for (i = 0; i < Count; i++)
+  {
+    Eve_Cmd_FlashRead(ctx, Buffer, FlashAddr + (First + i) * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    Where[i] = Eve_Cmd_MemCrcQueue(ctx, Buffer, FLASH_SECTOR_SIZE);
+  }
+  if (!Eve_WaitCoProMark(ctx, Eve_CoProMark(ctx)))
+    return false;
+
+  *Differs = 0;
+  for (i = 0; i < Count; i++)
+    if (Eve_CmdResult(ctx, Where[i]) != SectorCrc(Image, Size, First + i))
+      *Differs |= 1ULL << i;
+  return true;
+}
+
+static bool FlashReady(EveContext *ctx, uint32_t FlashAddr, uint32_t Scratch)
+{
+  if ((FlashAddr & (FLASH_SECTOR_SIZE - 1)) || (Scratch & 3))
+    return false;
+  return Eve_rd8(ctx, REG_FLASH_STATUS + RAM_REG) == FLASH_STATUS_FULL || Eve_FlashFast(ctx);
+}
+
+// Make the flash from FlashAddr (4K aligned) hold Size bytes of Image.  Scratch is FLASH_SCRATCH_SIZE bytes of
+// RAM_G to work in.  Returns true once every sector has been checked again and found to match.
+bool Flash_Update(EveContext *ctx, uint32_t FlashAddr, const uint8_t *Image, uint32_t Size, uint32_t Scratch, FlashUpdateStats *Stats)
+{
+  uint32_t Sectors = (Size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, First, Count, Buffer, Bytes, i;
+  uint32_t Written = 0, Done[2] = { 0, 0 };
+  uint64_t Differs;
+  int32_t Left;
+
+  memset(Stats, 0, sizeof(FlashUpdateStats));
+  if (!FlashReady(ctx, FlashAddr, Scratch))
+    return false;
+
+  for (First = 0; First < Sectors; First += Count)
+  {
+    Count = Sectors - First < FLASH_BATCH ? Sectors - First : FLASH_BATCH;
+    if (!Compare(ctx, FlashAddr, Image, Size, Scratch, First, Count, &Differs))
+      return false;
+    Stats->Sectors += Count;
+
+    for (i = 0; i < Count; i++)
+    {
+      if (!(Differs & (1ULL << i)))
+        continue;
+      Buffer = Scratch + (Written & 1) * FLASH_SECTOR_SIZE;
+      if (Written >= 2 && !Eve_WaitCoProMark(ctx, Done[Written & 1]))     // Programmed from this buffer last time
+        return false;
+      Bytes = SectorBytes(Size, First + i);
+      Eve_WriteBlockRAM(ctx, Buffer, Image + (First + i) * FLASH_SECTOR_SIZE, Bytes);
+      if (Bytes < FLASH_SECTOR_SIZE)
+        Eve_Cmd_Memset(ctx, Buffer + Bytes, 0xFF, FLASH_SECTOR_SIZE - Bytes);
+      Eve_Cmd_FlashUpdate(ctx, FlashAddr + (First + i) * FLASH_SECTOR_SIZE, Buffer, FLASH_SECTOR_SIZE);
+      Done[Written & 1] = Eve_CoProMark(ctx);
+      Written++;
+    }
+  }
+  Stats->Changed = Written;
+
+  Left = Written ? Flash_Verify(ctx, FlashAddr, Image, Size, Scratch) : 0;
+  if (Left < 0)
+    return false;
+  Stats->Mismatched = (uint32_t)Left;
+  return Left == 0;
+}
+
+// The number of sectors from FlashAddr that differ from Image, or -1 if the flash could not be read
+int32_t Flash_Verify(EveContext *ctx, uint32_t FlashAddr, const uint8_t *Image, uint32_t Size, uint32_t Scratch)
+{
+  uint32_t Sectors = (Size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, First, Count;
+  uint64_t Differs;
+  int32_t Left = 0;
+
+  if (!FlashReady(ctx, FlashAddr, Scratch))
+    return -1;
+  for (First = 0; First < Sectors; First += Count)
+  {
+    Count = Sectors - First < FLASH_BATCH ? Sectors - First : FLASH_BATCH;
+    if (!Compare(ctx, FlashAddr, Image, Size, Scratch, First, Count, &Differs))
+      return -1;
+    for (; Differs; Differs &= Differs - 1)
+      Left++;
+  }
+  return Left;
+}
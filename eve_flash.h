@@ -0,0 +1,33 @@
+#pragma once
+
+// Incremental flash update - see eve_flash.c.
+//
+// Flash_Update() brings the flash attached to a BT81x in line with an image held by the host, writing only
+// the 4K sectors that differ.  Each sector is compared by CRC-32 - the CoPro reads it out of the flash and
+// works out its CRC, so nothing but the answer comes back over SPI - and changed sectors are sent through
+// RAM_G and written with CMD_FLASHUPDATE.  Changing a few icons in an 8M image takes seconds, not minutes.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+
+#define FLASH_SECTOR_SIZE   4096
+#define FLASH_SCRATCH_SIZE  (3 * FLASH_SECTOR_SIZE)       // RAM_G Flash_Update() needs
+
+typedef struct
+{
+  uint32_t Sectors;               // Compared
+  uint32_t Changed;               // Sent and written
+  uint32_t Mismatched;            // Still different afterwards
+} FlashUpdateStats;
+
+bool Flash_Update(EveContext *ctx, uint32_t FlashAddr, const uint8_t *Image, uint32_t Size, uint32_t Scratch, FlashUpdateStats *Stats);
+int32_t Flash_Verify(EveContext *ctx, uint32_t FlashAddr, const uint8_t *Image, uint32_t Size, uint32_t Scratch);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,384 @@
+// Flash image builder - host side tool
+//
+// Packs bitmaps, fonts, animations and raw blobs into an image for the flash attached to a BT81x, laid out as
+// described at FLASH_INDEX_ADDR in Eve2_81x.h: the blob the BT81x needs for full speed mode at 0, the index in
+// the next sector and the assets after it, each FLASH_ASSET_ALIGN aligned so CMD_FLASHSOURCE and ASTC bitmaps
+// can use them where they are.  On the target, Eve_FlashIndexLoad() reads the index and Eve_FlashAsset() finds
+// an asset by ID.
+//
+//   cc -I. eve_flashimg.c Eve2_81x.c hw_api_sim.c -o eve_flashimg
+//   ./eve_flashimg -b unified.blob -o image.bin [-f flash_MB] manifest.txt
+//
+// The manifest has one asset a line, # to the end of a line is a comment:
+//
+//   # id  type    file              format        width  height
+//   0     bitmap  logo.astc.raw     ASTC_4x4      240    120
+//   1     bitmap  icons.raw         ARGB4         64     64
+//   2     font    roboto30.raw
+//   3     anim    spinner.anim
+//   7     raw     strings.bin
+//
+// IDs run from 0 to FLASH_INDEX_MAX - 1 and need not all be used, but the index has an entry for every ID up
+// to the highest, so keep them close together.  The target only keeps IDs below EVE_FLASH_ASSETS, so any from
+// there up draw a warning - build the tool with the same -DEVE_FLASH_ASSETS as the target.  Format is a name
+// from Eve2_81x.h (ASTC ones without the COMPRESSED_RGBA_ and _KHR) or a number, and is stored along with width
+// and height for the application's use.
+//
+// The input files are mapped rather than read, and the image is written through a mapping of the output file,
+// so each byte is copied once - an 8M image takes a few milliseconds more than the disk does.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "Eve2_81x.h"
+
+#if defined(_WIN32)
+#  define NO_MMAP                        // Plain stdio there
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+#define IMAGE_ASSETS_ADDR  (FLASH_INDEX_ADDR + 4096)        // The index has its own sector
+
+typedef struct
+{
+  uint16_t Id;
+  uint16_t Type;
+  uint16_t Format;
+  uint16_t Width;
+  uint16_t Height;
+  char File[256];
+  const uint8_t *Data;
+  uint32_t Size;
+  uint32_t Addr;
+} Asset;
+
+static Asset Assets[FLASH_INDEX_MAX];
+static uint16_t AssetCount;
+
+static const char *TypeNames[] = { "raw", "bitmap", "font", "anim" };
+
+static const struct { const char *Name; uint16_t Format; } Formats[] =
+{
+  { "ARGB1555", ARGB1555 }, { "L1", L1 }, { "L2", L2 }, { "L4", L4 }, { "L8", L8 }, { "RGB332", RGB332 },
+  { "ARGB2", ARGB2 }, { "ARGB4", ARGB4 }, { "RGB565", RGB565 }, { "PALETTED565", PALETTED565 },
+  { "PALETTED4444", PALETTED4444 }, { "PALETTED8", PALETTED8 },
+  { "ASTC_4x4", COMPRESSED_RGBA_ASTC_4x4_KHR }, { "ASTC_5x4", COMPRESSED_RGBA_ASTC_5x4_KHR },
+  { "ASTC_5x5", COMPRESSED_RGBA_ASTC_5x5_KHR }, { "ASTC_6x5", COMPRESSED_RGBA_ASTC_6x5_KHR },
+  { "ASTC_6x6", COMPRESSED_RGBA_ASTC_6x6_KHR }, { "ASTC_8x5", COMPRESSED_RGBA_ASTC_8x5_KHR },
+  { "ASTC_8x6", COMPRESSED_RGBA_ASTC_8x6_KHR }, { "ASTC_8x8", COMPRESSED_RGBA_ASTC_8x8_KHR },
+  { "ASTC_10x5", COMPRESSED_RGBA_ASTC_10x5_KHR }, { "ASTC_10x6", COMPRESSED_RGBA_ASTC_10x6_KHR },
+  { "ASTC_10x8", COMPRESSED_RGBA_ASTC_10x8_KHR }, { "ASTC_10x10", COMPRESSED_RGBA_ASTC_10x10_KHR },
+  { "ASTC_12x10", COMPRESSED_RGBA_ASTC_12x10_KHR }, { "ASTC_12x12", COMPRESSED_RGBA_ASTC_12x12_KHR },
+};
+
+// ***************************************************************************************************************
+// *** Files *****************************************************************************************************
+// ***************************************************************************************************************
+
+// The whole of Name, mapped read only.  Size is set to its length.
+static const uint8_t *MapIn(const char *Name, uint32_t *Size)
+{
+#if defined(NO_MMAP)
+  FILE *f = fopen(Name, "rb");
+  uint8_t *Data;
+  long n;
+
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  n = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  Data = malloc(n ? n : 1);
+  if (Data && fread(Data, 1, n, f) != (size_t)n)
+  {
+    free(Data);
+    Data = NULL;
+  }
+  fclose(f);
+  *Size = (uint32_t)n;
+  return Data;
+#else
+  struct stat st;
+  void *Data;
+  int fd = open(Name, O_RDONLY);
+
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  *Size = (uint32_t)st.st_size;
+  Data = st.st_size ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : (void *)"";
+  close(fd);                                               // The mapping outlives the descriptor
+  return Data == MAP_FAILED ? NULL : Data;
+#endif
+}
+
+// A writable Size byte image that ends up in Name once Commit() is called
+static uint8_t *MapOut(const char *Name, uint32_t Size)
+{
+#if defined(NO_MMAP)
+  (void)Name;
+  return malloc(Size);
+#else
+  void *Data;
+  int fd = open(Name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0)
+    return NULL;
+  if (ftruncate(fd, Size) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  Data = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  return Data == MAP_FAILED ? NULL : Data;
+#endif
+}
+
+static bool Commit(const char *Name, uint8_t *Image, uint32_t Size)
+{
+#if defined(NO_MMAP)
+  FILE *f = fopen(Name, "wb");
+  bool Ok = f && fwrite(Image, 1, Size, f) == Size;
+
+  if (f)
+    fclose(f);
+  free(Image);
+  return Ok;
+#else
+  (void)Name;
+  return munmap(Image, Size) == 0;                         // MAP_SHARED - the pages are the file's
+#endif
+}
+
+// ***************************************************************************************************************
+// *** Manifest **************************************************************************************************
+// ***************************************************************************************************************
+
+static bool ParseType(const char *s, uint16_t *Type)
+{
+  uint16_t i;
+
+  for (i = 0; i < sizeof(TypeNames) / sizeof(TypeNames[0]); i++)
+    if (!strcmp(s, TypeNames[i]))
+    {
+      *Type = i;
+      return true;
+    }
+  return false;
+}
+
+static bool ParseFormat(const char *s, uint16_t *Format)
+{
+  char *End;
+  unsigned long n;
+  uint16_t i;
+
+  for (i = 0; i < sizeof(Formats) / sizeof(Formats[0]); i++)
+    if (!strcmp(s, Formats[i].Name))
+    {
+      *Format = Formats[i].Format;
+      return true;
+    }
+  n = strtoul(s, &End, 0);
+  if (*End || End == s || n > 0xFFFF)
+    return false;
+  *Format = (uint16_t)n;
+  return true;
+}
+
+static bool ReadManifest(const char *Name)
+{
+  char Line[512], Type[32], Format[32], *Hash;
+  unsigned Id, Width, Height;
+  int Fields, LineNo = 0;
+  Asset *a;
+  uint16_t i;
+  FILE *f = fopen(Name, "r");
+
+  if (!f)
+  {
+    fprintf(stderr, "%s: cannot open\n", Name);
+    return false;
+  }
+  while (fgets(Line, sizeof(Line), f))
+  {
+    LineNo++;
+    if ((Hash = strchr(Line, '#')) != NULL)
+      *Hash = 0;
+    a = &Assets[AssetCount];
+    memset(a, 0, sizeof(Asset));
+    Fields = sscanf(Line, "%u %31s %255s %31s %u %u", &Id, Type, a->File, Format, &Width, &Height);
+    if (Fields <= 0)
+      continue;                                            // Blank or comment
+    if (Fields < 3 || Fields == 4 || Fields == 5 || Id >= FLASH_INDEX_MAX || !ParseType(Type, &a->Type) ||
+        (Fields == 6 && !ParseFormat(Format, &a->Format)) || Width > 0xFFFF || Height > 0xFFFF)
+    {
+      fprintf(stderr, "%s:%d: expected id type file [format width height]\n", Name, LineNo);
+      fclose(f);
+      return false;
+    }
+    for (i = 0; i < AssetCount; i++)
+      if (Assets[i].Id == Id)
+      {
+        fprintf(stderr, "%s:%d: id %u used twice\n", Name, LineNo, Id);
+        fclose(f);
+        return false;
+      }
+    if (Id >= EVE_FLASH_ASSETS)
+      fprintf(stderr, "%s:%d: warning: id %u is not below EVE_FLASH_ASSETS (%u), Eve_FlashAsset() will not find it\n",
+              Name, LineNo, Id, (unsigned)EVE_FLASH_ASSETS);
+    a->Id = (uint16_t)Id;
+    if (Fields == 6)
+    {
+      a->Width = (uint16_t)Width;
+      a->Height = (uint16_t)Height;
+    }
+    if (++AssetCount == FLASH_INDEX_MAX)
+      break;
+  }
+  fclose(f);
+  return true;
+}
+
+// ***************************************************************************************************************
+// *** Image *****************************************************************************************************
+// ***************************************************************************************************************
+
+static void Put32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static void Put16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void WriteIndex(uint8_t *Image, uint32_t Size)
+{
+  uint8_t *Index = Image + FLASH_INDEX_ADDR, *e;
+  uint16_t Count = 0, i;
+
+  for (i = 0; i < AssetCount; i++)
+    if (Assets[i].Id >= Count)
+      Count = Assets[i].Id + 1;
+  memset(Index, 0, FLASH_INDEX_HEADER_SIZE + Count * FLASH_INDEX_ENTRY_SIZE);   // Unused IDs have Size 0
+  for (i = 0; i < AssetCount; i++)
+  {
+    e = Index + FLASH_INDEX_HEADER_SIZE + Assets[i].Id * FLASH_INDEX_ENTRY_SIZE;
+    Put32(e, Assets[i].Addr);
+    Put32(e + 4, Assets[i].Size);
+    Put16(e + 8, Assets[i].Type);
+    Put16(e + 10, Assets[i].Format);
+    Put16(e + 12, Assets[i].Width);
+    Put16(e + 14, Assets[i].Height);
+  }
+  Put32(Index, FLASH_INDEX_MAGIC);
+  Put16(Index + 4, FLASH_INDEX_VERSION);
+  Put16(Index + 6, Count);
+  Put32(Index + 8, Eve_Crc32(0, Index + FLASH_INDEX_HEADER_SIZE, Count * FLASH_INDEX_ENTRY_SIZE));
+  Put32(Index + 12, Size);
+}
+
+static void Usage(void)
+{
+  fprintf(stderr, "usage: eve_flashimg -b unified.blob -o image.bin [-f flash_MB] manifest.txt\n");
+  exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *BlobName = NULL, *OutName = NULL, *ManifestName = NULL;
+  const uint8_t *Blob;
+  uint32_t BlobSize, Limit = 8, Size, At, i;
+  uint8_t *Image;
+  clock_t Start = clock();
+  int a;
+
+  for (a = 1; a < argc; a++)
+  {
+    if (!strcmp(argv[a], "-b") && a + 1 < argc)
+      BlobName = argv[++a];
+    else if (!strcmp(argv[a], "-o") && a + 1 < argc)
+      OutName = argv[++a];
+    else if (!strcmp(argv[a], "-f") && a + 1 < argc)
+      Limit = (uint32_t)atoi(argv[++a]);
+    else if (argv[a][0] != '-' && !ManifestName)
+      ManifestName = argv[a];
+    else
+      Usage();
+  }
+  if (!BlobName || !OutName || !ManifestName || !Limit || Limit > 256)
+    Usage();
+  Limit <<= 20;
+
+  if ((Blob = MapIn(BlobName, &BlobSize)) == NULL || BlobSize != FLASH_BLOB_SIZE)
+  {
+    fprintf(stderr, "%s: not a %d byte flash blob\n", BlobName, FLASH_BLOB_SIZE);
+    return 1;
+  }
+  if (!ReadManifest(ManifestName))
+    return 1;
+
+  // Lay the assets out in manifest order, so related ones can be kept together
+  At = IMAGE_ASSETS_ADDR;
+  for (i = 0; i < AssetCount; i++)
+  {
+    if ((Assets[i].Data = MapIn(Assets[i].File, &Assets[i].Size)) == NULL)
+    {
+      fprintf(stderr, "%s: cannot open\n", Assets[i].File);
+      return 1;
+    }
+    if (At + Assets[i].Size < At || At + Assets[i].Size > Limit)
+    {
+      fprintf(stderr, "%s: does not fit in %u MB of flash\n", Assets[i].File, Limit >> 20);
+      return 1;
+    }
+    Assets[i].Addr = At;
+    At = (At + Assets[i].Size + FLASH_ASSET_ALIGN - 1) & ~(uint32_t)(FLASH_ASSET_ALIGN - 1);
+  }
+  Size = At;
+
+  if ((Image = MapOut(OutName, Size)) == NULL)
+  {
+    fprintf(stderr, "%s: cannot create\n", OutName);
+    return 1;
+  }
+  memcpy(Image, Blob, FLASH_BLOB_SIZE);
+  memset(Image + FLASH_INDEX_ADDR, 0xFF, IMAGE_ASSETS_ADDR - FLASH_INDEX_ADDR);
+  for (i = 0; i < AssetCount; i++)
+  {
+    memcpy(Image + Assets[i].Addr, Assets[i].Data, Assets[i].Size);
+    At = i + 1 < AssetCount ? Assets[i + 1].Addr : Size;
+    memset(Image + Assets[i].Addr + Assets[i].Size, 0xFF, At - Assets[i].Addr - Assets[i].Size);   // Erased flash
+  }
+  WriteIndex(Image, Size);
+  if (!Commit(OutName, Image, Size))
+  {
+    fprintf(stderr, "%s: cannot write\n", OutName);
+    return 1;
+  }
+
+  printf("  id  type    address     size  format  width height  file\n");
+  for (i = 0; i < AssetCount; i++)
+    printf("%4u  %-6s  %7u  %7u  %6u  %5u  %5u  %s\n", Assets[i].Id, TypeNames[Assets[i].Type], Assets[i].Addr,
+           Assets[i].Size, Assets[i].Format, Assets[i].Width, Assets[i].Height, Assets[i].File);
+  printf("%s: %u assets, %u bytes (%u%% of %u MB) in %.0f ms\n", OutName, AssetCount, Size, (uint32_t)((uint64_t)Size * 100 / Limit),
+         Limit >> 20, (double)(clock() - Start) * 1000 / CLOCKS_PER_SEC);
+  return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Included last by every library source file, after the system headers.  With EVE_NO_MALLOC defined (see
+// MatrixEve2Conf.h) any use of the heap below the include is a build error.  eve_asset.c and eve_deflate.c
+// are host side and need the heap, so they stop building - leave them out of a build that defines it.
+
+#include <stdlib.h>
+#include "MatrixEve2Conf.h"
+
+#if defined(EVE_NO_MALLOC)
+#  define malloc(s)     EVE_NO_MALLOC_heap_use_not_allowed
+#  define calloc(n, s)  EVE_NO_MALLOC_heap_use_not_allowed
+#  define realloc(p, s) EVE_NO_MALLOC_heap_use_not_allowed
+#  define free(p)       EVE_NO_MALLOC_heap_use_not_allowed
+#endif
@@ -0,0 +1,366 @@
+// RAM_G allocator - see eve_ramg.h.
+//
+// The free space is kept as a list of extents in address order, merged with their neighbours as blocks are
+// freed.  RamG_Alloc() takes the extent that leaves the least behind once the block is aligned in it (best
+// fit), and whatever is left either side goes back on the list.  Blocks are looked up by handle, which is
+// just the index in the block table plus one, so there is no searching to find an address.
+//
+// RamG_Compact() slides every block that is not pinned down to the lowest address it can have, in address
+// order, with CMD_MEMCPY.  A block is moved in pieces no bigger than the distance it moves so that no piece
+// overlaps its own destination.  Moves that would take more than COMPACT_MAX_PIECES pieces are not worth it
+// and the block stays where it is.  Display list blocks are then read back and their BITMAP_SOURCE commands
+// corrected, and the application is told about each move so it can do the same for any addresses it keeps.
+
+#include <stdio.h>
+#include <string.h>
+#include "eve_ramg.h"
+#include "eve_nomalloc.h"
+
+#define COMPACT_MAX_PIECES  16
+#define PATCH_WORDS         256                  // Display list words read back at a time
+
+// Bytes per 4x4 .. 12x12 ASTC block footprint, in the order of the COMPRESSED_RGBA_ASTC_ formats
+static const uint8_t AstcBlock[14][2] =
+{
+  { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 }, { 10, 5 }, { 10, 6 },
+  { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+};
+
+static uint8_t BitsPerPixel(uint16_t Format)
+{
+  switch (Format)
+  {
+  case L1:
+    return 1;
+  case L2:
+    return 2;
+  case L4:
+    return 4;
+  case L8: case RGB332: case ARGB2: case PALETTED565: case PALETTED4444: case PALETTED8: case BARGRAPH: case TEXT8X8:
+    return 8;
+  case ARGB1555: case ARGB4: case RGB565: case TEXTVGA:
+    return 16;
+  }
+  return 0;
+}
+
+static bool IsAstc(uint16_t Format)
+{
+  return Format >= COMPRESSED_RGBA_ASTC_4x4_KHR && Format <= COMPRESSED_RGBA_ASTC_12x12_KHR;
+}
+
+// Bytes of RAM_G a bitmap takes - rows are whole bytes, ASTC is 16 bytes per block.  0 for an unknown format.
+uint32_t RamG_BitmapSize(uint16_t Format, uint16_t Width, uint16_t Height)
+{
+  const uint8_t *Block;
+
+  if (IsAstc(Format))
+  {
+    Block = AstcBlock[Format - COMPRESSED_RGBA_ASTC_4x4_KHR];
+    return ((Width + Block[0] - 1) / Block[0]) * ((Height + Block[1] - 1) / Block[1]) * 16UL;
+  }
+  return (((uint32_t)Width * BitsPerPixel(Format) + 7) / 8) * Height;
+}
+
+// ***************************************************************************************************************
+// *** Free list *************************************************************************************************
+// ***************************************************************************************************************
+
+static uint32_t AlignUp(uint32_t Addr, uint32_t Align)
+{
+  return (Addr + Align - 1) & ~(Align - 1);
+}
+
+static void RemoveExtent(RamGHeap *Heap, uint16_t i)
+{
+  memmove(&Heap->Free[i], &Heap->Free[i + 1], (Heap->FreeCount - i - 1) * sizeof(RamGExtent));
+  Heap->FreeCount--;
+}
+
+// Put Size bytes at Addr back on the list, merging with the extents either side
+static void AddExtent(RamGHeap *Heap, uint32_t Addr, uint32_t Size)
+{
+  uint16_t i;
+
+  if (!Size)
+    return;
+  for (i = 0; i < Heap->FreeCount && Heap->Free[i].Addr < Addr; i++)
+    ;
+  if (i > 0 && Heap->Free[i - 1].Addr + Heap->Free[i - 1].Size == Addr)
+  {
+    Heap->Free[i - 1].Size += Size;                      // Joins the one before, and maybe the one after too
+    if (i < Heap->FreeCount && Addr + Size == Heap->Free[i].Addr)
+    {
+      Heap->Free[i - 1].Size += Heap->Free[i].Size;
+      RemoveExtent(Heap, i);
+    }
+    return;
+  }
+  if (i < Heap->FreeCount && Addr + Size == Heap->Free[i].Addr)
+  {
+    Heap->Free[i].Addr = Addr;
+    Heap->Free[i].Size += Size;
+    return;
+  }
+  memmove(&Heap->Free[i + 1], &Heap->Free[i], (Heap->FreeCount - i) * sizeof(RamGExtent));
+  Heap->Free[i].Addr = Addr;
+  Heap->Free[i].Size = Size;
+  Heap->FreeCount++;
+}
+
+// ***************************************************************************************************************
+// *** Allocation ************************************************************************************************
+// ***************************************************************************************************************
+
+// Manage Size bytes of RAM_G from Base - all of it is RAM_G, 0 .. 1M, RAM_G_WORKING included
+void RamG_Init(RamGHeap *Heap, EveContext *ctx, uint32_t Base, uint32_t Size)
+{
+  memset(Heap, 0, sizeof(RamGHeap));
+  Heap->ctx = ctx;
+  Heap->Base = Base;
+  Heap->Size = Size;
+  AddExtent(Heap, Base, Size);
+}
+
+// A block of Size bytes on an Align boundary (a power of 2, 4 at least).  Returns 0 if there is no room or no
+// handle left - RamG_Compact() may help with the first.
+RamGHandle RamG_Alloc(RamGHeap *Heap, uint32_t Size, uint32_t Align, uint8_t Flags)
+{
+  uint32_t Addr, Best = 0, BestWaste = 0xFFFFFFFF, End;
+  uint16_t h, i, Pick = 0;
+
+  if (Align < 4)
+    Align = 4;
+  if (!Size || (Align & (Align - 1)))
+    return 0;
+  Size = AlignUp(Size, 4);
+
+  for (h = 0; h < EVE_RAMG_BLOCKS && Heap->Blocks[h].Used; h++)
+    ;
+  if (h == EVE_RAMG_BLOCKS)
+    return 0;
+
+  for (i = 0; i < Heap->FreeCount; i++)
+  {
+    Addr = AlignUp(Heap->Free[i].Addr, Align);
+    End = Heap->Free[i].Addr + Heap->Free[i].Size;
+    if (Addr + Size <= End && End - (Addr + Size) < BestWaste)
+    {
+      Best = Addr;
+      BestWaste = End - (Addr + Size);
+      Pick = i;
+    }
+  }
+  if (BestWaste == 0xFFFFFFFF)
+    return 0;
+
+  Addr = Heap->Free[Pick].Addr;                           // Cut the block out - what is left goes back
+  End = Addr + Heap->Free[Pick].Size;
+  RemoveExtent(Heap, Pick);
+  AddExtent(Heap, Addr, Best - Addr);
+  AddExtent(Heap, Best + Size, End - (Best + Size));
+
+  Heap->Blocks[h].Addr = Best;
+  Heap->Blocks[h].Size = Size;
+  Heap->Blocks[h].Align = Align;
+  Heap->Blocks[h].Flags = Flags;
+  Heap->Blocks[h].Used = true;
+  return h + 1;
+}
+
+// A block for a bitmap, sized and aligned for its format (16 bytes for ASTC, 4 for the rest)
+RamGHandle RamG_AllocBitmap(RamGHeap *Heap, uint16_t Format, uint16_t Width, uint16_t Height, uint8_t Flags)
+{
+  return RamG_Alloc(Heap, RamG_BitmapSize(Format, Width, Height), IsAstc(Format) ? 16 : 4, Flags);
+}
+
+void RamG_Free(RamGHeap *Heap, RamGHandle Handle)
+{
+  RamGBlock *b;
+
+  if (!Handle || Handle > EVE_RAMG_BLOCKS || !Heap->Blocks[Handle - 1].Used)
+    return;
+  b = &Heap->Blocks[Handle - 1];
+  b->Used = false;
+  AddExtent(Heap, b->Addr, b->Size);
+}
+
+// Where the block is now.  0 for a handle that is not allocated - which is also a valid RAM_G address, so check.
+uint32_t RamG_Addr(const RamGHeap *Heap, RamGHandle Handle)
+{
+  if (!Handle || Handle > EVE_RAMG_BLOCKS || !Heap->Blocks[Handle - 1].Used)
+    return 0;
+  return Heap->Blocks[Handle - 1].Addr;
+}
+
+uint32_t RamG_Size(const RamGHeap *Heap, RamGHandle Handle)
+{
+  if (!Handle || Handle > EVE_RAMG_BLOCKS || !Heap->Blocks[Handle - 1].Used)
+    return 0;
+  return Heap->Blocks[Handle - 1].Size;
+}
+
+// Change a block's RamG_Alloc() flags - to pin it only while the CoPro may be using it, say
+void RamG_SetFlags(RamGHeap *Heap, RamGHandle Handle, uint8_t Flags)
+{
+  if (!Handle || Handle > EVE_RAMG_BLOCKS || !Heap->Blocks[Handle - 1].Used)
+    return;
+  Heap->Blocks[Handle - 1].Flags = Flags;
+}
+
+// ***************************************************************************************************************
+// *** Compaction ************************************************************************************************
+// ***************************************************************************************************************
+
+void RamG_SetMovedCallback(RamGHeap *Heap, RamGMoved Moved, void *User)
+{
+  Heap->Moved = Moved;
+  Heap->MovedUser = User;
+}
+
+// Fix BITMAP_SOURCE commands in a display list block that point into blocks that moved
+static void PatchDisplayList(RamGHeap *Heap, const RamGBlock *List, const RamGExtent *From, const uint32_t *To, uint16_t Moves)
+{
+  uint32_t Words[PATCH_WORDS], Addr, Done, n, i;
+  uint16_t m;
+
+  for (Done = 0; Done < List->Size; Done += n)
+  {
+    n = List->Size - Done;
+    if (n > sizeof(Words))
+      n = sizeof(Words);
+    Eve_ReadBlockRAM(Heap->ctx, List->Addr + Done, (uint8_t*)Words, n);
+    for (i = 0; i < n / 4; i++)
+    {
+      if ((Words[i] >> 24) != 1)                         // BITMAP_SOURCE
+        continue;
+      if (Words[i] & 0x800000)                           // In flash (BT81x), not RAM_G
+        continue;
+      Addr = Words[i] & 0xFFFFF;
+      for (m = 0; m < Moves; m++)
+        if (Addr >= From[m].Addr && Addr < From[m].Addr + From[m].Size)
+        {
+          Eve_wr32(Heap->ctx, List->Addr + Done + i * 4, BITMAP_SOURCE(Addr - From[m].Addr + To[m]));
+          break;
+        }
+    }
+  }
+}
+
+// Move blocks down to close the gaps between them.  Waits for the CoPro to finish the copies, so the blocks
+// are in their new places on return.  Returns the number of bytes moved.
+uint32_t RamG_Compact(RamGHeap *Heap)
+{
+  uint16_t Order[EVE_RAMG_BLOCKS], Count = 0, Moves = 0, i, j;
+  RamGExtent From[EVE_RAMG_BLOCKS];
+  uint32_t To[EVE_RAMG_BLOCKS], Cursor = Heap->Base, Addr, Src, Dst, Left, Piece, Moved = 0;
+  RamGBlock *b;
+
+  for (i = 0; i < EVE_RAMG_BLOCKS; i++)                   // Blocks in address order
+  {
+    if (!Heap->Blocks[i].Used)
+      continue;
+    for (j = Count; j > 0 && Heap->Blocks[Order[j - 1]].Addr > Heap->Blocks[i].Addr; j--)
+      Order[j] = Order[j - 1];
+    Order[j] = i;
+    Count++;
+  }
+
+  Heap->FreeCount = 0;
+  for (i = 0; i < Count; i++)
+  {
+    b = &Heap->Blocks[Order[i]];
+    Addr = AlignUp(Cursor, b->Align);
+    if (!(b->Flags & RAMG_PINNED) && Addr < b->Addr && (b->Addr - Addr) * COMPACT_MAX_PIECES >= b->Size)
+    {
+      From[Moves].Addr = b->Addr;
+      From[Moves].Size = b->Size;
+      To[Moves++] = Addr;
+      for (Src = b->Addr, Dst = Addr, Left = b->Size; Left; Src += Piece, Dst += Piece, Left -= Piece)
+      {
+        Piece = b->Addr - Addr;
+        if (Piece > Left)
+          Piece = Left;
+        Eve_Cmd_Memcpy(Heap->ctx, Dst, Src, Piece);
+      }
+      Moved += b->Size;
+      b->Addr = Addr;
+    }
+    AddExtent(Heap, Cursor, b->Addr - Cursor);
+    Cursor = b->Addr + b->Size;
+  }
+  AddExtent(Heap, Cursor, Heap->Base + Heap->Size - Cursor);
+
+  if (!Moves)
+    return 0;
+  Eve_UpdateFIFO(Heap->ctx);
+  Eve_Wait4CoProFIFOEmpty(Heap->ctx);
+  Eve_FrameInvalidate(Heap->ctx);                         // Same commands, different memory
+
+  for (i = 0; i < EVE_RAMG_BLOCKS; i++)
+    if (Heap->Blocks[i].Used && (Heap->Blocks[i].Flags & RAMG_DISPLAY_LIST))
+      PatchDisplayList(Heap, &Heap->Blocks[i], From, To, Moves);
+  if (Heap->Moved)
+    for (i = 0; i < Moves; i++)
+      for (j = 0; j < EVE_RAMG_BLOCKS; j++)
+        if (Heap->Blocks[j].Used && Heap->Blocks[j].Addr == To[i])
+          Heap->Moved(j + 1, From[i].Addr, To[i], Heap->MovedUser);
+  return Moved;
+}
+
+// ***************************************************************************************************************
+// *** Reporting *************************************************************************************************
+// ***************************************************************************************************************
+
+void RamG_GetReport(const RamGHeap *Heap, RamGReport *Report)
+{
+  uint16_t i;
+
+  memset(Report, 0, sizeof(RamGReport));
+  Report->Size = Heap->Size;
+  for (i = 0; i < EVE_RAMG_BLOCKS; i++)
+    if (Heap->Blocks[i].Used)
+    {
+      Report->Blocks++;
+      Report->Used += Heap->Blocks[i].Size;
+    }
+  for (i = 0; i < Heap->FreeCount; i++)
+  {
+    Report->Free += Heap->Free[i].Size;
+    if (Heap->Free[i].Size > Report->LargestFree)
+      Report->LargestFree = Heap->Free[i].Size;
+  }
+  Report->FreeExtents = Heap->FreeCount;
+  if (Report->Free)
+    Report->Fragmentation = (uint8_t)(100 - (uint64_t)Report->LargestFree * 100 / Report->Free);
+}
+
+// Log the report, then every block and free extent in address order
+void RamG_PrintReport(const RamGHeap *Heap)
+{
+  RamGReport r;
+  uint32_t Addr = Heap->Base, Next;
+  uint16_t i, f = 0, Pick;
+
+  RamG_GetReport(Heap, &r);
+  printf("RAM_G %lu bytes: %lu used in %u blocks, %lu free in %u extents, largest %lu, %u%% fragmented\n",
+         (unsigned long)r.Size, (unsigned long)r.Used, r.Blocks, (unsigned long)r.Free, r.FreeExtents,
+         (unsigned long)r.LargestFree, r.Fragmentation);
+
+  while (Addr < Heap->Base + Heap->Size)
+  {
+    Pick = EVE_RAMG_BLOCKS;
+    for (i = 0; i < EVE_RAMG_BLOCKS; i++)                 // The next block up
+      if (Heap->Blocks[i].Used && Heap->Blocks[i].Addr >= Addr && (Pick == EVE_RAMG_BLOCKS || Heap->Blocks[i].Addr < Heap->Blocks[Pick].Addr))
+        Pick = i;
+    Next = (Pick == EVE_RAMG_BLOCKS) ? Heap->Base + Heap->Size : Heap->Blocks[Pick].Addr;
+    for (; f < Heap->FreeCount && Heap->Free[f].Addr < Next; f++)
+      printf("  %06lX %8lu free\n", (unsigned long)Heap->Free[f].Addr, (unsigned long)Heap->Free[f].Size);
+    if (Pick == EVE_RAMG_BLOCKS)
+      break;
+    printf("  %06lX %8lu handle %u%s%s\n", (unsigned long)Heap->Blocks[Pick].Addr, (unsigned long)Heap->Blocks[Pick].Size,
+           Pick + 1, (Heap->Blocks[Pick].Flags & RAMG_PINNED) ? " pinned" : "",
+           (Heap->Blocks[Pick].Flags & RAMG_DISPLAY_LIST) ? " display list" : "");
+    Addr = Heap->Blocks[Pick].Addr + Heap->Blocks[Pick].Size;
+  }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+// RAM_G allocator - see eve_ramg.c.
+//
+// Hands out blocks of RAM_G by handle instead of by hard coded address.  The address behind a handle can
+// change when RamG_Compact() moves blocks together, so look it up with RamG_Addr() when it is needed rather
+// than keeping it.  No heap is used - the block table is EVE_RAMG_BLOCKS entries (MatrixEve2Conf.h).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+
+// RamG_Alloc() flags
+#define RAMG_PINNED        0x01          // Never moved by RamG_Compact() - media FIFOs, video frames, anything the CoPro
+                                         // may be using behind the host's back
+#define RAMG_DISPLAY_LIST  0x02          // Holds display list commands (Eve_SegmentEnd()) - BITMAP_SOURCE commands in it
+                                         // that point into a block RamG_Compact() moves are corrected
+
+typedef uint16_t RamGHandle;             // 0 is never a valid handle
+
+// Told about every block RamG_Compact() moves
+typedef void (*RamGMoved)(RamGHandle Handle, uint32_t From, uint32_t To, void *User);
+
+typedef struct
+{
+  uint32_t Addr;
+  uint32_t Size;
+  uint32_t Align;
+  uint8_t Flags;
+  bool Used;
+} RamGBlock;
+
+typedef struct
+{
+  uint32_t Addr;
+  uint32_t Size;
+} RamGExtent;
+
+typedef struct
+{
+  EveContext *ctx;
+  uint32_t Base;
+  uint32_t Size;
+  RamGBlock Blocks[EVE_RAMG_BLOCKS];           // By handle - 1
+  RamGExtent Free[EVE_RAMG_BLOCKS + 1];        // Free space, in address order and never touching
+  uint16_t FreeCount;
+  RamGMoved Moved;
+  void *MovedUser;
+} RamGHeap;
+
+typedef struct
+{
+  uint32_t Size;                 // Bytes managed
+  uint32_t Used;                 // Bytes in blocks
+  uint32_t Free;
+  uint32_t LargestFree;          // Biggest block that can be allocated (before alignment)
+  uint16_t Blocks;
+  uint16_t FreeExtents;
+  uint8_t Fragmentation;         // Percent of the free space that is not in the largest free extent
+} RamGReport;
+
+void RamG_Init(RamGHeap *Heap, EveContext *ctx, uint32_t Base, uint32_t Size);
+RamGHandle RamG_Alloc(RamGHeap *Heap, uint32_t Size, uint32_t Align, uint8_t Flags);
+RamGHandle RamG_AllocBitmap(RamGHeap *Heap, uint16_t Format, uint16_t Width, uint16_t Height, uint8_t Flags);
+void RamG_Free(RamGHeap *Heap, RamGHandle Handle);
+uint32_t RamG_Addr(const RamGHeap *Heap, RamGHandle Handle);
+uint32_t RamG_Size(const RamGHeap *Heap, RamGHandle Handle);
+uint32_t RamG_BitmapSize(uint16_t Format, uint16_t Width, uint16_t Height);
+void RamG_SetFlags(RamGHeap *Heap, RamGHandle Handle, uint8_t Flags);
+void RamG_SetMovedCallback(RamGHeap *Heap, RamGMoved Moved, void *User);
+uint32_t RamG_Compact(RamGHeap *Heap);
+void RamG_GetReport(const RamGHeap *Heap, RamGReport *Report);
+void RamG_PrintReport(const RamGHeap *Heap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,6 +31,13 @@ void HAL_Eve_Reset_HW(void);
 /* Cleans up and resources allocated */
 void HAL_Close(void);
 
+/* Free running microsecond counter - required when the library is built with EVE_INSTRUMENT or EVE_HAL_MICROS */
+uint32_t HAL_Micros(void);
+
+/* Wait up to TimeoutMs for the Eve INT pin to go active (low), true if it did - only required when the library is
+   built with EVE_HAL_IRQ.  A TimeoutMs of 0 just looks at the pin. */
+bool HAL_Wait_IRQ(uint32_t TimeoutMs);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,1611 @@
+// Simulated Eve device - see hw_api_sim.h for what it is and how to drive it.
+//
+// This file is a drop in replacement for the hardware specific code behind hw_api.h.  It is written for a
+// hosted environment (Linux, Windows, macOS) and is not meant to go anywhere near a microcontroller.
+//
+// The SPI decoder follows FT81X Embedded Video Engine Datasheet section 4.1:
+//  - A transaction starts with chip select and 3 bytes.  If the top 2 bits of the first byte are 10 it is a
+//    memory write, 00 a memory read.  01 or a 00 00 00 with nothing following is a host command.
+//  - Write data follows the address directly and the address auto increments.
+//  - Read data follows the address and one dummy byte.  As with the real HAL, HAL_SPI_ReadBuffer() clocks
+//    the dummy byte itself, so bytes sent with HAL_SPI_Write() after a read address also count as dummy.
+// The CoProcessor runs whenever REG_CMD_WRITE is written or REG_CMDB_WRITE takes data, and runs until the
+// FIFO is empty or the next command is not completely there yet.  Display list commands land in RAM_DL at
+// REG_CMD_DL.  Widgets are consumed but draw nothing.
+// Data streams following CMD_LOADIMAGE and CMD_PLAYVIDEO are consumed up to the end of the JPEG, PNG or AVI file
+// without being decoded, from the command FIFO or (OPT_MEDIAFIFO) from the media FIFO set up by CMD_MEDIAFIFO.
+// The media FIFO is read whenever REG_MEDIAFIFO_WRITE is written.  CMD_VIDEOSTART reads an AVI header from it
+// up to the movi list and each CMD_VIDEOFRAME one video chunk, so their completion word can be set.  CMD_INFLATE data is inflated for real into RAM_G, so CMD_MEMCRC can check it.
+// BT81x chips (EVE_SIM_CHIP 0x815 and up) have a flash attached, which CMD_FLASHREAD, CMD_FLASHWRITE,
+// CMD_FLASHUPDATE and CMD_FLASHERASE work on.  Erasing and programming keep the CoPro busy for as long as a
+// typical NOR flash would take, with REG_CMD_READ left on the command until the time is up.
+// Scripted presses drive REG_TOUCH_SCREEN_XY, REG_TOUCH_TAG_XY and REG_TOUCH_TAG in simulated time, and raise
+// INT_TOUCH and INT_TAG in REG_INT_FLAGS as they start and end.  HAL_Wait_IRQ() moves the clock on to the next
+// press or release that drives INT active, as a real wait on the pin would.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Eve2_81x.h"
+#include "hw_api.h"
+#include "hw_api_sim.h"
+
+#define SIM_MEM_SIZE     0x400000       // 22 bit address space
+#define SIM_MEM_MASK     (SIM_MEM_SIZE - 1)
+#define SIM_BOOT_NS      20000000ULL    // Time from HCMD_ACTIVE until REG_ID reads 0x7C
+#define SIM_FRAME_NS     16666667ULL    // 60Hz panel refresh for REG_FRAMES
+#define SIM_SCRIPT_MAX   64
+#define SIM_FLASH_SECTOR 4096
+#define SIM_SECTOR_NS    45000000ULL    // Erase and program one 4K flash sector
+#define SIM_PAGE_NS      700000ULL      // Program one 256 byte flash page
+
+#define REG(r)           (RAM_REG + (r))
+
+// CoPro command parameter descriptions - how many 32 bit words follow the command and what comes after that
+#define ARG_STRING       0x01           // A NUL terminated, padded string follows the fixed parameters
+#define ARG_DATA_ARG1    0x02           // Parameter 1 is the byte count of data that follows (CMD_MEMWRITE, CMD_FLASHWRITE)
+#define ARG_DATA_ARG0    0x04           // Parameter 0 is the byte count of data that follows (CMD_FLASHSPITX)
+#define ARG_STREAM       0x08           // A data stream follows the fixed parameters, or comes from the media FIFO or flash
+#define ARG_MEDIA        0x10           // Data always comes from the media FIFO (CMD_VIDEOSTART, CMD_VIDEOFRAME)
+
+typedef struct
+{
+  uint32_t Cmd;
+  uint8_t Words;
+  uint8_t Flags;
+} SimCmdInfo;
+
+static const SimCmdInfo SimCmds[] =
+{
+  { CMD_APPEND, 2, 0 },       { CMD_BGCOLOR, 1, 0 },      { CMD_BUTTON, 3, ARG_STRING },
+  { CMD_CALIBRATE, 1, 0 },    { CMD_CLOCK, 4, 0 },        { CMD_COLDSTART, 0, 0 },
+  { CMD_MEMCRC, 3, 0 },       { CMD_DIAL, 3, 0 },         { CMD_DLSTART, 0, 0 },
+  { CMD_FGCOLOR, 1, 0 },      { CMD_GAUGE, 4, 0 },        { CMD_GETMATRIX, 6, 0 },
+  { CMD_GETPROPS, 3, 0 },     { CMD_GETPTR, 1, 0 },       { CMD_GRADCOLOR, 1, 0 },
+  { CMD_GRADIENT, 4, 0 },     { CMD_INFLATE, 1, ARG_STREAM }, { CMD_INFLATE2, 2, ARG_STREAM },
+  { CMD_INTERRUPT, 1, 0 },    { CMD_KEYS, 3, ARG_STRING }, { CMD_LOADIDENTITY, 0, 0 },
+  { CMD_LOADIMAGE, 2, ARG_STREAM }, { CMD_LOGO, 0, 0 },   { CMD_MEDIAFIFO, 2, 0 },
+  { CMD_MEMCPY, 3, 0 },       { CMD_MEMSET, 3, 0 },       { CMD_MEMWRITE, 2, ARG_DATA_ARG1 },
+  { CMD_MEMZERO, 2, 0 },      { CMD_NUMBER, 3, 0 },       { CMD_PLAYVIDEO, 1, ARG_STREAM },
+  { CMD_PROGRESS, 4, 0 },     { CMD_REGREAD, 2, 0 },      { CMD_ROTATE, 1, 0 },
+  { CMD_SCALE, 2, 0 },        { CMD_SCREENSAVER, 0, 0 },  { CMD_SCROLLBAR, 4, 0 },
+  { CMD_SETBITMAP, 3, 0 },    { CMD_SETFONT, 2, 0 },      { CMD_SETMATRIX, 0, 0 },
+  { CMD_SETROTATE, 1, 0 },    { CMD_SKETCH, 4, 0 },       { CMD_SLIDER, 4, 0 },
+  { CMD_SNAPSHOT, 1, 0 },     { CMD_SPINNER, 2, 0 },      { CMD_STOP, 0, 0 },
+  { CMD_SWAP, 0, 0 },         { CMD_TEXT, 2, ARG_STRING }, { CMD_TOGGLE, 3, ARG_STRING },
+  { CMD_TRACK, 3, 0 },        { CMD_TRANSLATE, 2, 0 },    { CMD_VIDEOFRAME, 2, ARG_MEDIA },
+  { CMD_VIDEOSTART, 0, ARG_MEDIA },   { CMD_ROMFONT, 2, 0 },      { CMD_FLASHERASE, 0, 0 },
+  { CMD_FLASHWRITE, 2, ARG_DATA_ARG1 }, { CMD_FLASHREAD, 3, 0 }, { CMD_FLASHUPDATE, 3, 0 },
+  { CMD_FLASHDETACH, 0, 0 },  { CMD_FLASHATTACH, 0, 0 },  { CMD_FLASHFAST, 1, 0 },
+  { CMD_FLASHSPIDESEL, 0, 0 }, { CMD_FLASHSPITX, 1, ARG_DATA_ARG0 }, { CMD_FLASHSPIRX, 2, 0 },
+  { CMD_FLASHSOURCE, 1, 0 },  { CMD_CLEARCACHE, 0, 0 },   { CMD_ANIMDRAW, 1, 0 },
+  { CMD_ANIMFRAME, 3, 0 },    { CMD_ANIMSTART, 3, 0 },    { CMD_ANIMSTOP, 1, 0 },
+  { CMD_ANIMXY, 2, 0 },       { CMD_VIDEOSTARTF, 0, 0 },
+};
+
+// CMD_INFLATE in progress.  The decoder works a step at a time - a block header, a symbol, a stored byte - and
+// when the data for a step has not arrived yet it goes back to where the step started and waits for more.
+typedef struct
+{
+  uint8_t *In;                                   // Compressed data received and not yet used up
+  uint32_t InCount, InSize;
+  uint32_t Pos;                                  // Next byte of In
+  uint32_t Bits;                                 // Bits taken from In but not used yet, LSB first
+  uint8_t BitCount;
+  uint8_t Stage;
+  bool Final;                                    // The block being decoded is the last one
+  uint32_t Stored;                               // Bytes left in a stored block
+  uint32_t Dest, Out;
+  uint16_t LitCount[16], LitSym[288];
+  uint16_t DistCount[16], DistSym[30];
+} SimInflateState;
+
+struct SimDevice
+{
+  uint8_t *Mem;
+
+  // Configuration
+  uint32_t SpiHz;
+  uint32_t CsNs;
+  uint32_t CallNs;
+  uint32_t ChipId;
+  uint32_t MaxPolls;
+  bool Report;
+
+  // Chip state
+  bool Active;
+  uint64_t ActivePs;
+
+  // Transaction decoder
+  bool Selected;
+  uint8_t Hdr[3];
+  uint8_t HdrCount;
+  bool Writing;
+  bool CmdB;
+  bool DummyDone;
+  bool Ready;
+  uint32_t Addr;
+  uint32_t DataCount;
+  uint32_t WroteLo, WroteHi;
+  uint8_t CmdBPending;
+
+  // CoPro data stream in progress (CMD_LOADIMAGE, CMD_PLAYVIDEO, CMD_INFLATE)
+  uint32_t StreamCmd;
+  uint32_t StreamCount;
+  uint32_t StreamEnd;
+  uint8_t StreamLast[4];
+  bool StreamMedia;                              // The stream comes from the media FIFO
+  uint32_t MediaBase, MediaSize;                 // From CMD_MEDIAFIFO
+  uint16_t MediaResume;                          // REG_CMD_READ once the media stream is done
+
+  // AVI from CMD_VIDEOSTART, followed by CMD_VIDEOFRAME
+  uint32_t VideoPos;                             // Bytes of the file read so far
+  uint32_t VideoMoviEnd;                         // Where the movi list ends
+  uint32_t VideoLeft;                            // Bytes left of the chunk being read
+  uint32_t VideoDone;                            // CMD_VIDEOFRAME completion word
+  uint8_t VideoHdr[8];                           // Chunk id and size, or the last 8 bytes of the header
+  uint8_t VideoHdrCount;
+  SimInflateState Inflate;
+  uint32_t LastPtr;                              // End of the last CMD_INFLATE output, for CMD_GETPTR
+
+  // Attached flash, BT81x only.  It keeps its contents through resets.
+  uint8_t *Flash;
+  uint32_t FlashSize;
+  uint64_t BusyPs;                               // The CoPro is busy with a command until then
+  uint16_t BusyResume;                           // REG_CMD_READ once it is done
+
+  // Scripted touch input
+  uint16_t TouchX[SIM_SCRIPT_MAX], TouchY[SIM_SCRIPT_MAX];
+  uint32_t TouchHead, TouchTail;
+  uint8_t Tag[SIM_SCRIPT_MAX];
+  uint32_t TagPolls[SIM_SCRIPT_MAX];
+  uint32_t TagHead, TagTail;
+  uint32_t Polls;
+
+  // Scripted presses.  Each starts After ms past the end of the one before - the first, once the host first
+  // looks at the touch screen - and is held for Hold ms.
+  uint8_t PressTag[SIM_SCRIPT_MAX];
+  uint16_t PressX[SIM_SCRIPT_MAX], PressY[SIM_SCRIPT_MAX];
+  uint32_t PressAfter[SIM_SCRIPT_MAX], PressHold[SIM_SCRIPT_MAX];
+  uint32_t PressHead, PressTail;
+  bool PressAnchored;
+  uint64_t PressBasePs;                          // When the After of the press at PressHead counts from
+  bool Pressing;
+  uint8_t IntFlags;                              // REG_INT_FLAGS, cleared by reading
+
+  uint64_t TimePs;
+  uint64_t StatsPs;                              // TimePs when the statistics were last reset
+  SimStats Stats;
+};
+
+static SimDevice DefaultDevice;             // What the hw_api.h functions talk to
+
+// ***************************************************************************************************************
+// *** Memory helpers ********************************************************************************************
+// ***************************************************************************************************************
+
+static uint32_t Rd32(SimDevice *d, uint32_t a)
+{
+  const uint8_t *p = d->Mem + (a & SIM_MEM_MASK);
+  return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void Wr32(SimDevice *d, uint32_t a, uint32_t v)
+{
+  uint8_t *p = d->Mem + (a & SIM_MEM_MASK);
+  p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t Rd16(SimDevice *d, uint32_t a)
+{
+  return (uint16_t)(Rd32(d, a) & 0xFFFF);
+}
+
+static void Wr16(SimDevice *d, uint32_t a, uint16_t v)
+{
+  d->Mem[a & SIM_MEM_MASK] = (uint8_t)v;
+  d->Mem[(a + 1) & SIM_MEM_MASK] = (uint8_t)(v >> 8);
+}
+
+static uint32_t Crc32(const uint8_t *p, uint32_t n)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  int bit;
+
+  while (n--)
+  {
+    crc ^= *p++;
+    for (bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static uint32_t EnvU32(const char *name, uint32_t def)
+{
+  const char *v = getenv(name);
+  return (v && *v) ? (uint32_t)strtoul(v, NULL, 0) : def;
+}
+
+// ***************************************************************************************************************
+// *** Inflate ***************************************************************************************************
+// ***************************************************************************************************************
+// CMD_INFLATE takes a zlib stream - RFC 1950 around RFC 1951.  The decoding follows zlib's puff.c.
+
+enum { INFLATE_HEADER, INFLATE_BLOCK, INFLATE_STORED, INFLATE_CODES, INFLATE_TRAILER, INFLATE_DONE };
+
+static const uint16_t InfLenBase[29] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t InfLenExtra[29] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t InfDistBase[30] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+  4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t InfDistExtra[30] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t InfCodeLenOrder[19] =
+{
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+static void SimInflateStart(SimDevice *d, uint32_t Dest)
+{
+  SimInflateState *z = &d->Inflate;
+
+  z->InCount = z->Pos = 0;
+  z->Bits = 0;
+  z->BitCount = 0;
+  z->Stage = INFLATE_HEADER;
+  z->Final = false;
+  z->Dest = Dest;
+  z->Out = 0;
+}
+
+// Take Need bits (at most 16), or return false if they have not arrived yet
+static bool InflateBits(SimInflateState *z, uint8_t Need, uint32_t *Value)
+{
+  while (z->BitCount < Need)
+  {
+    if (z->Pos == z->InCount)
+      return false;
+    z->Bits |= (uint32_t)z->In[z->Pos++] << z->BitCount;
+    z->BitCount += 8;
+  }
+  *Value = z->Bits & ((1UL << Need) - 1);
+  z->Bits >>= Need;
+  z->BitCount -= Need;
+  return true;
+}
+
+// Canonical decoding table from code lengths: Count[n] codes of length n, Sym in code order.
+// Returns < 0 for an over-subscribed set of lengths.
+static int InflateTable(uint16_t *Count, uint16_t *Sym, const uint8_t *Len, int n)
+{
+  uint16_t Offs[16];
+  int i, Left = 1;
+
+  memset(Count, 0, 16 * sizeof(uint16_t));
+  for (i = 0; i < n; i++)
+    Count[Len[i]]++;
+  if (Count[0] == n)
+    return 0;
+  for (i = 1; i < 16; i++)
+  {
+    Left = (Left << 1) - Count[i];
+    if (Left < 0)
+      return -1;
+  }
+  Offs[1] = 0;
+  for (i = 1; i < 15; i++)
+    Offs[i + 1] = Offs[i] + Count[i];
+  for (i = 0; i < n; i++)
+    if (Len[i])
+      Sym[Offs[Len[i]]++] = (uint16_t)i;
+  return Left;
+}
+
+// One symbol, -1 if more data is needed or -2 for a code that is not in the table
+static int InflateSymbol(SimInflateState *z, const uint16_t *Count, const uint16_t *Sym)
+{
+  int Code = 0, First = 0, Index = 0, Len;
+  uint32_t b;
+
+  for (Len = 1; Len < 16; Len++)
+  {
+    if (!InflateBits(z, 1, &b))
+      return -1;
+    Code |= (int)b;
+    if (Code - Count[Len] < First)
+      return Sym[Index + (Code - First)];
+    Index += Count[Len];
+    First = (First + Count[Len]) << 1;
+    Code <<= 1;
+  }
+  return -2;
+}
+
+// The tables of a dynamic block - RFC 1951 section 3.2.7.  Only stored in z once they are all there.
+static int InflateDynamic(SimInflateState *z)
+{
+  uint16_t LitCount[16], LitSym[288], DistCount[16], DistSym[30], CLCount[16], CLSym[19];
+  uint8_t Len[288 + 30], CLLen[19] = { 0 };
+  uint32_t HLit, HDist, HCLen, v, Rep;
+  int i, Sym;
+
+  if (!InflateBits(z, 5, &HLit) || !InflateBits(z, 5, &HDist) || !InflateBits(z, 4, &HCLen))
+    return 0;
+  HLit += 257;
+  HDist += 1;
+  HCLen += 4;
+  if (HLit > 286 || HDist > 30)
+    return -1;
+  for (i = 0; i < (int)HCLen; i++)
+  {
+    if (!InflateBits(z, 3, &v))
+      return 0;
+    CLLen[InfCodeLenOrder[i]] = (uint8_t)v;
+  }
+  if (InflateTable(CLCount, CLSym, CLLen, 19) != 0)
+    return -1;                                   // The code length code has to be complete
+
+  for (i = 0; i < (int)(HLit + HDist); )
+  {
+    Sym = InflateSymbol(z, CLCount, CLSym);
+    if (Sym == -1)
+      return 0;
+    if (Sym < 0)
+      return -1;
+    if (Sym < 16)
+    {
+      Len[i++] = (uint8_t)Sym;
+      continue;
+    }
+    if (Sym == 16)
+    {
+      if (!i || !InflateBits(z, 2, &Rep))
+        return i ? 0 : -1;
+      Rep += 3;
+      v = Len[i - 1];
+    }
+    else
+    {
+      if (!InflateBits(z, Sym == 17 ? 3 : 7, &Rep))
+        return 0;
+      Rep += Sym == 17 ? 3 : 11;
+      v = 0;
+    }
+    if (i + Rep > HLit + HDist)
+      return -1;
+    while (Rep--)
+      Len[i++] = (uint8_t)v;
+  }
+  if (InflateTable(LitCount, LitSym, Len, HLit) < 0 || InflateTable(DistCount, DistSym, Len + HLit, HDist) < 0)
+    return -1;
+
+  memcpy(z->LitCount, LitCount, sizeof(LitCount));
+  memcpy(z->LitSym, LitSym, sizeof(LitSym));
+  memcpy(z->DistCount, DistCount, sizeof(DistCount));
+  memcpy(z->DistSym, DistSym, sizeof(DistSym));
+  return 1;
+}
+
+static void InflateFixed(SimInflateState *z)
+{
+  uint8_t Len[288];
+  int i;
+
+  for (i = 0; i < 288; i++)
+    Len[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+  InflateTable(z->LitCount, z->LitSym, Len, 288);
+  for (i = 0; i < 30; i++)
+    Len[i] = 5;
+  InflateTable(z->DistCount, z->DistSym, Len, 30);
+}
+
+// One step of decoding.  Returns 1 for progress, 0 if the data for the step is not all there, -1 for bad data.
+static int SimInflateStep(SimDevice *d)
+{
+  SimInflateState *z = &d->Inflate;
+  uint32_t v, Type, Len, Dist, Extra;
+  int Sym, r;
+
+  switch (z->Stage)
+  {
+  case INFLATE_HEADER:
+    if (!InflateBits(z, 8, &v) || !InflateBits(z, 8, &Extra))
+      return 0;
+    if ((v & 0x0F) != 8 || ((v << 8) | Extra) % 31 || (Extra & 0x20))
+      return -1;                                 // Not deflate, or wants a preset dictionary
+    z->Stage = INFLATE_BLOCK;
+    return 1;
+
+  case INFLATE_BLOCK:
+    if (!InflateBits(z, 1, &v) || !InflateBits(z, 2, &Type))
+      return 0;
+    if (Type == 0)
+    {
+      z->Bits = 0;                               // Stored blocks start on a byte boundary
+      z->BitCount = 0;
+      if (!InflateBits(z, 16, &Len) || !InflateBits(z, 16, &Extra))
+        return 0;
+      if (Len != (~Extra & 0xFFFF))
+        return -1;
+      z->Stored = Len;
+      z->Stage = INFLATE_STORED;
+    }
+    else if (Type == 1)
+    {
+      InflateFixed(z);
+      z->Stage = INFLATE_CODES;
+    }
+    else if (Type == 2)
+    {
+      if ((r = InflateDynamic(z)) <= 0)
+        return r;
+      z->Stage = INFLATE_CODES;
+    }
+    else
+      return -1;
+    z->Final = v != 0;
+    return 1;
+
+  case INFLATE_STORED:
+    if (z->Stored)
+    {
+      if (!InflateBits(z, 8, &v))
+        return 0;
+      d->Mem[(z->Dest + z->Out++) & SIM_MEM_MASK] = (uint8_t)v;
+      z->Stored--;
+      return 1;
+    }
+    z->Stage = z->Final ? INFLATE_TRAILER : INFLATE_BLOCK;
+    return 1;
+
+  case INFLATE_CODES:
+    Sym = InflateSymbol(z, z->LitCount, z->LitSym);
+    if (Sym == -1)
+      return 0;
+    if (Sym < 0 || Sym > 285)
+      return -1;
+    if (Sym < 256)
+    {
+      d->Mem[(z->Dest + z->Out++) & SIM_MEM_MASK] = (uint8_t)Sym;
+      return 1;
+    }
+    if (Sym == 256)
+    {
+      z->Stage = z->Final ? INFLATE_TRAILER : INFLATE_BLOCK;
+      return 1;
+    }
+    Sym -= 257;
+    if (!InflateBits(z, InfLenExtra[Sym], &Extra))
+      return 0;
+    Len = InfLenBase[Sym] + Extra;
+    Sym = InflateSymbol(z, z->DistCount, z->DistSym);
+    if (Sym == -1)
+      return 0;
+    if (Sym < 0 || Sym > 29)
+      return -1;
+    if (!InflateBits(z, InfDistExtra[Sym], &Extra))
+      return 0;
+    Dist = InfDistBase[Sym] + Extra;
+    if (Dist > z->Out)
+      return -1;                                 // Reaches back before the start of the output
+    while (Len--)
+    {
+      d->Mem[(z->Dest + z->Out) & SIM_MEM_MASK] = d->Mem[(z->Dest + z->Out - Dist) & SIM_MEM_MASK];
+      z->Out++;
+    }
+    return 1;
+
+  case INFLATE_TRAILER:
+    z->Bits = 0;
+    z->BitCount = 0;
+    if (!InflateBits(z, 16, &v) || !InflateBits(z, 16, &v))
+      return 0;                                  // Adler-32 of the output - taken but not checked
+    z->Stage = INFLATE_DONE;
+    d->LastPtr = z->Dest + z->Out;
+    return 1;
+  }
+  return -1;
+}
+
+// Feed one byte of the stream.  Returns 1 once the stream is complete, 0 while it is not, -1 for bad data.
+static int SimInflateByte(SimDevice *d, uint8_t b)
+{
+  SimInflateState *z = &d->Inflate;
+  uint32_t Pos, Bits;
+  uint8_t BitCount;
+  int r;
+
+  if (z->Pos > 65536)                            // Drop what has been used up
+  {
+    memmove(z->In, z->In + z->Pos, z->InCount - z->Pos);
+    z->InCount -= z->Pos;
+    z->Pos = 0;
+  }
+  if (z->InCount == z->InSize)
+  {
+    z->InSize = z->InSize ? z->InSize * 2 : 4096;
+    z->In = (uint8_t*)realloc(z->In, z->InSize);
+    if (!z->In)
+    {
+      fprintf(stderr, "eve-sim: out of memory\n");
+      exit(1);
+    }
+  }
+  z->In[z->InCount++] = b;
+
+  for (;;)
+  {
+    Pos = z->Pos;
+    Bits = z->Bits;
+    BitCount = z->BitCount;
+    r = SimInflateStep(d);
+    if (r < 0)
+      return -1;
+    if (r == 0)
+    {
+      z->Pos = Pos;                              // Try the step again when there is more
+      z->Bits = Bits;
+      z->BitCount = BitCount;
+      return 0;
+    }
+    if (z->Stage == INFLATE_DONE)
+      return 1;
+  }
+}
+
+// ***************************************************************************************************************
+// *** Chip level behaviour **************************************************************************************
+// ***************************************************************************************************************
+
+static void SimPowerOn(SimDevice *d)
+{
+  memset(d->Mem, 0, SIM_MEM_SIZE);
+  d->Active = false;
+  d->StreamCmd = 0;
+  d->StreamMedia = false;
+  d->MediaSize = 0;
+  d->BusyPs = 0;
+  d->IntFlags = 0;
+}
+
+static void SimHostCommand(SimDevice *d, uint8_t hcmd)
+{
+  d->Stats.HostCommands++;
+  switch (hcmd)
+  {
+  case HCMD_ACTIVE:
+    if (!d->Active)
+    {
+      d->Active = true;
+      d->ActivePs = d->TimePs;
+      Wr32(d, REG_CHIP_ID, ((d->ChipId & 0xFF) << 8) | ((d->ChipId >> 8) & 0xFF) | 0x00010000); // e.g. 08 15 01 00
+      Wr32(d, REG(REG_ID), 0x7C);
+      Wr32(d, REG(REG_FREQUENCY), 60000000);
+      if (d->FlashSize)
+      {
+        Wr32(d, REG(REG_FLASH_STATUS), FLASH_STATUS_BASIC);
+        Wr32(d, REG(REG_FLASH_SIZE), d->FlashSize >> 20);
+      }
+    }
+    break;
+  case HCMD_PWRDOWN:
+  case HCMD_CORERESET:
+    SimPowerOn(d);
+    break;
+  default:                                       // Clock selection and friends make no difference here
+    break;
+  }
+}
+
+static bool SimReady(SimDevice *d)
+{
+  return d->Active && (d->TimePs - d->ActivePs) >= SIM_BOOT_NS * 1000ULL;
+}
+
+static void SimFault(SimDevice *d, const char *msg)
+{
+  d->Stats.Faults++;
+  Wr16(d, REG(REG_CMD_READ), 0xFFF);
+  memset(d->Mem + RAM_ERR_REPORT, 0, 128);
+  strncpy((char*)d->Mem + RAM_ERR_REPORT, msg, 127);
+  d->StreamCmd = 0;                              // Whatever the CoPro was in the middle of is abandoned
+  d->StreamMedia = false;
+}
+
+// Word n of the command sitting at FIFO offset rd
+static uint32_t FifoWord(SimDevice *d, uint16_t rd, uint32_t n)
+{
+  return Rd32(d, RAM_CMD + ((rd + n * 4) & (FT_CMD_FIFO_SIZE - 1)));
+}
+
+static void FifoSetWord(SimDevice *d, uint16_t rd, uint32_t n, uint32_t v)
+{
+  Wr32(d, RAM_CMD + ((rd + n * 4) & (FT_CMD_FIFO_SIZE - 1)), v);
+}
+
+static void SimDL(SimDevice *d, uint32_t word)
+{
+  uint32_t dl = Rd32(d, REG(REG_CMD_DL));
+
+  if (dl < FT_DL_SIZE)
+  {
+    Wr32(d, RAM_DL + dl, word);
+    Wr32(d, REG(REG_CMD_DL), dl + 4);
+  }
+}
+
+// Flash commands need the flash in at least the given state, and their addresses aligned and in range
+static bool SimFlashOk(SimDevice *d, uint32_t Status, bool Aligned, uint32_t Addr, uint32_t Num)
+{
+  if (!d->FlashSize || Rd32(d, REG(REG_FLASH_STATUS)) < Status)
+  {
+    SimFault(d, Status == FLASH_STATUS_FULL ? "sim: flash not in full mode" : "sim: flash not attached");
+    return false;
+  }
+  if (!Aligned || Addr > d->FlashSize || Num > d->FlashSize - Addr)
+  {
+    SimFault(d, "sim: bad flash address");
+    return false;
+  }
+  return true;
+}
+
+static void SimBusy(SimDevice *d, uint64_t Ns)
+{
+  d->BusyPs = d->TimePs + Ns * 1000;
+}
+
+// Execute the command at FIFO offset rd with avail bytes present.
+// Return the number of bytes consumed, or 0 if the command is not all there yet.
+static uint32_t SimCoProCommand(SimDevice *d, uint16_t rd, uint32_t avail)
+{
+  uint32_t cmd = FifoWord(d, rd, 0);
+  const SimCmdInfo *info = NULL;
+  uint32_t need, i, n, Changed;
+
+  if ((cmd & 0xFFFFFF00) != 0xFFFFFF00)          // Plain display list command
+  {
+    SimDL(d, cmd);
+    return 4;
+  }
+
+  for (i = 0; i < sizeof(SimCmds) / sizeof(SimCmds[0]); i++)
+  {
+    if (SimCmds[i].Cmd == cmd)
+    {
+      info = &SimCmds[i];
+      break;
+    }
+  }
+  if (!info)
+  {
+    SimFault(d, "sim: unknown command");
+    return 0;
+  }
+
+  need = 4 + info->Words * 4;
+  if (avail < need)
+    return 0;
+
+  if (info->Flags & ARG_STRING)
+  {
+    for (n = need; n < avail; n++)
+      if (d->Mem[RAM_CMD + ((rd + n) & (FT_CMD_FIFO_SIZE - 1))] == 0)
+        break;
+    if (n == avail)
+      return 0;                                  // Terminator has not arrived yet
+    need = (n + 4) & ~3UL;
+  }
+  else if (info->Flags & (ARG_DATA_ARG1 | ARG_DATA_ARG0))
+  {
+    n = FifoWord(d, rd, (info->Flags & ARG_DATA_ARG1) ? 2 : 1);
+    need += (n + 3) & ~3UL;
+    if (need > FT_CMD_FIFO_SIZE - 4)
+    {
+      SimFault(d, "sim: inline data larger than the FIFO");
+      return 0;
+    }
+    if (avail < need)
+      return 0;
+  }
+  else if (info->Flags & ARG_MEDIA)
+  {
+    if (!d->MediaSize)
+    {
+      SimFault(d, "sim: no media FIFO");
+      return 0;
+    }
+    d->StreamCmd = cmd;
+    d->StreamMedia = true;
+    d->StreamCount = 0;
+    if (cmd == CMD_VIDEOSTART)
+      d->VideoPos = 0;
+    else
+      d->VideoDone = FifoWord(d, rd, 2);
+    d->VideoHdrCount = 0;
+  }
+  else if (info->Flags & ARG_STREAM)
+  {
+    n = (cmd == CMD_INFLATE) ? 0 : FifoWord(d, rd, info->Words);   // Options, where the command has them
+    if (!(n & OPT_FLASH))
+    {
+      if ((n & OPT_MEDIAFIFO) && !d->MediaSize)
+      {
+        SimFault(d, "sim: no media FIFO");
+        return 0;
+      }
+      d->StreamCmd = cmd;                       // The data follows in the FIFO, or in the media FIFO
+      d->StreamMedia = (n & OPT_MEDIAFIFO) != 0;
+      d->StreamCount = 0;
+      d->StreamEnd = 0;
+      if (cmd == CMD_INFLATE || cmd == CMD_INFLATE2)
+        SimInflateStart(d, FifoWord(d, rd, 1));
+    }
+  }
+
+  d->Stats.CoProCommands++;
+  switch (cmd)
+  {
+  case CMD_DLSTART:
+    Wr32(d, REG(REG_CMD_DL), 0);
+    break;
+  case CMD_SWAP:
+    d->Stats.Swaps++;
+    break;
+  case CMD_APPEND:
+    for (i = 0; i < FifoWord(d, rd, 2); i += 4)
+      SimDL(d, Rd32(d, FifoWord(d, rd, 1) + i));
+    break;
+  case CMD_MEMCPY:
+    memmove(d->Mem + (FifoWord(d, rd, 1) & SIM_MEM_MASK), d->Mem + (FifoWord(d, rd, 2) & SIM_MEM_MASK), FifoWord(d, rd, 3) & SIM_MEM_MASK);
+    break;
+  case CMD_MEMSET:
+    memset(d->Mem + (FifoWord(d, rd, 1) & SIM_MEM_MASK), (int)FifoWord(d, rd, 2), FifoWord(d, rd, 3) & SIM_MEM_MASK);
+    break;
+  case CMD_MEMZERO:
+    memset(d->Mem + (FifoWord(d, rd, 1) & SIM_MEM_MASK), 0, FifoWord(d, rd, 2) & SIM_MEM_MASK);
+    break;
+  case CMD_MEMWRITE:
+    n = FifoWord(d, rd, 2);
+    for (i = 0; i < n; i++)
+      d->Mem[(FifoWord(d, rd, 1) + i) & SIM_MEM_MASK] = d->Mem[RAM_CMD + ((rd + 12 + i) & (FT_CMD_FIFO_SIZE - 1))];
+    break;
+  case CMD_MEMCRC:
+    FifoSetWord(d, rd, 3, Crc32(d->Mem + (FifoWord(d, rd, 1) & SIM_MEM_MASK), FifoWord(d, rd, 2) & SIM_MEM_MASK));
+    break;
+  case CMD_REGREAD:
+    FifoSetWord(d, rd, 2, Rd32(d, FifoWord(d, rd, 1)));
+    break;
+  case CMD_CALIBRATE:
+    FifoSetWord(d, rd, 1, 1);
+    break;
+  case CMD_MEDIAFIFO:
+    d->MediaBase = FifoWord(d, rd, 1) & SIM_MEM_MASK;
+    d->MediaSize = FifoWord(d, rd, 2);
+    Wr32(d, REG(REG_MEDIAFIFO_READ), 0);
+    Wr32(d, REG(REG_MEDIAFIFO_WRITE), 0);
+    break;
+  case CMD_GETPTR:
+    FifoSetWord(d, rd, 1, d->LastPtr);
+    break;
+  case CMD_FLASHATTACH:
+  case CMD_FLASHDETACH:
+    if (d->FlashSize)
+      Wr32(d, REG(REG_FLASH_STATUS), cmd == CMD_FLASHATTACH ? FLASH_STATUS_BASIC : FLASH_STATUS_DETACHED);
+    break;
+  case CMD_FLASHFAST:
+    if (d->FlashSize && Rd32(d, REG(REG_FLASH_STATUS)) >= FLASH_STATUS_BASIC)
+    {
+      Wr32(d, REG(REG_FLASH_STATUS), FLASH_STATUS_FULL);
+      FifoSetWord(d, rd, 1, 0);
+    }
+    else
+      FifoSetWord(d, rd, 1, 0xE001);             // Not attached
+    break;
+  case CMD_FLASHERASE:
+    if (!SimFlashOk(d, FLASH_STATUS_FULL, true, 0, 0))
+      return 0;
+    memset(d->Flash, 0xFF, d->FlashSize);
+    d->Stats.FlashSectors += d->FlashSize / SIM_FLASH_SECTOR;
+    SimBusy(d, (d->FlashSize / SIM_FLASH_SECTOR) * SIM_SECTOR_NS);
+    break;
+  case CMD_FLASHWRITE:                           // Programming can only clear bits
+    n = FifoWord(d, rd, 2);
+    if (!SimFlashOk(d, FLASH_STATUS_FULL, !(FifoWord(d, rd, 1) & 255) && !(n & 255), FifoWord(d, rd, 1), n))
+      return 0;
+    for (i = 0; i < n; i++)
+      d->Flash[FifoWord(d, rd, 1) + i] &= d->Mem[RAM_CMD + ((rd + 12 + i) & (FT_CMD_FIFO_SIZE - 1))];
+    SimBusy(d, (n / 256) * SIM_PAGE_NS);
+    break;
+  case CMD_FLASHREAD:
+    n = FifoWord(d, rd, 3);
+    if (!SimFlashOk(d, FLASH_STATUS_BASIC, !(FifoWord(d, rd, 1) & 3) && !(FifoWord(d, rd, 2) & 63) && !(n & 3), FifoWord(d, rd, 2), n))
+      return 0;
+    for (i = 0; i < n; i++)
+      d->Mem[(FifoWord(d, rd, 1) + i) & SIM_MEM_MASK] = d->Flash[FifoWord(d, rd, 2) + i];
+    break;
+  case CMD_FLASHUPDATE:                          // Only the sectors that differ are erased and programmed
+    n = FifoWord(d, rd, 3);
+    if (!SimFlashOk(d, FLASH_STATUS_FULL, !(FifoWord(d, rd, 1) & 4095) && !(FifoWord(d, rd, 2) & 3) && !(n & 4095), FifoWord(d, rd, 1), n))
+      return 0;
+    for (i = 0, Changed = 0; i < n; i += SIM_FLASH_SECTOR)
+    {
+      uint8_t *Sector = d->Flash + FifoWord(d, rd, 1) + i;
+      uint8_t *Src = d->Mem + ((FifoWord(d, rd, 2) + i) & SIM_MEM_MASK);
+
+      if (memcmp(Sector, Src, SIM_FLASH_SECTOR))
+      {
+        memcpy(Sector, Src, SIM_FLASH_SECTOR);
+        Changed++;
+      }
+    }
+    d->Stats.FlashSectors += Changed;
+    SimBusy(d, Changed * SIM_SECTOR_NS);
+    break;
+  default:
+    break;
+  }
+  return need;
+}
+
+// One byte of an AVI for CMD_VIDEOSTART or CMD_VIDEOFRAME.  Return true once the command has what it needs.
+static bool SimVideoByte(SimDevice *d, uint8_t b)
+{
+  uint32_t Size;
+
+  d->VideoPos++;
+  if (d->StreamCmd == CMD_VIDEOSTART)              // Skip to the start of the movi list
+  {
+    memmove(d->VideoHdr, d->VideoHdr + 1, 7);
+    d->VideoHdr[7] = b;
+    if (d->VideoPos < 12 || memcmp(d->VideoHdr + 4, "movi", 4))
+      return false;
+    Size = d->VideoHdr[0] | ((uint32_t)d->VideoHdr[1] << 8) | ((uint32_t)d->VideoHdr[2] << 16) | ((uint32_t)d->VideoHdr[3] << 24);
+    d->VideoMoviEnd = d->VideoPos - 4 + Size;
+    return true;
+  }
+
+  if (d->VideoHdrCount < 8)                        // Chunk id and size
+  {
+    d->VideoHdr[d->VideoHdrCount++] = b;
+    if (d->VideoHdrCount < 8)
+      return false;
+    d->VideoLeft = d->VideoHdr[4] | ((uint32_t)d->VideoHdr[5] << 8) | ((uint32_t)d->VideoHdr[6] << 16) | ((uint32_t)d->VideoHdr[7] << 24);
+    d->VideoLeft += d->VideoLeft & 1;              // Chunks are padded to an even size
+    if (d->VideoLeft)
+      return false;
+  }
+  else if (--d->VideoLeft)
+    return false;
+
+  d->VideoHdrCount = 0;                            // End of a chunk - a frame, or something else to skip
+  if (d->VideoHdr[2] == 'd' && (d->VideoHdr[3] == 'c' || d->VideoHdr[3] == 'b'))
+  {
+    Wr32(d, d->VideoDone & SIM_MEM_MASK, d->VideoPos < d->VideoMoviEnd);
+    return true;
+  }
+  if (d->VideoPos >= d->VideoMoviEnd)
+  {
+    Wr32(d, d->VideoDone & SIM_MEM_MASK, 0);
+    return true;
+  }
+  return false;
+}
+
+// Feed one byte of a data stream to the command that owns it.  Return true once the stream is complete.
+static bool SimStreamByte(SimDevice *d, uint8_t b)
+{
+  uint32_t n = d->StreamCount++;
+
+  d->StreamLast[0] = d->StreamLast[1];
+  d->StreamLast[1] = d->StreamLast[2];
+  d->StreamLast[2] = d->StreamLast[3];
+  d->StreamLast[3] = b;
+
+  if (d->StreamCmd == CMD_INFLATE || d->StreamCmd == CMD_INFLATE2)
+  {
+    int r = SimInflateByte(d, b);
+
+    if (r < 0)
+      SimFault(d, "sim: corrupted inflate data");
+    return r != 0;
+  }
+  if (d->StreamCmd == CMD_VIDEOSTART || d->StreamCmd == CMD_VIDEOFRAME)
+    return SimVideoByte(d, b);
+  if (d->StreamCmd == CMD_PLAYVIDEO)
+  {
+    if (n == 7)                                  // RIFF chunk size is in bytes 4 to 7
+      d->StreamEnd = (d->StreamLast[0] | ((uint32_t)d->StreamLast[1] << 8) | ((uint32_t)d->StreamLast[2] << 16) | ((uint32_t)b << 24)) + 8;
+    return d->StreamEnd && d->StreamCount >= d->StreamEnd;
+  }
+  if (d->StreamCmd == CMD_LOADIMAGE)
+  {
+    if (d->StreamEnd)                           // PNG: counting down the CRC after IEND
+      return d->StreamCount >= d->StreamEnd;
+    if (d->StreamLast[2] == 0xFF && b == 0xD9)  // JPEG: end of image marker
+      return true;
+    if (!memcmp(d->StreamLast, "IEND", 4))
+      d->StreamEnd = d->StreamCount + 4;
+  }
+  return false;
+}
+
+// Consume stream data from the FIFO a word at a time.  Return the bytes used.
+static uint32_t SimStream(SimDevice *d, uint16_t rd, uint32_t avail)
+{
+  uint32_t used, i;
+  bool done = false;
+
+  for (used = 0; used + 4 <= avail && !done; used += 4)
+    for (i = 0; i < 4 && !done; i++)
+      done = SimStreamByte(d, d->Mem[RAM_CMD + ((rd + used + i) & (FT_CMD_FIFO_SIZE - 1))]);
+  if (done)
+    d->StreamCmd = 0;                           // Whatever is left of the last word is padding
+  return used;
+}
+
+// Consume stream data from the media FIFO, as much as there is.  Return true once the stream is complete.
+static bool SimMediaStream(SimDevice *d)
+{
+  uint32_t rd = Rd32(d, REG(REG_MEDIAFIFO_READ)), wr = Rd32(d, REG(REG_MEDIAFIFO_WRITE));
+  bool done = false;
+
+  if (rd >= d->MediaSize || wr >= d->MediaSize)
+  {
+    SimFault(d, "sim: media FIFO pointer out of range");
+    return false;
+  }
+  while (rd != wr && !done)
+  {
+    done = SimStreamByte(d, d->Mem[(d->MediaBase + rd) & SIM_MEM_MASK]);
+    rd = (rd + 1) % d->MediaSize;
+  }
+  Wr32(d, REG(REG_MEDIAFIFO_READ), rd);
+  if (done)
+  {
+    d->StreamCmd = 0;
+    d->StreamMedia = false;
+  }
+  return done;
+}
+
+static void SimCoProRun(SimDevice *d)
+{
+  uint16_t rd, wr;
+  uint32_t used;
+
+  for (;;)
+  {
+    rd = Rd16(d, REG(REG_CMD_READ));
+    wr = Rd16(d, REG(REG_CMD_WRITE)) & (FT_CMD_FIFO_SIZE - 1);
+    if (rd == 0xFFF || (d->Mem[REG(REG_CPU_RESET)] & 1))
+      return;
+    if (d->BusyPs)                               // Still erasing or programming flash
+    {
+      if (d->TimePs < d->BusyPs)
+        return;
+      d->BusyPs = 0;
+      Wr16(d, REG(REG_CMD_READ), d->BusyResume);
+      continue;
+    }
+    if (d->StreamMedia)                          // Busy with the media FIFO until the stream ends
+    {
+      if (!SimMediaStream(d))
+        return;
+      if (Rd16(d, REG(REG_CMD_READ)) != 0xFFF)
+        Wr16(d, REG(REG_CMD_READ), d->MediaResume);
+      continue;
+    }
+    if (rd == wr)
+      return;
+    if (d->StreamCmd)
+      used = SimStream(d, rd, (wr - rd) & (FT_CMD_FIFO_SIZE - 1));
+    else
+      used = SimCoProCommand(d, rd, (wr - rd) & (FT_CMD_FIFO_SIZE - 1));
+    if (!used)
+      return;
+    if (Rd16(d, REG(REG_CMD_READ)) == 0xFFF)      // The command faulted
+      return;
+    if (d->StreamMedia)                             // REG_CMD_READ stays on the command until it is done
+    {
+      d->MediaResume = (rd + used) & (FT_CMD_FIFO_SIZE - 1);
+      continue;
+    }
+    if (d->BusyPs)
+    {
+      d->BusyResume = (rd + used) & (FT_CMD_FIFO_SIZE - 1);
+      continue;
+    }
+    Wr16(d, REG(REG_CMD_READ), (rd + used) & (FT_CMD_FIFO_SIZE - 1));
+  }
+}
+
+// ***************************************************************************************************************
+// *** Touch *****************************************************************************************************
+// ***************************************************************************************************************
+
+// When the press at the head of the script starts and ends
+static bool SimPressTimes(SimDevice *d, uint64_t *StartPs, uint64_t *EndPs)
+{
+  uint32_t h = d->PressHead;
+
+  if (h == d->PressTail)
+    return false;
+  if (!d->PressAnchored)
+  {
+    d->PressAnchored = true;
+    d->PressBasePs = d->TimePs;
+  }
+  *StartPs = d->PressBasePs + (uint64_t)d->PressAfter[h] * 1000000000ULL;
+  *EndPs = *StartPs + (uint64_t)d->PressHold[h] * 1000000000ULL;
+  return true;
+}
+
+// Bring the scripted presses up to the current time, raising INT_TOUCH and INT_TAG as they start and end
+static void SimTouchUpdate(SimDevice *d)
+{
+  uint64_t Start, End;
+  uint8_t TagInt;
+
+  while (SimPressTimes(d, &Start, &End))
+  {
+    TagInt = d->PressTag[d->PressHead] ? INT_TAG : 0;
+    if (!d->Pressing)
+    {
+      if (d->TimePs < Start)
+        break;
+      d->Pressing = true;
+      d->IntFlags |= INT_TOUCH | TagInt;
+    }
+    if (d->TimePs < End)
+      break;
+    d->Pressing = false;
+    d->IntFlags |= TagInt;
+    d->PressBasePs = End;
+    d->PressHead = (d->PressHead + 1) % SIM_SCRIPT_MAX;
+  }
+}
+
+static void SimTouchRegs(SimDevice *d)
+{
+  uint32_t h, XY = 0x80008000;                   // Not touched
+
+  SimTouchUpdate(d);
+  h = d->PressHead;
+  if (d->Pressing)
+    XY = ((uint32_t)d->PressX[h] << 16) | d->PressY[h];
+  Wr32(d, REG(REG_TOUCH_SCREEN_XY), XY);
+  Wr32(d, REG(REG_TOUCH_TAG_XY), XY);
+  Wr32(d, REG(REG_TOUCH_TAG), d->Pressing ? d->PressTag[h] : 0);
+
+  // One finger at a time - the other capacitive points are never down
+  Wr32(d, REG(REG_CTOUCH_TOUCH1_XY), 0x80008000);
+  Wr32(d, REG(REG_CTOUCH_TOUCH2_XY), 0x80008000);
+  Wr32(d, REG(REG_CTOUCH_TOUCH3_XY), 0x80008000);
+  Wr16(d, REG(REG_CTOUCH_TOUCH4_X), 0x8000);
+  Wr16(d, REG(REG_CTOUCH_TOUCH4_Y), 0x8000);
+}
+
+// INT is active low when enabled and an unmasked flag is set
+static bool SimIrq(SimDevice *d)
+{
+  return (d->Mem[REG(REG_INT_EN)] & 1) && (d->IntFlags & d->Mem[REG(REG_INT_MASK)]);
+}
+
+// The host looked at the touch screen - enough of that ends the run with EVE_SIM_MAX_POLLS
+static void SimTouchPolled(SimDevice *d)
+{
+  if (d->MaxPolls && ++d->Polls >= d->MaxPolls)
+  {
+    SimDev_PrintStats(d, "eve-sim");
+    exit(0);
+  }
+}
+
+// Fill in the registers that are computed rather than stored, just ahead of a read from addr
+static void SimPrepareRead(SimDevice *d, uint32_t addr)
+{
+  uint16_t rd, wr;
+  uint64_t ns = d->TimePs / 1000;
+
+  if (d->BusyPs && d->TimePs >= d->BusyPs)
+    SimCoProRun(d);                              // Done with the flash - on to the rest of the FIFO
+  rd = Rd16(d, REG(REG_CMD_READ));
+  wr = Rd16(d, REG(REG_CMD_WRITE));
+
+  Wr32(d, REG(REG_CMDB_SPACE), (FT_CMD_FIFO_SIZE - 4) - ((wr - rd) & (FT_CMD_FIFO_SIZE - 1)));
+  Wr32(d, REG(REG_FRAMES), d->Mem[REG(REG_PCLK)] ? (uint32_t)(ns / SIM_FRAME_NS) : 0);
+  Wr32(d, REG(REG_CLOCK), (uint32_t)(ns * (Rd32(d, REG(REG_FREQUENCY)) / 1000000) / 1000));
+
+  if (addr == REG(REG_TOUCH_DIRECT_XY))
+  {
+    if (d->TouchHead != d->TouchTail)
+    {
+      Wr32(d, addr, ((uint32_t)d->TouchX[d->TouchHead] << 16) | d->TouchY[d->TouchHead]);
+      d->TouchHead = (d->TouchHead + 1) % SIM_SCRIPT_MAX;
+    }
+    else
+      Wr32(d, addr, 0x80008000);                    // Not touched
+  }
+  else if (addr == REG(REG_INT_FLAGS))
+  {
+    SimTouchUpdate(d);
+    Wr32(d, addr, d->IntFlags);
+    d->IntFlags = 0;
+    SimTouchPolled(d);
+  }
+  else if (addr >= REG(REG_CTOUCH_TOUCH1_XY) && addr <= REG(REG_TOUCH_TAG))
+  {
+    SimTouchRegs(d);
+    if (addr == REG(REG_TOUCH_TAG) && d->TagHead != d->TagTail)    // The polled script wins over presses
+    {
+      Wr32(d, addr, d->Tag[d->TagHead]);
+      if (--d->TagPolls[d->TagHead] == 0)
+        d->TagHead = (d->TagHead + 1) % SIM_SCRIPT_MAX;
+    }
+    SimTouchPolled(d);
+  }
+}
+
+// Bookkeeping once the chip select goes away
+static void SimEndTransaction(SimDevice *d)
+{
+  if (d->HdrCount == 3 && d->DataCount == 0 && (d->Hdr[0] & 0xC0) != 0x80)
+  {
+    if ((d->Hdr[0] & 0xC0) == 0x40 || (d->Hdr[0] == 0 && d->Hdr[1] == 0 && d->Hdr[2] == 0))
+      SimHostCommand(d, d->Hdr[0]);
+    return;
+  }
+
+  if (!d->Writing || d->HdrCount < 3)
+    return;
+
+  if (d->CmdB)
+  {
+    SimCoProRun(d);
+    return;
+  }
+
+#define WROTE(a) (d->WroteLo <= (a) && (a) < d->WroteHi)
+  if (WROTE(REG(REG_DLSWAP)) && d->Mem[REG(REG_DLSWAP)])
+  {
+    d->Stats.DLSwaps++;
+    Wr32(d, REG(REG_DLSWAP), 0);                    // Swap happens - the register reads back as done
+  }
+  if (WROTE(REG(REG_CMD_WRITE)) || WROTE(REG(REG_CPU_RESET)) || WROTE(REG(REG_MEDIAFIFO_WRITE)))
+    SimCoProRun(d);
+#undef WROTE
+}
+
+// One byte on the wire in each direction
+static uint8_t SimClock(SimDevice *d, uint8_t mosi)
+{
+  uint8_t miso = 0;
+
+  d->TimePs += 8000000000000ULL / d->SpiHz;
+  if (!d->Selected)
+    return 0;
+
+  if (d->HdrCount < 3)
+  {
+    d->Hdr[d->HdrCount++] = mosi;
+    if (d->HdrCount == 3)
+    {
+      d->Writing = (d->Hdr[0] & 0xC0) == 0x80;
+      d->Addr = ((uint32_t)(d->Hdr[0] & 0x3F) << 16) | ((uint32_t)d->Hdr[1] << 8) | d->Hdr[2];
+      d->WroteLo = d->WroteHi = d->Addr;
+      d->CmdB = d->Writing && d->Addr == REG(REG_CMDB_WRITE);
+      d->CmdBPending = 0;
+      d->DummyDone = false;
+      d->Ready = SimReady(d);
+      if (!d->Writing && d->Ready)
+        SimPrepareRead(d, d->Addr);
+    }
+    return 0;
+  }
+
+  d->DataCount++;
+  if (d->Writing)
+  {
+    if (!d->Ready)
+      return 0;
+    if (d->CmdB)
+    {
+      uint16_t wr = Rd16(d, REG(REG_CMD_WRITE));
+
+      d->Mem[RAM_CMD + ((wr + d->CmdBPending) & (FT_CMD_FIFO_SIZE - 1))] = mosi;
+      if (++d->CmdBPending == 4)
+      {
+        Wr16(d, REG(REG_CMD_WRITE), (wr + 4) & (FT_CMD_FIFO_SIZE - 1));
+        d->CmdBPending = 0;
+      }
+      return 0;
+    }
+    d->Mem[d->Addr & SIM_MEM_MASK] = mosi;
+    d->Addr++;
+    d->WroteHi = d->Addr;
+    return 0;
+  }
+
+  if (!d->DummyDone)
+  {
+    d->DummyDone = true;
+    return 0;
+  }
+  if (d->Ready)
+    miso = d->Mem[d->Addr & SIM_MEM_MASK];
+  d->Addr++;
+  return miso;
+}
+
+static void SimInit(SimDevice *d)
+{
+  const char *s;
+
+  if (d->Mem)
+    return;
+
+  d->Mem = (uint8_t*)calloc(1, SIM_MEM_SIZE);
+  if (!d->Mem)
+  {
+    fprintf(stderr, "eve-sim: out of memory\n");
+    exit(1);
+  }
+  d->SpiHz = EnvU32("EVE_SIM_SPI_HZ", 10000000);
+  d->CsNs = EnvU32("EVE_SIM_CS_NS", 1000);
+  d->CallNs = EnvU32("EVE_SIM_CALL_NS", 250);
+  d->ChipId = EnvU32("EVE_SIM_CHIP", 0x815);
+  d->MaxPolls = EnvU32("EVE_SIM_MAX_POLLS", 0);
+  d->Report = getenv("EVE_SIM_REPORT") != NULL;
+  if (!d->SpiHz)
+    d->SpiHz = 1;
+  if (d->ChipId >= 0x815)
+    d->FlashSize = EnvU32("EVE_SIM_FLASH_MB", 8) << 20;
+  if (d->FlashSize)
+  {
+    d->Flash = (uint8_t*)malloc(d->FlashSize);
+    if (!d->Flash)
+    {
+      fprintf(stderr, "eve-sim: out of memory\n");
+      exit(1);
+    }
+    memset(d->Flash, 0xFF, d->FlashSize);          // Erased
+  }
+
+  // Touch scripts from the environment are for the device behind hw_api.h
+  if (d == &DefaultDevice && (s = getenv("EVE_SIM_TOUCHES")) != NULL)
+  {
+    unsigned x, y;
+    while (sscanf(s, "%u,%u", &x, &y) == 2)
+    {
+      SimDev_ScriptTouch(d, (uint16_t)x, (uint16_t)y);
+      if ((s = strchr(s, ';')) == NULL)
+        break;
+      s++;
+    }
+  }
+  if (d == &DefaultDevice && (s = getenv("EVE_SIM_TAGS")) != NULL)
+  {
+    unsigned tag, polls;
+    while (sscanf(s, "%u:%u", &tag, &polls) == 2)
+    {
+      SimDev_ScriptTag(d, (uint8_t)tag, polls);
+      if ((s = strchr(s, ',')) == NULL)
+        break;
+      s++;
+    }
+  }
+  if (d == &DefaultDevice && (s = getenv("EVE_SIM_PRESSES")) != NULL)
+  {
+    unsigned tag, x, y, after, hold;
+    while (sscanf(s, "%u,%u,%u,%u,%u", &tag, &x, &y, &after, &hold) == 5)
+    {
+      SimDev_ScriptPress(d, (uint8_t)tag, (uint16_t)x, (uint16_t)y, after, hold);
+      if ((s = strchr(s, ';')) == NULL)
+        break;
+      s++;
+    }
+  }
+  SimPowerOn(d);
+}
+
+// ***************************************************************************************************************
+// *** Bus *******************************************************************************************************
+// ***************************************************************************************************************
+
+// One device's side of the SPI bus.  User is the SimDevice, so these can go straight into an EveHal.
+static void DevSpiEnable(void *User)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  d->Selected = true;
+  d->HdrCount = 0;
+  d->DataCount = 0;
+  d->Writing = false;
+  d->CmdB = false;
+  d->Stats.Transactions++;
+  d->TimePs += (uint64_t)d->CsNs * 1000;
+}
+
+static void DevSpiDisable(void *User)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  if (d->Selected)
+    SimEndTransaction(d);
+  d->Selected = false;
+}
+
+static uint8_t DevSpiWrite(void *User, uint8_t data)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  d->Stats.HalCalls++;
+  d->Stats.BytesWritten++;
+  d->TimePs += (uint64_t)d->CallNs * 1000;
+  return SimClock(d, data);
+}
+
+static void DevSpiWriteBuffer(void *User, uint8_t *Buffer, uint32_t Length)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  d->Stats.HalCalls++;
+  d->Stats.BytesWritten += Length;
+  d->TimePs += (uint64_t)d->CallNs * 1000;
+  while (Length--)
+    SimClock(d, *Buffer++);
+}
+
+static void DevSpiReadBuffer(void *User, uint8_t *Buffer, uint32_t Length)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  d->Stats.HalCalls++;
+  d->Stats.BytesRead += Length + 1;
+  d->TimePs += (uint64_t)d->CallNs * 1000;
+  SimClock(d, 0);                                // The dummy byte
+  while (Length--)
+    *Buffer++ = SimClock(d, 0);
+}
+
+static void DevDelay(void *User, uint32_t milliSeconds)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  d->TimePs += (uint64_t)milliSeconds * 1000000000ULL;
+}
+
+static void DevResetHW(void *User)
+{
+  SimDevice *d = (SimDevice*)User;
+
+  SimInit(d);
+  SimPowerOn(d);
+  d->TimePs += 20000000000ULL;                   // PD held low for 20ms
+}
+
+static uint32_t DevMicros(void *User)
+{
+  return (uint32_t)(((SimDevice*)User)->TimePs / 1000000);
+}
+
+// Sleep until INT goes active or TimeoutMs is up - the clock jumps to whichever comes first
+static bool DevWaitIRQ(void *User, uint32_t TimeoutMs)
+{
+  SimDevice *d = (SimDevice*)User;
+  uint64_t Until, Start, End, Next;
+
+  SimInit(d);
+  d->TimePs += (uint64_t)d->CallNs * 1000;       // Looking at the pin
+  SimTouchPolled(d);
+  Until = d->TimePs + (uint64_t)TimeoutMs * 1000000000ULL;
+  SimTouchUpdate(d);
+  while (!SimIrq(d) && SimPressTimes(d, &Start, &End))
+  {
+    Next = d->Pressing ? End : Start;
+    if (Next > Until)
+      break;
+    if (Next > d->TimePs)
+      d->TimePs = Next;
+    SimTouchUpdate(d);
+  }
+  if (SimIrq(d))
+    return true;
+  d->TimePs = Until;
+  return false;
+}
+
+// ***************************************************************************************************************
+// *** hw_api.h **************************************************************************************************
+// ***************************************************************************************************************
+
+void HAL_SPI_Enable(void)                                  { DevSpiEnable(&DefaultDevice); }
+void HAL_SPI_Disable(void)                                 { DevSpiDisable(&DefaultDevice); }
+uint8_t HAL_SPI_Write(uint8_t data)                        { return DevSpiWrite(&DefaultDevice, data); }
+void HAL_SPI_WriteBuffer(uint8_t *Buffer, uint32_t Length) { DevSpiWriteBuffer(&DefaultDevice, Buffer, Length); }
+void HAL_SPI_ReadBuffer(uint8_t *Buffer, uint32_t Length)  { DevSpiReadBuffer(&DefaultDevice, Buffer, Length); }
+void HAL_Delay(uint32_t milliSeconds)                      { DevDelay(&DefaultDevice, milliSeconds); }
+void HAL_Eve_Reset_HW(void)                                { DevResetHW(&DefaultDevice); }
+uint32_t HAL_Micros(void)                                  { return DevMicros(&DefaultDevice); }
+bool HAL_Wait_IRQ(uint32_t TimeoutMs)                      { return DevWaitIRQ(&DefaultDevice, TimeoutMs); }
+
+void HAL_Close(void)
+{
+  if (DefaultDevice.Report)
+    SimDev_PrintStats(&DefaultDevice, "eve-sim");
+  free(DefaultDevice.Mem);
+  DefaultDevice.Mem = NULL;
+  free(DefaultDevice.Inflate.In);
+  memset(&DefaultDevice.Inflate, 0, sizeof(DefaultDevice.Inflate));
+}
+
+// ***************************************************************************************************************
+// *** Devices ***************************************************************************************************
+// ***************************************************************************************************************
+
+SimDevice *Sim_Default(void)
+{
+  return &DefaultDevice;
+}
+
+SimDevice *Sim_Create(void)
+{
+  SimDevice *d = (SimDevice*)calloc(1, sizeof(SimDevice));
+
+  if (!d)
+  {
+    fprintf(stderr, "eve-sim: out of memory\n");
+    exit(1);
+  }
+  SimInit(d);
+  return d;
+}
+
+void Sim_Destroy(SimDevice *Dev)
+{
+  if (!Dev || Dev == &DefaultDevice)
+    return;
+  free(Dev->Mem);
+  free(Dev->Flash);
+  free(Dev->Inflate.In);
+  free(Dev);
+}
+
+void Sim_Hal(SimDevice *Dev, EveHal *Hal)
+{
+  Hal->User = Dev;
+  Hal->SPI_Enable = DevSpiEnable;
+  Hal->SPI_Disable = DevSpiDisable;
+  Hal->SPI_Write = DevSpiWrite;
+  Hal->SPI_WriteBuffer = DevSpiWriteBuffer;
+  Hal->SPI_ReadBuffer = DevSpiReadBuffer;
+  Hal->Delay = DevDelay;
+  Hal->Eve_Reset_HW = DevResetHW;
+  Hal->Micros = DevMicros;
+  Hal->Wait_IRQ = DevWaitIRQ;
+}
+
+// ***************************************************************************************************************
+// *** Simulator controls ****************************************************************************************
+// ***************************************************************************************************************
+
+void SimDev_Configure(SimDevice *d, uint32_t SpiHz, uint32_t CsNs, uint32_t CallNs)
+{
+  SimInit(d);
+  d->SpiHz = SpiHz ? SpiHz : 1;
+  d->CsNs = CsNs;
+  d->CallNs = CallNs;
+}
+
+void SimDev_GetStats(SimDevice *d, SimStats *Stats)
+{
+  SimInit(d);
+  d->Stats.TimeNs = (d->TimePs - d->StatsPs) / 1000;
+  *Stats = d->Stats;
+}
+
+void SimDev_ResetStats(SimDevice *d)
+{
+  SimInit(d);
+  memset(&d->Stats, 0, sizeof(d->Stats));
+  d->StatsPs = d->TimePs;                        // The clock itself keeps running - REG_FRAMES depends on it
+}
+
+void SimDev_PrintStats(SimDevice *d, const char *Label)
+{
+  SimStats s;
+
+  SimDev_GetStats(d, &s);
+  printf("%s: transactions=%llu hal_calls=%llu bytes_written=%llu bytes_read=%llu time_us=%llu "
+         "host_commands=%u copro_commands=%u swaps=%u dlswaps=%u faults=%u flash_sectors=%u\n",
+         Label, (unsigned long long)s.Transactions, (unsigned long long)s.HalCalls,
+         (unsigned long long)s.BytesWritten, (unsigned long long)s.BytesRead,
+         (unsigned long long)(s.TimeNs / 1000), s.HostCommands, s.CoProCommands, s.Swaps, s.DLSwaps, s.Faults, s.FlashSectors);
+}
+
+void SimDev_ScriptTouch(SimDevice *d, uint16_t x, uint16_t y)
+{
+  uint32_t next = (d->TouchTail + 1) % SIM_SCRIPT_MAX;
+
+  if (next == d->TouchHead)
+    return;
+  d->TouchX[d->TouchTail] = x;
+  d->TouchY[d->TouchTail] = y;
+  d->TouchTail = next;
+}
+
+void SimDev_ScriptTag(SimDevice *d, uint8_t tag, uint32_t polls)
+{
+  uint32_t next = (d->TagTail + 1) % SIM_SCRIPT_MAX;
+
+  if (next == d->TagHead || !polls)
+    return;
+  d->Tag[d->TagTail] = tag;
+  d->TagPolls[d->TagTail] = polls;
+  d->TagTail = next;
+}
+
+void SimDev_ScriptPress(SimDevice *d, uint8_t tag, uint16_t x, uint16_t y, uint32_t AfterMs, uint32_t HoldMs)
+{
+  uint32_t next = (d->PressTail + 1) % SIM_SCRIPT_MAX;
+
+  if (next == d->PressHead || !HoldMs)
+    return;
+  if (d->PressHead == d->PressTail)
+    d->PressAnchored = false;                    // Counts from the next look, not a press long gone
+  d->PressTag[d->PressTail] = tag;
+  d->PressX[d->PressTail] = x;
+  d->PressY[d->PressTail] = y;
+  d->PressAfter[d->PressTail] = AfterMs;
+  d->PressHold[d->PressTail] = HoldMs;
+  d->PressTail = next;
+}
+
+uint8_t *SimDev_Memory(SimDevice *d)
+{
+  SimInit(d);
+  return d->Mem;
+}
+
+// The attached flash, NULL for an FT81x.  Writes here cost nothing - handy for setting up a test.
+uint8_t *SimDev_Flash(SimDevice *d, uint32_t *Size)
+{
+  SimInit(d);
+  *Size = d->FlashSize;
+  return d->Flash;
+}
+
+uint64_t SimDev_TimeNs(SimDevice *d)
+{
+  return d->TimePs / 1000;
+}
+
+// The same, for the device behind hw_api.h
+void Sim_Configure(uint32_t SpiHz, uint32_t CsNs, uint32_t CallNs) { SimDev_Configure(&DefaultDevice, SpiHz, CsNs, CallNs); }
+void Sim_GetStats(SimStats *Stats)                                  { SimDev_GetStats(&DefaultDevice, Stats); }
+void Sim_ResetStats(void)                                           { SimDev_ResetStats(&DefaultDevice); }
+void Sim_PrintStats(const char *Label)                              { SimDev_PrintStats(&DefaultDevice, Label); }
+void Sim_ScriptTouch(uint16_t x, uint16_t y)                        { SimDev_ScriptTouch(&DefaultDevice, x, y); }
+void Sim_ScriptTag(uint8_t tag, uint32_t polls)                     { SimDev_ScriptTag(&DefaultDevice, tag, polls); }
+void Sim_ScriptPress(uint8_t tag, uint16_t x, uint16_t y, uint32_t AfterMs, uint32_t HoldMs) { SimDev_ScriptPress(&DefaultDevice, tag, x, y, AfterMs, HoldMs); }
+uint8_t *Sim_Memory(void)                                           { return SimDev_Memory(&DefaultDevice); }
+uint64_t Sim_TimeNs(void)                                           { return SimDev_TimeNs(&DefaultDevice); }
+uint8_t *Sim_Flash(uint32_t *Size)                                  { return SimDev_Flash(&DefaultDevice, Size); }
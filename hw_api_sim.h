@@ -0,0 +1,89 @@
+#pragma once
+
+// Simulated Eve device - an implementation of hw_api.h that needs no hardware.
+//
+// Build the library and your application with hw_api_sim.c in place of your real HAL and every SPI
+// transaction is decoded the way Eve would: 3 address bytes with the write bit, a dummy byte ahead of
+// read data, and host commands.  RAM_G, RAM_DL, RAM_CMD and the register file are modeled, along with a
+// CoProcessor that consumes the FIFO, advances REG_CMD_READ and counts CMD_SWAPs.
+//
+// Time is simulated, not measured.  Every transaction is charged a chip select latency, every call into
+// the HAL a call overhead and every byte its bit time at the configured SPI clock.  HAL_Delay() just
+// moves the clock forward, so a simulated run is fast and the numbers are reproducible.
+//
+// The defaults can be changed from the environment (handy in CI) or with Sim_Configure():
+//   EVE_SIM_SPI_HZ       SPI clock in Hz                                      (default 10000000)
+//   EVE_SIM_CS_NS        cost of each chip select cycle in nanoseconds        (default 1000)
+//   EVE_SIM_CALL_NS      cost of each HAL_SPI_* call in nanoseconds           (default 250)
+//   EVE_SIM_CHIP         chip to pretend to be, 0x813 / 0x815 / 0x817        (default 0x815)
+//   EVE_SIM_FLASH_MB     size of the flash attached to a BT81x, 0 for none    (default 8)
+//   EVE_SIM_TOUCHES      raw touch points "x,y;x,y;..." - e.g. for Calibrate_Manual()
+//   EVE_SIM_TAGS         touch tags as "tag:polls,tag:polls,..." - what REG_TOUCH_TAG reads return
+//   EVE_SIM_PRESSES      presses in simulated time as "tag,x,y,after_ms,hold_ms;..." - see Sim_ScriptPress()
+//   EVE_SIM_MAX_POLLS    print the statistics and exit after the host has looked at the touch screen this many
+//                        times - reads of REG_INT_FLAGS or the touch registers, and HAL_Wait_IRQ() calls
+//   EVE_SIM_REPORT       print the statistics from HAL_Close() when set
+//
+// Any number of further devices can be made with Sim_Create().  Each has its own memory, clock and
+// statistics, and Sim_Hal() fills in an EveHal for it, so one program can run several EveContexts side by
+// side.  The SimDev_ functions work on a given device, the Sim_ ones on the device behind hw_api.h.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Eve2_81x.h"
+
+typedef struct
+{
+  uint64_t Transactions;          // Chip select cycles
+  uint64_t HalCalls;              // Calls into HAL_SPI_Write / WriteBuffer / ReadBuffer
+  uint64_t BytesWritten;          // Bytes clocked out, address and dummy bytes included
+  uint64_t BytesRead;             // Bytes clocked in
+  uint64_t TimeNs;                // Simulated time
+  uint32_t HostCommands;          // HCMD_* transactions
+  uint32_t CoProCommands;         // Commands executed by the CoProcessor
+  uint32_t Swaps;                 // CMD_SWAP executed
+  uint32_t DLSwaps;               // Writes to REG_DLSWAP
+  uint32_t Faults;                // CoProcessor faults (REG_CMD_READ = 0xFFF)
+  uint32_t FlashSectors;          // 4K flash sectors erased and programmed
+} SimStats;
+
+typedef struct SimDevice SimDevice;
+
+SimDevice *Sim_Default(void);                     // The device behind the HAL_ functions
+SimDevice *Sim_Create(void);
+void Sim_Destroy(SimDevice *Dev);
+void Sim_Hal(SimDevice *Dev, EveHal *Hal);        // For Eve_InitContext()
+
+void SimDev_Configure(SimDevice *Dev, uint32_t SpiHz, uint32_t CsNs, uint32_t CallNs);
+void SimDev_GetStats(SimDevice *Dev, SimStats *Stats);
+void SimDev_ResetStats(SimDevice *Dev);
+void SimDev_PrintStats(SimDevice *Dev, const char *Label);
+void SimDev_ScriptTouch(SimDevice *Dev, uint16_t x, uint16_t y);
+void SimDev_ScriptTag(SimDevice *Dev, uint8_t tag, uint32_t polls);
+void SimDev_ScriptPress(SimDevice *Dev, uint8_t tag, uint16_t x, uint16_t y, uint32_t AfterMs, uint32_t HoldMs);
+uint8_t *SimDev_Memory(SimDevice *Dev);
+uint8_t *SimDev_Flash(SimDevice *Dev, uint32_t *Size);
+uint64_t SimDev_TimeNs(SimDevice *Dev);
+
+void Sim_Configure(uint32_t SpiHz, uint32_t CsNs, uint32_t CallNs);
+void Sim_GetStats(SimStats *Stats);
+void Sim_ResetStats(void);
+void Sim_PrintStats(const char *Label);
+
+void Sim_ScriptTouch(uint16_t x, uint16_t y);     // Queue one raw touch, returned by the next REG_TOUCH_DIRECT_XY read
+void Sim_ScriptTag(uint8_t tag, uint32_t polls);  // Report tag on the next polls reads of REG_TOUCH_TAG
+// Touch x,y over tag for HoldMs, AfterMs after the last scripted press ends - or, with none left, after the host
+// next looks at the touch screen
+void Sim_ScriptPress(uint8_t tag, uint16_t x, uint16_t y, uint32_t AfterMs, uint32_t HoldMs);
+
+uint8_t *Sim_Memory(void);                        // The whole 4M Eve address space, for inspection
+uint64_t Sim_TimeNs(void);
+uint8_t *Sim_Flash(uint32_t *Size);               // The attached flash, NULL when there is none
+
+#ifdef __cplusplus
+}
+#endif